@@ -5,13 +5,18 @@
  *  \brief Public AutoCOM header.
  */
 
+#include "autocom/bound.hpp"
 #include "autocom/bstr.hpp"
+#include "autocom/columns.hpp"
 #include "autocom/com.hpp"
 #include "autocom/dispatch.hpp"
+#include "autocom/dispid.hpp"
 #include "autocom/dispparams.hpp"
 #include "autocom/encoding.hpp"
 #include "autocom/enum.hpp"
 #include "autocom/guid.hpp"
+#include "autocom/intern.hpp"
+#include "autocom/pool.hpp"
 #include "autocom/safearray.hpp"
 #include "autocom/typeinfo.hpp"
 #include "autocom/util.hpp"
@@ -0,0 +1,198 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoCOM
+ *  \brief Dispatch members bound to a DISPID.
+ *
+ *  Calling a member by name resolves the DISPID, derives the named
+ *  arguments from the dispatch flags and packs new DISPPARAMS on each
+ *  call. Bound members do this once, so repeated calls in tight loops
+ *  only fill the arguments and call IDispatch::Invoke.
+ */
+
+#pragma once
+
+#include "dispparams.hpp"
+#include "util/exception.hpp"
+#include "util/com_ptr.hpp"
+
+
+namespace autocom
+{
+// OBJECTS
+// -------
+
+
+/** \brief Shared state for bound members.
+ *
+ *  The argument buffer is reused between calls, so a bound member
+ *  must not be called from multiple threads at once. Copies do not
+ *  share the buffer.
+ */
+class BoundMember
+{
+protected:
+    ComPtr<IDispatch> ppv;
+    DISPID id = DISPID_UNKNOWN;
+    VariantList vargs;
+    DISPID named = DISPID_PROPERTYPUT;
+
+    template <typename... Ts>
+    bool invoke(const WORD flags,
+        const bool useNamed,
+        VARIANT *result,
+        Ts&&... ts);
+
+public:
+    BoundMember() = default;
+    BoundMember(const ComPtr<IDispatch> &ppv,
+        const DISPID id);
+
+    DISPID function() const;
+    explicit operator bool() const;
+};
+
+
+/** \brief Method, or parameterized property, bound to a DISPID.
+ */
+class BoundMethod: public BoundMember
+{
+protected:
+    WORD flags = DISPATCH_METHOD;
+    bool useNamed = false;
+
+public:
+    BoundMethod() = default;
+    BoundMethod(const ComPtr<IDispatch> &ppv,
+        const DISPID id,
+        const DispatchFlags flags);
+
+    template <typename... Ts>
+    bool call(Variant &result,
+        Ts&&... ts);
+
+    template <typename... Ts>
+    Variant operator()(Ts&&... ts);
+};
+
+
+/** \brief Property bound to a DISPID.
+ */
+class BoundProperty: public BoundMember
+{
+protected:
+    WORD putFlags = DISPATCH_PROPERTYPUT;
+
+public:
+    BoundProperty() = default;
+    BoundProperty(const ComPtr<IDispatch> &ppv,
+        const DISPID id,
+        const DispatchFlags put);
+
+    template <typename T>
+    bool get(T &value);
+
+    template <typename... Ts>
+    Variant getV(Ts&&... ts);
+
+    template <typename... Ts>
+    bool put(Ts&&... ts);
+};
+
+
+// IMPLEMENTATION
+// --------------
+
+
+/** \brief Fill the argument buffer and invoke the member.
+ */
+template <typename... Ts>
+bool BoundMember::invoke(const WORD flags,
+    const bool useNamed,
+    VARIANT *result,
+    Ts&&... ts)
+{
+    constexpr size_t size = sizeof...(Ts);
+    if (vargs.size() != size) {
+        vargs.resize(size);
+    }
+    for (Variant &variant: vargs) {
+        variant.clear();
+    }
+    setArg(vargs.data(), size-1, AUTOCOM_FWD(ts)...);
+
+    DISPPARAMS dp = {size ? vargs.data() : nullptr, nullptr, static_cast<UINT>(size), 0};
+    if (useNamed) {
+        dp.rgdispidNamedArgs = &named;
+        dp.cNamedArgs = 1;
+    }
+
+    return SUCCEEDED(ppv->Invoke(id, IID_NULL, LOCALE_USER_DEFAULT, flags, &dp, result, nullptr, nullptr));
+}
+
+
+/** \brief Call method, storing the return value in `result`.
+ */
+template <typename... Ts>
+bool BoundMethod::call(Variant &result,
+    Ts&&... ts)
+{
+    result.clear();
+    return invoke(flags, useNamed, &result, AUTOCOM_FWD(ts)...);
+}
+
+
+/** \brief Call method with return variant.
+ */
+template <typename... Ts>
+Variant BoundMethod::operator()(Ts&&... ts)
+{
+    Variant result;
+    if (!call(result, AUTOCOM_FWD(ts)...)) {
+        throw ComMethodError("IDispatch", "Invoke(...)");
+    }
+
+    return result;
+}
+
+
+/** \brief Get property value, with return status.
+ */
+template <typename T>
+bool BoundProperty::get(T &value)
+{
+    Variant result;
+    if (invoke(FROM_ENUM(GET), false, &result)) {
+        autocom::get(result, value);
+        return true;
+    }
+
+    return false;
+}
+
+
+/** \brief Get property value, with optional indexes.
+ */
+template <typename... Ts>
+Variant BoundProperty::getV(Ts&&... ts)
+{
+    Variant result;
+    if (!invoke(FROM_ENUM(GET), false, &result, AUTOCOM_FWD(ts)...)) {
+        throw ComMethodError("IDispatch", "Invoke(DISPATCH_PROPERTYGET, ...)");
+    }
+
+    return result;
+}
+
+
+/** \brief Put property value, with optional leading indexes.
+ */
+template <typename... Ts>
+bool BoundProperty::put(Ts&&... ts)
+{
+    static_assert(sizeof...(Ts) >= 1, "Must provide property value");
+
+    return invoke(putFlags, true, nullptr, AUTOCOM_FWD(ts)...);
+}
+
+}   /* autocom */
@@ -7,14 +7,24 @@
 
 #pragma once
 
+#include "autocom/encoding/literal.hpp"
+#include "autocom/pool.hpp"
+#include "autocom/util/define.hpp"
+
 #include <wtypes.h>
 
+#include <functional>
 #include <iterator>
 #include <string>
 
 
 namespace autocom
 {
+// FORWARD
+// -------
+
+class BstrView;
+
 // OBJECTS
 // -------
 
@@ -23,7 +33,7 @@ namespace autocom
  *
  *  \warning This class does not efficiently allocate memory for
  *  dynamically-sized objects. Every single operation that changes size
- *  causes a reallocation. Consider yourself warned.
+ *  causes a reallocation. Use BstrBuilder to build strings piecewise.
  */
 class Bstr
 {
@@ -68,6 +78,9 @@ public:
     Bstr(const wchar_t *array,
         const size_t length);
 
+    template <size_t N>
+    Bstr(const utf::WideLiteral<N> &literal);
+
     // ITERATORS
     iterator begin() noexcept;
     iterator end() noexcept;
@@ -104,6 +117,10 @@ public:
     void reset();
     void reset(BSTR bstr);
     void reset(VARIANT &variant);
+    BSTR release();
+    Bstr & fromUtf8Into(const char *narrow,
+        const size_t length);
+    Bstr & fromUtf8Into(const std::string &narrow);
 
     template <typename... Ts>
     Bstr & operator +=(Ts&&... ts);
@@ -114,6 +131,10 @@ public:
     template <typename... Ts>
     Bstr & assign(Ts&&... ts);
 
+    // OPERATIONS
+    int compare(const BstrView &other) const;
+    int compareNoCase(const BstrView &other) const;
+
     // OPERATORS
     BSTR & data();
     const BSTR & data() const;
@@ -136,10 +157,309 @@ public:
 };
 
 
+/** \brief Builder for BSTRs with amortized growth.
+ *
+ *  Over-allocates the underlying BSTR geometrically, so appending
+ *  characters one at a time is amortized O(1), and finalizes into a
+ *  BSTR without copying the contents.
+ *
+ *  \code
+ *      BstrBuilder builder;
+ *      builder.reserve(64);
+ *      builder.append(L"SELECT * FROM ");
+ *      builder.append(table);
+ *      Bstr statement = builder.str();
+ *  \endcode
+ */
+class BstrBuilder
+{
+protected:
+    BSTR string = nullptr;
+    size_t count = 0;
+    size_t reserved = 0;
+
+    void grow(const size_t minimum);
+
+public:
+    BstrBuilder() = default;
+    BstrBuilder(const BstrBuilder &other) = delete;
+    BstrBuilder & operator=(const BstrBuilder &other) = delete;
+    BstrBuilder(BstrBuilder &&other);
+    BstrBuilder & operator=(BstrBuilder &&other);
+    ~BstrBuilder();
+
+    explicit BstrBuilder(const size_t capacity);
+
+    // CAPACITY
+    size_t size() const;
+    size_t capacity() const;
+    bool empty() const;
+    void reserve(const size_t capacity);
+    void clear();
+
+    // ELEMENT ACCESS
+    const wchar_t * data() const;
+
+    // MODIFIERS
+    BstrBuilder & push_back(const wchar_t c);
+    BstrBuilder & append(const wchar_t c);
+    BstrBuilder & append(const wchar_t *array,
+        const size_t length);
+    BstrBuilder & append(const wchar_t *cstring);
+    BstrBuilder & append(const std::wstring &wide);
+    BstrBuilder & append(const Bstr &bstr);
+    BstrBuilder & append(const char *array,
+        const size_t length);
+    BstrBuilder & append(const char *cstring);
+    BstrBuilder & append(const std::string &narrow);
+
+    template <typename... Ts>
+    BstrBuilder & operator+=(Ts&&... ts);
+
+    // CONVERSION
+    BSTR release();
+    Bstr str();
+};
+
+
+/** \brief Non-owning, read-only view of a BSTR or wide character range.
+ *
+ *  Trivially copyable, so BSTRs received from COM can be inspected and
+ *  passed as in-parameters without a SysAllocStringLen copy.
+ *
+ *  \warning The viewed string must outlive the view.
+ */
+class BstrView
+{
+protected:
+    const wchar_t *string = L"";
+    size_t count = 0;
+    bool terminator = true;
+
+public:
+    // MEMBER TYPES
+    // ------------
+    typedef wchar_t value_type;
+    typedef const wchar_t& reference;
+    typedef const wchar_t& const_reference;
+    typedef const wchar_t* pointer;
+    typedef const wchar_t* const_pointer;
+    typedef const_pointer iterator;
+    typedef const_pointer const_iterator;
+    typedef std::reverse_iterator<const_iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // MEMBER FUNCTIONS
+    BstrView() = default;
+    BstrView(const Bstr &bstr);
+    BstrView(const BSTR &bstr);
+    BstrView(const std::wstring &wide);
+    BstrView(const wchar_t *cstring);
+    BstrView(const wchar_t *array,
+        const size_t length);
+    explicit BstrView(const VARIANT &variant);
+
+    // ITERATORS
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+    const_reverse_iterator rbegin() const noexcept;
+    const_reverse_iterator rend() const noexcept;
+    const_reverse_iterator crbegin() const noexcept;
+    const_reverse_iterator crend() const noexcept;
+
+    // CAPACITY
+    size_t size() const;
+    size_t length() const;
+    bool empty() const;
+
+    // ELEMENT ACCESS
+    const_reference operator[](size_t position) const;
+    const_reference at(size_t position) const;
+    const_reference front() const;
+    const_reference back() const;
+    const wchar_t * data() const;
+    bool terminated() const;
+
+    // OPERATIONS
+    BstrView substr(size_t position = 0,
+        size_t length = npos) const;
+    int compare(const BstrView &other) const;
+    int compareNoCase(const BstrView &other) const;
+    size_t find(const wchar_t c,
+        size_t position = 0) const;
+    size_t find(const BstrView &other,
+        size_t position = 0) const;
+
+    // CONVERSION
+    std::wstring wstr() const;
+    explicit operator std::string() const;
+};
+
+
+/** \brief Bstr with a cached UTF-8 shadow, for repeated narrow access.
+ *
+ *  The string is only exposed read-only, so the shadow cannot go
+ *  stale: the UTF-8 copy is transcoded at most once, or adopted from
+ *  the caller's std::string without any transcoding.
+ *
+ *  \code
+ *      ShadowBstr name(std::move(bstr));
+ *      log(name.str());        // transcodes
+ *      lookup(name.str());     // cached
+ *  \endcode
+ */
+class ShadowBstr
+{
+protected:
+    Bstr wide;
+    mutable std::string narrow;
+    mutable bool cached = false;
+
+public:
+    ShadowBstr() = default;
+    ShadowBstr(const ShadowBstr &other) = default;
+    ShadowBstr & operator=(const ShadowBstr &other) = default;
+    ShadowBstr(ShadowBstr &&other) = default;
+    ShadowBstr & operator=(ShadowBstr &&other) = default;
+
+    ShadowBstr(const Bstr &bstr);
+    ShadowBstr(Bstr &&bstr);
+    ShadowBstr(const std::string &string);
+    ShadowBstr(std::string &&string);
+
+    // CAPACITY
+    size_t size() const;
+    bool empty() const;
+    bool shadowed() const;
+
+    // ELEMENT ACCESS
+    const Bstr & bstr() const;
+    const BSTR & data() const;
+    const std::string & str() const;
+
+    // MODIFIERS
+    void reset();
+    void reset(Bstr &&bstr);
+    void reset(std::string &&string);
+    BSTR release();
+
+    // CONVERSION
+    operator BstrView() const;
+};
+
+
+/** \brief Case-insensitive hash for BSTR keys, matching BstrEqualNoCase.
+ *
+ *  COM names are case-insensitive, so caches keyed by name use it with
+ *  BstrEqualNoCase as the map's hash and key-equal types.
+ *
+ *  \code
+ *      std::unordered_map<Bstr, Function, BstrHashNoCase, BstrEqualNoCase> ids;
+ *  \endcode
+ */
+struct BstrHashNoCase
+{
+    size_t operator()(const BstrView &view) const;
+};
+
+
+/** \brief Case-insensitive equality for BSTR keys.
+ */
+struct BstrEqualNoCase
+{
+    bool operator()(const BstrView &left,
+        const BstrView &right) const;
+};
+
+
+/** \brief Case-insensitive ordering for BSTR keys.
+ */
+struct BstrLessNoCase
+{
+    bool operator()(const BstrView &left,
+        const BstrView &right) const;
+};
+
+// FUNCTIONS
+// ---------
+
+/** \brief Convert UTF-8 character array directly to a new BSTR.
+ *
+ *  The caller owns the result, and must free it with FREE_BSTR or SysFreeString.
+ */
+BSTR WIDE_BSTR(const char *narrow,
+    const size_t length);
+
+/** \brief Convert UTF-8 directly to a new BSTR.
+ */
+BSTR WIDE_BSTR(const std::string &narrow);
+
+/** \brief Less than operator, comparing code units.
+ */
+bool operator<(const Bstr &left,
+    const Bstr &right);
+
+/** \brief Less than or equal to operator, comparing code units.
+ */
+bool operator<=(const Bstr &left,
+    const Bstr &right);
+
+/** \brief Greater than operator, comparing code units.
+ */
+bool operator>(const Bstr &left,
+    const Bstr &right);
+
+/** \brief Greater than or equal to operator, comparing code units.
+ */
+bool operator>=(const Bstr &left,
+    const Bstr &right);
+
+/** \brief Equality operator.
+ */
+bool operator==(const BstrView &left,
+    const BstrView &right);
+
+/** \brief Inequality operator.
+ */
+bool operator!=(const BstrView &left,
+    const BstrView &right);
+
+/** \brief Less than operator, comparing code units.
+ */
+bool operator<(const BstrView &left,
+    const BstrView &right);
+
+/** \brief Less than or equal to operator, comparing code units.
+ */
+bool operator<=(const BstrView &left,
+    const BstrView &right);
+
+/** \brief Greater than operator, comparing code units.
+ */
+bool operator>(const BstrView &left,
+    const BstrView &right);
+
+/** \brief Greater than or equal to operator, comparing code units.
+ */
+bool operator>=(const BstrView &left,
+    const BstrView &right);
+
 // OPERATOR
 // --------
 
 
+/** \brief Initialize from compile-time wide literal, without transcoding.
+ */
+template <size_t N>
+Bstr::Bstr(const utf::WideLiteral<N> &literal):
+    Bstr(literal.data(), literal.size())
+{}
+
+
 /** \brief Append to string.
  */
 template <typename... Ts>
@@ -148,7 +468,7 @@ Bstr & Bstr::operator+=(Ts&&... ts)
     std::wstring wide(*this);
     wide.append(AUTOCOM_FWD(ts)...);
     clear();
-    string = SysAllocStringLen(wide.data(), wide.size());
+    string = ALLOC_BSTR(wide.data(), wide.size());
 
     return *this;
 }
@@ -172,4 +492,38 @@ Bstr & Bstr::assign(Ts&&... ts)
 }
 
 
+/** \brief Append to builder.
+ */
+template <typename... Ts>
+BstrBuilder & BstrBuilder::operator+=(Ts&&... ts)
+{
+    return append(AUTOCOM_FWD(ts)...);
+}
+
+
 }   /* autocom */
+
+namespace std
+{
+// SPECIALIZATION
+// --------------
+
+
+/** \brief Hash the code units of a Bstr.
+ */
+template <>
+struct hash<autocom::Bstr>
+{
+    size_t operator()(const autocom::Bstr &bstr) const;
+};
+
+
+/** \brief Hash the code units of a BstrView.
+ */
+template <>
+struct hash<autocom::BstrView>
+{
+    size_t operator()(const autocom::BstrView &view) const;
+};
+
+}   /* std */
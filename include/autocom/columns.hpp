@@ -0,0 +1,358 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoCOM
+ *  \brief Bulk conversion of VARIANT SafeArrays into typed columns.
+ *
+ *  Automation servers often return tables as SAFEARRAY(VARIANT), where
+ *  each column holds one type. toColumns converts every column in a
+ *  single pass into a contiguous std::vector.
+ */
+
+#pragma once
+
+#include "safearray.hpp"
+#include "variant.hpp"
+#include "util/parallel.hpp"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace autocom
+{
+// ENUM
+// ----
+
+
+/** \brief Index of a 2-D array which selects the column.
+ */
+enum class ColumnIndex
+{
+    LAST,               // array(row, column), as from Excel ranges
+    FIRST,              // array(column, row), as from MSFileReader
+};
+
+// FUNCTIONS
+// ---------
+
+/** \brief Convert a VARIANT SafeArray into one vector per column.
+ *
+ *  2-D arrays use `index` to pick the column dimension. 1-D arrays
+ *  hold whole records back-to-back, so element `i` belongs to column
+ *  `i % sizeof...(Ts)`. Elements which already hold the column's
+ *  numeric type are copied from the payload. Other elements are
+ *  widened, or coerced with VariantChangeType. Arrays with at
+ *  least `parallel.threshold` elements and only numeric columns are
+ *  split by row across threads. The threads do not touch COM objects:
+ *  elements holding interfaces, records or references are converted
+ *  by the calling thread once they join.
+ *
+ *  \throw std::invalid_argument    Array shape does not match the columns.
+ *  \throw ComFunctionError         An element cannot be coerced.
+ */
+template <typename... Ts>
+std::tuple<std::vector<Ts>...> toColumns(const SafeArray<VARIANT> &array,
+    const ColumnIndex index = ColumnIndex::LAST,
+    const Parallel &parallel = SERIAL);
+
+namespace detail
+{
+// HELPERS
+// -------
+
+
+/** \brief Types copied from the VARIANT payload without conversion.
+ */
+template <typename T>
+using IsColumnNumber = std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>;
+
+
+/** \brief Check if every column is copied from the VARIANT payload.
+ */
+template <typename... Ts>
+constexpr bool allColumnNumbers()
+{
+    const bool flags[] = {true, IsColumnNumber<Ts>::value...};
+    for (const bool flag: flags) {
+        if (!flag) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/** \brief Check if any column would be a std::vector<bool>.
+ */
+template <typename... Ts>
+constexpr bool hasBoolColumn()
+{
+    const bool flags[] = {false, std::is_same<Ts, bool>::value...};
+    for (const bool flag: flags) {
+        if (flag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/** \brief Rows per column left for the calling thread.
+ */
+template <size_t N>
+using DeferredRows = std::array<std::vector<size_t>, N>;
+
+
+/** \brief Position of a column within the array data.
+ */
+struct ColumnShape
+{
+    size_t rows;
+    size_t columns;
+    size_t columnStride;
+    size_t rowStride;
+};
+
+
+/** \brief Check if converting the element may call into a COM object.
+ *
+ *  Such elements must stay on the thread which owns the array, since
+ *  worker threads are not in the objects' apartment.
+ */
+inline bool holdsObject(const VARIANT &variant)
+{
+    const VARTYPE type = variant.vt & VT_TYPEMASK;
+    if (variant.vt & (VT_BYREF | VT_ARRAY)) {
+        return true;
+    }
+    return type == VT_DISPATCH || type == VT_UNKNOWN || type == VT_RECORD;
+}
+
+
+/** \brief Copy or coerce a single element.
+ */
+template <typename T>
+void convertElement(const VARIANT &variant,
+    T &value)
+{
+    if (widenVariant(variant, value)) {
+        return;
+    }
+
+    Variant copy;
+    if (FAILED(VariantCopy(&copy, &variant))) {
+        throw ComFunctionError("VariantCopy");
+    }
+    copy.get(value);
+}
+
+
+/** \brief Copy a BSTR element.
+ */
+inline void convertElement(const VARIANT &variant,
+    Bstr &value)
+{
+    if (variant.vt == VT_BSTR) {
+        value = variant.bstrVal;
+        return;
+    }
+
+    Variant copy;
+    if (FAILED(VariantCopy(&copy, &variant))) {
+        throw ComFunctionError("VariantCopy");
+    }
+    copy.get(value);
+}
+
+
+/** \brief Copy a VARIANT element.
+ */
+inline void convertElement(const VARIANT &variant,
+    Variant &value)
+{
+    value.clear();
+    if (FAILED(VariantCopy(&value, &variant))) {
+        throw ComFunctionError("VariantCopy");
+    }
+}
+
+
+/** \brief Convert `count` elements of a numeric column.
+ *
+ *  Scans and copies in one pass: elements of the exact type are copied
+ *  straight from the payload, and only mismatched elements are
+ *  widened or coerced.
+ */
+template <typename T>
+typename std::enable_if<IsColumnNumber<T>::value>::type
+convertColumn(const VARIANT *first,
+    const size_t stride,
+    const size_t count,
+    T *out,
+    std::vector<size_t> *deferred)
+{
+    constexpr VARTYPE vt = VariantType<T>::vt;
+    for (size_t i = 0; i < count; ++i) {
+        const VARIANT &variant = first[i * stride];
+        if (variant.vt == vt) {
+            std::memcpy(out + i, &variant.llVal, sizeof(T));
+        } else if (deferred && holdsObject(variant)) {
+            deferred->push_back(i);
+        } else {
+            convertElement(variant, out[i]);
+        }
+    }
+}
+
+
+/** \brief Convert `count` elements of a non-numeric column.
+ */
+template <typename T>
+typename std::enable_if<!IsColumnNumber<T>::value>::type
+convertColumn(const VARIANT *first,
+    const size_t stride,
+    const size_t count,
+    T *out,
+    std::vector<size_t> *)
+{
+    for (size_t i = 0; i < count; ++i) {
+        convertElement(first[i * stride], out[i]);
+    }
+}
+
+
+/** \brief Get shape of array for `columns` columns.
+ */
+inline ColumnShape columnShape(const SAFEARRAY *array,
+    const size_t columns,
+    const ColumnIndex index)
+{
+    if (!array) {
+        throw std::invalid_argument("Cannot convert null SafeArray to columns.");
+    }
+
+    ColumnShape shape;
+    if (array->cDims == 1) {
+        const size_t size = array->rgsabound[0].cElements;
+        if (size % columns) {
+            throw std::invalid_argument("SafeArray size is not a multiple of the column count.");
+        }
+        shape = {size / columns, columns, 1, columns};
+    } else if (array->cDims == 2) {
+        // rgsabound is reversed, and the first index varies fastest
+        const size_t first = array->rgsabound[1].cElements;
+        const size_t last = array->rgsabound[0].cElements;
+        if (index == ColumnIndex::LAST) {
+            shape = {first, last, first, 1};
+        } else {
+            shape = {last, first, 1, first};
+        }
+    } else {
+        throw std::invalid_argument("Cannot convert SafeArray with more than 2 dimensions to columns.");
+    }
+
+    if (shape.columns != columns) {
+        throw std::invalid_argument("SafeArray column count does not match requested columns.");
+    }
+
+    return shape;
+}
+
+
+/** \brief Convert rows [begin, end) of every column.
+ *
+ *  If `deferred` is not null, elements which hold COM objects are
+ *  skipped, and their rows, relative to `begin`, are recorded instead.
+ */
+template <typename Tuple, size_t... Is>
+void convertRows(const VARIANT *data,
+    const ColumnShape &shape,
+    const size_t begin,
+    const size_t end,
+    Tuple &columns,
+    DeferredRows<sizeof...(Is)> *deferred,
+    std::index_sequence<Is...>)
+{
+    int expand[] = {0, (
+        convertColumn(data + Is * shape.columnStride + begin * shape.rowStride,
+            shape.rowStride,
+            end - begin,
+            std::get<Is>(columns).data() + begin,
+            deferred ? &std::get<Is>(*deferred) : nullptr),
+        0)...};
+    (void) expand;
+}
+
+
+/** \brief Convert the elements skipped by convertRows.
+ */
+template <typename Tuple, size_t... Is>
+void convertDeferred(const VARIANT *data,
+    const ColumnShape &shape,
+    const size_t begin,
+    const DeferredRows<sizeof...(Is)> &deferred,
+    Tuple &columns,
+    std::index_sequence<Is...>)
+{
+    int expand[] = {0, (
+        [&]() {
+            for (const size_t row: std::get<Is>(deferred)) {
+                const size_t index = begin + row;
+                convertElement(data[Is * shape.columnStride + index * shape.rowStride], std::get<Is>(columns)[index]);
+            }
+        }(),
+        0)...};
+    (void) expand;
+}
+
+}   /* detail */
+
+// IMPLEMENTATION
+// --------------
+
+
+/** \brief Convert a VARIANT SafeArray into one vector per column.
+ */
+template <typename... Ts>
+std::tuple<std::vector<Ts>...> toColumns(const SafeArray<VARIANT> &array,
+    const ColumnIndex index,
+    const Parallel &parallel)
+{
+    static_assert(sizeof...(Ts) > 0, "Must request at least one column.");
+    static_assert(!detail::hasBoolColumn<Ts...>(), "std::vector<bool> is not contiguous, use VARIANT_BOOL.");
+
+    const SAFEARRAY *safearray = array;
+    const detail::ColumnShape shape = detail::columnShape(safearray, sizeof...(Ts), index);
+    std::tuple<std::vector<Ts>...> columns(std::vector<Ts>(shape.rows)...);
+
+    // only numeric columns can be converted off the calling thread
+    const VARIANT *data = array.data();
+    const size_t rows = shape.rows;
+    const auto indexes = std::index_sequence_for<Ts...>();
+    size_t workers = 1;
+    if (detail::allColumnNumbers<Ts...>()) {
+        workers = parallel.workers(shape.rows * shape.columns);
+    }
+    if (workers <= 1) {
+        detail::convertRows(data, shape, 0, rows, columns, nullptr, indexes);
+        return columns;
+    }
+
+    std::vector<detail::DeferredRows<sizeof...(Ts)>> deferred(workers);
+    forEachChunk(workers, [&](size_t i) {
+        detail::convertRows(data, shape, rows * i / workers, rows * (i + 1) / workers, columns, &deferred[i], indexes);
+    });
+    for (size_t i = 0; i < workers; ++i) {
+        detail::convertDeferred(data, shape, rows * i / workers, deferred[i], columns, indexes);
+    }
+
+    return columns;
+}
+
+}   /* autocom */
@@ -7,10 +7,13 @@
 
 #pragma once
 
+#include "bound.hpp"
+#include "dispid.hpp"
 #include "dispparams.hpp"
+#include "intern.hpp"
 #include "util/define.hpp"
 #include "util/exception.hpp"
-#include "util/shared_ptr.hpp"
+#include "util/com_ptr.hpp"
 
 #include <initguid.h>
 #include <dispex.h>
@@ -95,9 +98,14 @@ bool equalObject(ObjectPtr left,
 class DispatchBase
 {
 protected:
-    SharedPointer<IDispatch> ppv;
+    ComPtr<IDispatch> ppv;
+    mutable DispidCachePtr cache;
 
+    DispidCachePtr sharedCache() const;
+    Function lookupFunction(const BstrView &name);
     Function getFunction(const Bstr &name);
+    Function getFunction(const BstrView &name);
+    Function getFunction(const wchar_t *name);
 
     template <typename... Ts>
     bool invoke(DispatchFlags flags,
@@ -112,16 +120,56 @@ protected:
         Ts&&... ts);
 
     template <typename... Ts>
-    MethodResult get_(Ts&&... ts);
+    bool invoke(DispatchFlags flags,
+        VARIANT *result,
+        const BstrView &name,
+        Ts&&... ts);
+
+    template <typename... Ts>
+    bool invoke(DispatchFlags flags,
+        VARIANT *result,
+        const std::wstring &name,
+        Ts&&... ts);
+
+    template <typename... Ts>
+    bool invoke(DispatchFlags flags,
+        VARIANT *result,
+        const wchar_t *name,
+        Ts&&... ts);
+
+    template <typename... Ts>
+    bool invoke(DispatchFlags flags,
+        VARIANT *result,
+        const std::string &name,
+        Ts&&... ts);
+
+    template <typename... Ts>
+    bool invoke(DispatchFlags flags,
+        VARIANT *result,
+        const char *name,
+        Ts&&... ts);
+
+    template <size_t N, typename... Ts>
+    bool invoke(DispatchFlags flags,
+        VARIANT *result,
+        const utf::WideLiteral<N> &name,
+        Ts&&... ts);
+
+    template <typename... Ts>
+    bool get_(Variant &result,
+        Ts&&... ts);
 
     template <typename... Ts>
-    MethodResult put_(Ts&&... ts);
+    bool put_(Variant &result,
+        Ts&&... ts);
 
     template <typename... Ts>
-    MethodResult putref_(Ts&&... ts);
+    bool putref_(Variant &result,
+        Ts&&... ts);
 
     template <typename... Ts>
-    MethodResult method_(Ts&&... ts);
+    bool method_(Variant &result,
+        Ts&&... ts);
 
     friend bool operator==(const DispatchBase &left,
         const DispatchBase &right);
@@ -130,8 +178,8 @@ protected:
 
 public:
     DispatchBase() = default;
-    DispatchBase(const DispatchBase&) = default;
-    DispatchBase & operator=(const DispatchBase&) = default;
+    DispatchBase(const DispatchBase &other);
+    DispatchBase & operator=(const DispatchBase &other);
     DispatchBase(DispatchBase&&) = default;
     DispatchBase & operator=(DispatchBase&&) = default;
 
@@ -139,6 +187,17 @@ public:
 
     void open(IDispatch *dispatch);
     void reset();
+    void invalidate();
+
+    // BOUND MEMBERS
+    BoundMethod bind(const BstrView &name,
+        const DispatchFlags flags = METHOD);
+    BoundMethod bind(const Function id,
+        const DispatchFlags flags = METHOD);
+    BoundProperty bindProperty(const BstrView &name,
+        const DispatchFlags put = PUT);
+    BoundProperty bindProperty(const Function id,
+        const DispatchFlags put = PUT);
 
     // INTERNAL VARIANT
     template <typename... Ts>
@@ -184,10 +243,10 @@ template <
     typename T,
     typename Interface = T
 >
-class ComObject: public SharedPointer<Interface>
+class ComObject: public ComPtr<Interface>
 {
 protected:
-    typedef SharedPointer<Interface> Base;
+    typedef ComPtr<Interface> Base;
     typedef ComObject<Interface> This;
 
 public:
@@ -204,6 +263,8 @@ public:
 
 
 /** \brief Call dispatch method by function ID.
+ *
+ *  Arguments are packed on the stack, sized from the argument count.
  */
 template <typename... Ts>
 bool DispatchBase::invoke(DispatchFlags flags,
@@ -211,7 +272,7 @@ bool DispatchBase::invoke(DispatchFlags flags,
     const Function id,
     Ts&&... ts)
 {
-    DispParams dp;
+    DispParamsN<sizeof...(Ts)> dp;
     dp.setArgs(AUTOCOM_FWD(ts)...);
     dp.setFlags(flags);
 
@@ -231,54 +292,130 @@ bool DispatchBase::invoke(DispatchFlags flags,
 }
 
 
+/** \brief Call dispatch method by viewed function name, without a copy.
+ */
 template <typename... Ts>
-MethodResult DispatchBase::get_(Ts&&... ts)
+bool DispatchBase::invoke(DispatchFlags flags,
+    VARIANT *result,
+    const BstrView &name,
+    Ts&&... ts)
+{
+    return invoke(flags, result, getFunction(name), AUTOCOM_FWD(ts)...);
+}
+
+
+/** \brief Call dispatch method by wide function name, without a BSTR.
+ */
+template <typename... Ts>
+bool DispatchBase::invoke(DispatchFlags flags,
+    VARIANT *result,
+    const std::wstring &name,
+    Ts&&... ts)
+{
+    return invoke(flags, result, getFunction(name.c_str()), AUTOCOM_FWD(ts)...);
+}
+
+
+/** \brief Call dispatch method by wide function name, without a BSTR.
+ */
+template <typename... Ts>
+bool DispatchBase::invoke(DispatchFlags flags,
+    VARIANT *result,
+    const wchar_t *name,
+    Ts&&... ts)
+{
+    return invoke(flags, result, getFunction(name), AUTOCOM_FWD(ts)...);
+}
+
+
+/** \brief Call dispatch method by narrow function name, using the
+ *  interned BSTR for the name.
+ */
+template <typename... Ts>
+bool DispatchBase::invoke(DispatchFlags flags,
+    VARIANT *result,
+    const std::string &name,
+    Ts&&... ts)
+{
+    return invoke(flags, result, getFunction(INTERN_BSTR(name)), AUTOCOM_FWD(ts)...);
+}
+
+
+/** \brief Call dispatch method by narrow function name, using the
+ *  interned BSTR for the name.
+ */
+template <typename... Ts>
+bool DispatchBase::invoke(DispatchFlags flags,
+    VARIANT *result,
+    const char *name,
+    Ts&&... ts)
+{
+    return invoke(flags, result, getFunction(INTERN_BSTR(name)), AUTOCOM_FWD(ts)...);
+}
+
+
+/** \brief Call dispatch method by compile-time wide literal.
+ */
+template <size_t N, typename... Ts>
+bool DispatchBase::invoke(DispatchFlags flags,
+    VARIANT *result,
+    const utf::WideLiteral<N> &name,
+    Ts&&... ts)
+{
+    return invoke(flags, result, name.c_str(), AUTOCOM_FWD(ts)...);
+}
+
+
+/** \brief Get property into `result`, and convert to the reference.
+ */
+template <typename... Ts>
+bool DispatchBase::get_(Variant &result,
+    Ts&&... ts)
 {
     static_assert(sizeof...(Ts) == 2, "Must provide function and reference");
 
-    Variant result;
     if (invoke(GET, &result, packGet<0>(AUTOCOM_FWD(ts)...))) {
         autocom::get(result, packGet<1>(AUTOCOM_FWD(ts)...));
-        return std::make_pair(result, true);
+        return true;
     }
 
-    return std::make_pair(result, false);
+    return false;
 }
 
 
+/** \brief Put property, storing the return value in `result`.
+ */
 template <typename... Ts>
-MethodResult DispatchBase::put_(Ts&&... ts)
+bool DispatchBase::put_(Variant &result,
+    Ts&&... ts)
 {
     static_assert(sizeof...(Ts) >= 1, "Must provide function identifier");
 
-    Variant result;
-    auto status = invoke(PUT, &result, AUTOCOM_FWD(ts)...);
-
-    return std::make_pair(result, status);
+    return invoke(PUT, &result, AUTOCOM_FWD(ts)...);
 }
 
 
+/** \brief Putref property, storing the return value in `result`.
+ */
 template <typename... Ts>
-MethodResult DispatchBase::putref_(Ts&&... ts)
+bool DispatchBase::putref_(Variant &result,
+    Ts&&... ts)
 {
     static_assert(sizeof...(Ts) >= 1, "Must provide function identifier");
 
-    Variant result;
-    auto status = invoke(PUTREF, &result, AUTOCOM_FWD(ts)...);
-
-    return std::make_pair(result, status);
+    return invoke(PUTREF, &result, AUTOCOM_FWD(ts)...);
 }
 
 
+/** \brief Call method, storing the return value in `result`.
+ */
 template <typename... Ts>
-MethodResult DispatchBase::method_(Ts&&... ts)
+bool DispatchBase::method_(Variant &result,
+    Ts&&... ts)
 {
     static_assert(sizeof...(Ts) >= 1, "Must provide function identifier");
 
-    Variant result;
-    auto status = invoke(METHOD, &result, AUTOCOM_FWD(ts)...);
-
-    return std::make_pair(result, status);
+    return invoke(METHOD, &result, AUTOCOM_FWD(ts)...);
 }
 
 
@@ -287,7 +424,8 @@ MethodResult DispatchBase::method_(Ts&&... ts)
 template <typename... Ts>
 bool DispatchBase::get(Ts&&... ts)
 {
-    return get_(AUTOCOM_FWD(ts)...).second;
+    Variant result;
+    return get_(result, AUTOCOM_FWD(ts)...);
 }
 
 
@@ -296,7 +434,8 @@ bool DispatchBase::get(Ts&&... ts)
 template <typename... Ts>
 bool DispatchBase::put(Ts&&... ts)
 {
-    return put_(AUTOCOM_FWD(ts)...).second;
+    Variant result;
+    return put_(result, AUTOCOM_FWD(ts)...);
 }
 
 
@@ -305,7 +444,8 @@ bool DispatchBase::put(Ts&&... ts)
 template <typename... Ts>
 bool DispatchBase::putref(Ts&&... ts)
 {
-    return putref_(AUTOCOM_FWD(ts)...).second;
+    Variant result;
+    return putref_(result, AUTOCOM_FWD(ts)...);
 }
 
 
@@ -314,21 +454,25 @@ bool DispatchBase::putref(Ts&&... ts)
 template <typename... Ts>
 bool DispatchBase::method(Ts&&... ts)
 {
-    return method_(AUTOCOM_FWD(ts)...).second;
+    Variant result;
+    return method_(result, AUTOCOM_FWD(ts)...);
 }
 
 
 /** \brief Call get with return variant.
+ *
+ *  The result is returned in place, so arrays and strings returned
+ *  by the server are never copied.
  */
 template <typename... Ts>
 Variant DispatchBase::getV(Ts&&... ts)
 {
-    auto value = get_(AUTOCOM_FWD(ts)...);
-    if (!value.second) {
+    Variant result;
+    if (!get_(result, AUTOCOM_FWD(ts)...)) {
         throw ComMethodError("IDispatch", "Invoke(DISPATCH_PROPERTYGET, ...)");
     }
 
-    return value.first;
+    return result;
 }
 
 
@@ -337,12 +481,12 @@ Variant DispatchBase::getV(Ts&&... ts)
 template <typename... Ts>
 Variant DispatchBase::putV(Ts&&... ts)
 {
-    auto value = put_(AUTOCOM_FWD(ts)...);
-    if (!value.second) {
+    Variant result;
+    if (!put_(result, AUTOCOM_FWD(ts)...)) {
         throw ComMethodError("IDispatch", "Invoke(DISPATCH_PROPERTYPUT, ...)");
     }
 
-    return value.first;
+    return result;
 }
 
 
@@ -351,26 +495,29 @@ Variant DispatchBase::putV(Ts&&... ts)
 template <typename... Ts>
 Variant DispatchBase::putrefV(Ts&&... ts)
 {
-    auto value = putref_(AUTOCOM_FWD(ts)...);
-    if (!value.second) {
+    Variant result;
+    if (!putref_(result, AUTOCOM_FWD(ts)...)) {
         throw ComMethodError("IDispatch", "Invoke(DISPATCH_PROPERTYPUTREF, ...)");
     }
 
-    return value.first;
+    return result;
 }
 
 
 /** \brief Call method with return variant.
+ *
+ *  The result is returned in place, so arrays and strings returned
+ *  by the server are never copied.
  */
 template <typename... Ts>
 Variant DispatchBase::methodV(Ts&&... ts)
 {
-    auto value = method_(AUTOCOM_FWD(ts)...);
-    if (!value.second) {
+    Variant result;
+    if (!method_(result, AUTOCOM_FWD(ts)...)) {
         throw ComMethodError("IDispatch", "Invoke(DISPATCH_METHOD, ...)");
     }
 
-    return value.first;
+    return result;
 }
 
 
@@ -0,0 +1,82 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoCOM
+ *  \brief Cached DISPID lookup for late-bound calls.
+ *
+ *  GetIDsOfNames is a full COM round-trip, which doubles the cost of
+ *  every name-based call to an out-of-process server. Caches map
+ *  member names to DISPIDs case-insensitively, like GetIDsOfNames.
+ *  They are created on the first lookup or copy, filled lazily, and
+ *  shared by all copies of a DispatchBase.
+ *
+ *  By default each object gets its own cache. Objects can instead
+ *  share one cache per type, keyed by the GUID of their ITypeInfo.
+ *  IDispatchEx objects always get their own cache, because their
+ *  members can change.
+ */
+
+#pragma once
+
+#include "bstr.hpp"
+
+#include <oaidl.h>
+
+#include <deque>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+
+
+namespace autocom
+{
+// OBJECTS
+// -------
+
+
+/** \brief Thread-safe, case-insensitive cache of DISPIDs by name.
+ *
+ *  Keys view names owned by the cache, so lookups never copy the
+ *  name, and clear() frees names such as IDispatchEx expandos.
+ */
+class DispidCache
+{
+protected:
+    mutable std::shared_timed_mutex mutex;
+    std::deque<Bstr> names;
+    std::unordered_map<BstrView, DISPID, BstrHashNoCase, BstrEqualNoCase> ids;
+
+public:
+    bool find(const BstrView &name,
+        DISPID &id) const;
+    void insert(const BstrView &name,
+        const DISPID id);
+    void clear();
+    size_t size() const;
+};
+
+typedef std::shared_ptr<DispidCache> DispidCachePtr;
+
+// FUNCTIONS
+// ---------
+
+/** \brief Check if DISPID caches are shared by type.
+ */
+bool dispidCacheByType();
+
+/** \brief Share DISPID caches between objects with the same type.
+ *
+ *  Sharing is opt-in, and only affects objects opened afterwards.
+ *  Each object opened with sharing enabled costs a few calls to read
+ *  its type info.
+ */
+void setDispidCacheByType(const bool enabled);
+
+/** \brief Get a DISPID cache for an object.
+ *
+ *  \return     Cache shared by type, if enabled and the type is known,
+ *              otherwise a new cache.
+ */
+DispidCachePtr newDispidCache(IDispatch *dispatch);
+
+}   /* autocom */
@@ -62,7 +62,7 @@ constexpr bool IsDispParamsV = IsDispParams<T>::value;
 
 /** \brief No-op sink for argument-free params.
  */
-inline void setArg(VariantList &variants,
+inline void setArg(Variant *variants,
     const size_t index)
 {}
 
@@ -70,7 +70,7 @@ inline void setArg(VariantList &variants,
 /** \brief Forward parameter to rvargs.
  */
 template <typename T>
-void setArg(VariantList &variants,
+void setArg(Variant *variants,
     const size_t index,
     T &&t)
 {
@@ -90,7 +90,7 @@ template <
     typename T,
     typename... Ts
 >
-void setArg(VariantList &variants,
+void setArg(Variant *variants,
     const size_t index,
     T t,
     Ts&&... ts)
@@ -136,6 +136,39 @@ public:
 };
 
 
+/** \brief DISPPARAMS with fixed-capacity, stack-resident arguments.
+ *
+ *  Builds DISPPARAMS::rgvarg in place for exactly `N` arguments, so
+ *  packing a call allocates nothing beyond what each `set()` overload
+ *  allocates. DISPPARAMS points into the object, so it is neither
+ *  copyable nor movable.
+ */
+template <size_t N>
+class DispParamsN
+{
+protected:
+    DISPPARAMS dp = {nullptr, nullptr, 0, 0};
+    Variant vargs[N ? N : 1];
+    DISPID named = DISPID_PROPERTYPUT;
+
+public:
+    DispParamsN() = default;
+    DispParamsN(const DispParamsN&) = delete;
+    DispParamsN & operator=(const DispParamsN&) = delete;
+
+    // SETTERS
+    template <typename... Ts>
+    void setArgs(Ts&&... ts);
+    void setFlags(const DispatchFlags flags);
+
+    // GETTERS
+    DISPPARAMS * params();
+    const DISPPARAMS * params() const;
+    const Variant * args() const;
+    size_t size() const;
+};
+
+
 // IMPLEMENTATION
 // --------------
 
@@ -147,11 +180,76 @@ void DispParams::setArgs(Ts&&... ts)
 {
     constexpr size_t size = sizeof...(Ts);
     vargs.resize(size);
-    setArg(vargs, sizeof...(Ts)-1, AUTOCOM_FWD(ts)...);
+    setArg(vargs.data(), sizeof...(Ts)-1, AUTOCOM_FWD(ts)...);
     dp.rgvarg = const_cast<Variant*>(vargs.data());
     dp.cArgs = size;
 }
 
+
+/** \brief Set argument list for dispparams, in place.
+ */
+template <size_t N>
+template <typename... Ts>
+void DispParamsN<N>::setArgs(Ts&&... ts)
+{
+    static_assert(sizeof...(Ts) == N, "Argument count must match capacity");
+
+    for (Variant &variant: vargs) {
+        variant.clear();
+    }
+    setArg(vargs, sizeof...(Ts)-1, AUTOCOM_FWD(ts)...);
+    dp.rgvarg = N ? vargs : nullptr;
+    dp.cArgs = N;
+}
+
+
+/** \brief Set dispatch method, altering the named argument count.
+ */
+template <size_t N>
+void DispParamsN<N>::setFlags(const DispatchFlags flags)
+{
+    if (!!(flags & (PUT | PUTREF))) {
+        dp.cNamedArgs = 1;
+        dp.rgdispidNamedArgs = &named;
+    }
+}
+
+
+/** \brief Get access to raw dispparams.
+ */
+template <size_t N>
+DISPPARAMS * DispParamsN<N>::params()
+{
+    return &dp;
+}
+
+
+/** \brief Get access to raw dispparams.
+ */
+template <size_t N>
+const DISPPARAMS * DispParamsN<N>::params() const
+{
+    return &dp;
+}
+
+
+/** \brief Get access to raw arg array.
+ */
+template <size_t N>
+const Variant * DispParamsN<N>::args() const
+{
+    return vargs;
+}
+
+
+/** \brief Get number of arguments.
+ */
+template <size_t N>
+size_t DispParamsN<N>::size() const
+{
+    return N;
+}
+
 }   /* autocom */
 
 #ifdef _MSC_VER
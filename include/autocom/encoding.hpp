@@ -8,4 +8,9 @@
 #pragma once
 
 #include "encoding/converters.hpp"
+#include "encoding/literal.hpp"
+#include "encoding/parallel.hpp"
+#include "encoding/simd.hpp"
+#include "encoding/transcoder.hpp"
 #include "encoding/unicode.hpp"
+#include "encoding/view.hpp"
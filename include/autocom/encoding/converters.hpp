@@ -3,13 +3,25 @@
 /**
  *  \addtogroup AutoCOM
  *  \brief Character set conversion utilities.
+ *
+ *  Wide strings are UTF-16 where wchar_t is 2 bytes, as on Windows,
+ *  and UTF-32 where wchar_t is 4 bytes.
  */
 
+#pragma once
+
 #include <string>
 
 
 namespace autocom
 {
+struct Parallel;
+
+namespace utf
+{
+using autocom::Parallel;
+}   /* utf */
+
 // FUNCTIONS
 // ---------
 
@@ -18,9 +30,169 @@ namespace autocom
 std::wstring WIDE(const std::string &narrow);
 
 
+/** \brief Convert UTF-8 character array to wide UTF-16.
+ */
+std::wstring WIDE(const char *narrow,
+    const size_t length);
+
+
+/** \brief Convert UTF-8 to wide UTF-16, in parallel for large inputs.
+ */
+std::wstring WIDE(const std::string &narrow,
+    const utf::Parallel &parallel);
+
+
+/** \brief Convert UTF-8 character array to wide UTF-16, in parallel
+ *  for large inputs.
+ */
+std::wstring WIDE(const char *narrow,
+    const size_t length,
+    const utf::Parallel &parallel);
+
+
+/** \brief Convert UTF-8 to wide UTF-16 in a caller-provided buffer.
+ *
+ *  \throws BufferRangeError    If wide cannot hold the result.
+ *  \return     Number of code units written to wide.
+ */
+size_t WIDE(const char *narrow,
+    const size_t length,
+    wchar_t *wide,
+    const size_t capacity);
+
+
+/** \brief Get exact number of UTF-16 code units to store narrow.
+ */
+size_t WIDE_LENGTH(const char *narrow,
+    const size_t length);
+
+
+/** \brief Convert UTF-8 to wide UTF-16 in a buffer sized by WIDE_LENGTH.
+ *
+ *  Skips the capacity check, which recomputes the exact length, so
+ *  callers which already know it do not pay for it twice. Output is
+ *  still bounded by `size`.
+ *
+ *  \return     Number of code units written to wide.
+ */
+size_t WIDE_EXACT(const char *narrow,
+    const size_t length,
+    wchar_t *wide,
+    const size_t size);
+
+
+/** \brief Convert UTF-8 to wide UTF-16 in a thread-local buffer.
+ *
+ *  \warning The result is overwritten by the next call on the same
+ *  thread, copy it to keep it.
+ */
+const std::wstring & WIDE_SCRATCH(const char *narrow,
+    const size_t length);
+
+
+/** \brief Convert UTF-8 to wide UTF-16 in a thread-local buffer.
+ */
+const std::wstring & WIDE_SCRATCH(const std::string &narrow);
+
+
 /** \brief Convert UTF-16 to narrow UTF-8.
  */
 std::string NARROW(const std::wstring &wide);
 
 
+/** \brief Convert UTF-16 character array to narrow UTF-8.
+ */
+std::string NARROW(const wchar_t *wide,
+    const size_t length);
+
+
+/** \brief Convert UTF-16 to narrow UTF-8, in parallel for large inputs.
+ */
+std::string NARROW(const std::wstring &wide,
+    const utf::Parallel &parallel);
+
+
+/** \brief Convert UTF-16 character array to narrow UTF-8, in parallel
+ *  for large inputs.
+ */
+std::string NARROW(const wchar_t *wide,
+    const size_t length,
+    const utf::Parallel &parallel);
+
+
+/** \brief Convert UTF-16 to narrow UTF-8 in a caller-provided buffer.
+ *
+ *  \throws BufferRangeError    If narrow cannot hold the result.
+ *  \return     Number of code units written to narrow.
+ */
+size_t NARROW(const wchar_t *wide,
+    const size_t length,
+    char *narrow,
+    const size_t capacity);
+
+
+/** \brief Get exact number of UTF-8 code units to store wide.
+ */
+size_t NARROW_LENGTH(const wchar_t *wide,
+    const size_t length);
+
+
+/** \brief Convert UTF-16 to narrow UTF-8 in a buffer sized by NARROW_LENGTH.
+ *
+ *  Skips the capacity check, which recomputes the exact length, so
+ *  callers which already know it do not pay for it twice. Output is
+ *  still bounded by `size`.
+ *
+ *  \return     Number of code units written to narrow.
+ */
+size_t NARROW_EXACT(const wchar_t *wide,
+    const size_t length,
+    char *narrow,
+    const size_t size);
+
+
+/** \brief Convert UTF-16 to narrow UTF-8 in a thread-local buffer.
+ *
+ *  \warning The result is overwritten by the next call on the same
+ *  thread, copy it to keep it.
+ */
+const std::string & NARROW_SCRATCH(const wchar_t *wide,
+    const size_t length);
+
+
+/** \brief Convert UTF-16 to narrow UTF-8 in a thread-local buffer.
+ */
+const std::string & NARROW_SCRATCH(const std::wstring &wide);
+
+
+/** \brief Convert UTF-8 to a wide UTF-16 string using allocator.
+ */
+template <typename Allocator>
+auto WIDE(const std::string &narrow,
+    const Allocator &allocator)
+    -> std::basic_string<wchar_t, std::char_traits<wchar_t>, Allocator>
+{
+    const size_t length = WIDE_LENGTH(narrow.data(), narrow.size());
+    std::basic_string<wchar_t, std::char_traits<wchar_t>, Allocator> wide(length, L'\0', allocator);
+    WIDE_EXACT(narrow.data(), narrow.size(), &wide[0], length);
+
+    return wide;
+}
+
+
+/** \brief Convert UTF-16 to a narrow UTF-8 string using allocator.
+ */
+template <typename Allocator>
+auto NARROW(const std::wstring &wide,
+    const Allocator &allocator)
+    -> std::basic_string<char, std::char_traits<char>, Allocator>
+{
+    const size_t length = NARROW_LENGTH(wide.data(), wide.size());
+    std::basic_string<char, std::char_traits<char>, Allocator> narrow(length, '\0', allocator);
+    NARROW_EXACT(wide.data(), wide.size(), &narrow[0], length);
+
+    return narrow;
+}
+
+
 }   /* autocom */
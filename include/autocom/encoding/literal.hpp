@@ -0,0 +1,104 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/**
+ *  \addtogroup AutoCOM
+ *  \brief Compile-time UTF-8 to wide string literals.
+ *
+ *  Transcodes narrow UTF-8 literals to wide strings during compilation,
+ *  so method and property names need no runtime conversion.
+ *
+ *  \code
+ *      dispatch.method(AUTOCOM_WIDE("GetVersionNumber"), version);
+ *  \endcode
+ */
+
+#pragma once
+
+#include "unicode.hpp"
+
+#include <cstddef>
+
+
+namespace autocom
+{
+namespace utf
+{
+// OBJECTS
+// -------
+
+
+/** \brief Wide string with static storage, transcoded at compile time.
+ *
+ *  `N` is the size of the narrow literal, including the terminator,
+ *  which bounds the number of wide code units.
+ */
+template <size_t N>
+struct WideLiteral
+{
+    wchar_t buffer[N] = {};
+    size_t length = 0;
+
+    constexpr const wchar_t * data() const
+    {
+        return buffer;
+    }
+
+    constexpr const wchar_t * c_str() const
+    {
+        return buffer;
+    }
+
+    constexpr size_t size() const
+    {
+        return length;
+    }
+};
+
+// FUNCTIONS
+// ---------
+
+
+/** \brief Transcode a narrow UTF-8 literal to a wide literal.
+ *
+ *  Writes UTF-16 where wchar_t is 16-bit, and UTF-32 otherwise. Uses
+ *  the strict runtime decoder, so malformed literals fail to compile
+ *  rather than being replaced.
+ */
+template <size_t N>
+constexpr WideLiteral<N> wideLiteral(const char (&narrow)[N])
+{
+    WideLiteral<N> literal;
+    const char *src = narrow;
+    const char *srcEnd = narrow + N - 1;
+    wchar_t *dst = literal.buffer;
+    wchar_t *dstEnd = literal.buffer + N;
+    while (src < srcEnd) {
+        const uint32_t c = detail::utf8To32(src, srcEnd, true);
+        if (sizeof(wchar_t) == 2) {
+            detail::utf32To16(c, dst, dstEnd, true);
+        } else {
+            *dst++ = static_cast<wchar_t>(c);
+        }
+    }
+    literal.length = static_cast<size_t>(dst - literal.buffer);
+
+    return literal;
+}
+
+
+}   /* utf */
+}   /* autocom */
+
+// MACROS
+// ------
+
+/** \brief Get reference to a wide literal with static storage.
+ *
+ *  The literal is transcoded by the compiler, and a malformed UTF-8
+ *  literal is a compile error.
+ */
+#define AUTOCOM_WIDE(narrow)                                            \
+    ([]() -> const ::autocom::utf::WideLiteral<sizeof(narrow)>& {       \
+        static constexpr auto literal = ::autocom::utf::wideLiteral(narrow); \
+        return literal;                                                 \
+    }())
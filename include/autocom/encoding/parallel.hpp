@@ -0,0 +1,208 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/**
+ *  \addtogroup AutoCOM
+ *  \brief Multi-threaded UTF-8 and UTF-16 transcoding for large inputs.
+ *
+ *  Splits the input at character boundaries, sizes each chunk
+ *  concurrently, prefix-sums the sizes into output offsets, and then
+ *  transcodes every chunk concurrently into a single output buffer.
+ *  The output is identical to the serial converters.
+ */
+
+#pragma once
+
+#include "simd.hpp"
+#include "transcoder.hpp"
+#include "autocom/util/parallel.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+
+namespace autocom
+{
+namespace utf
+{
+// OBJECTS
+// -------
+
+/** \brief Policy for parallel transcoding, shared with other modules.
+ */
+using autocom::Parallel;
+using autocom::SERIAL;
+
+// FUNCTIONS
+// ---------
+
+/** \brief Get the default policy used by WIDE() and NARROW().
+ */
+Parallel parallel();
+
+/** \brief Set the default policy used by WIDE() and NARROW().
+ *
+ *  Parallel transcoding is opt-in, the default policy is SERIAL.
+ */
+void setParallel(const Parallel &parallel);
+
+/** \brief Convert UTF8 to UTF16, in parallel for large inputs.
+ */
+std::string utf8To16(const std::string &string,
+    const Parallel &parallel);
+
+/** \brief Convert UTF16 to UTF8, in parallel for large inputs.
+ */
+std::string utf16To8(const std::string &string,
+    const Parallel &parallel);
+
+namespace detail
+{
+// KERNELS
+// -------
+
+
+/** \brief Sizing and conversion kernels for a parallel encoding pair.
+ */
+template <typename C1, typename C2>
+struct ParallelKernel;
+
+
+template <>
+struct ParallelKernel<uint8_t, uint16_t>
+{
+    static size_t length(const uint8_t *srcBegin,
+        const uint8_t *srcEnd,
+        bool strict)
+    {
+        return simd::utf8To16Length(srcBegin, srcEnd, strict);
+    }
+
+    static size_t convert(const uint8_t *srcBegin,
+        const uint8_t *srcEnd,
+        uint16_t *dstBegin,
+        uint16_t *dstEnd,
+        bool strict)
+    {
+        return simd::utf8To16(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+    }
+};
+
+
+template <>
+struct ParallelKernel<uint16_t, uint8_t>
+{
+    static size_t length(const uint16_t *srcBegin,
+        const uint16_t *srcEnd,
+        bool strict)
+    {
+        return simd::utf16To8Length(srcBegin, srcEnd, strict);
+    }
+
+    static size_t convert(const uint16_t *srcBegin,
+        const uint16_t *srcEnd,
+        uint8_t *dstBegin,
+        uint8_t *dstEnd,
+        bool strict)
+    {
+        return simd::utf16To8(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+    }
+};
+
+
+template <>
+struct ParallelKernel<uint8_t, uint32_t>
+{
+    static size_t length(const uint8_t *srcBegin,
+        const uint8_t *srcEnd,
+        bool strict)
+    {
+        return utf8To32Length(srcBegin, srcEnd, strict);
+    }
+
+    static size_t convert(const uint8_t *srcBegin,
+        const uint8_t *srcEnd,
+        uint32_t *dstBegin,
+        uint32_t *dstEnd,
+        bool strict)
+    {
+        return utf8To32(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+    }
+};
+
+
+template <>
+struct ParallelKernel<uint32_t, uint8_t>
+{
+    static size_t length(const uint32_t *srcBegin,
+        const uint32_t *srcEnd,
+        bool strict)
+    {
+        return utf32To8Length(srcBegin, srcEnd, strict);
+    }
+
+    static size_t convert(const uint32_t *srcBegin,
+        const uint32_t *srcEnd,
+        uint8_t *dstBegin,
+        uint8_t *dstEnd,
+        bool strict)
+    {
+        return utf32To8(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+    }
+};
+
+
+/** \brief Transcode src to C2 code units across multiple threads.
+ *
+ *  `allocate(n)` is called once with the exact output length, and must
+ *  return a buffer of at least `n` code units.
+ *
+ *  \return     Number of code units written.
+ */
+template <typename C1, typename C2, typename Allocate>
+size_t transcode(const C1 *srcBegin,
+    const C1 *srcEnd,
+    Allocate allocate,
+    const Parallel &parallel,
+    bool strict = true)
+{
+    typedef ParallelKernel<C1, C2> kernel;
+
+    // split at character boundaries
+    const size_t length = srcEnd - srcBegin;
+    const size_t chunks = parallel.workers(length);
+    std::vector<const C1*> bounds(chunks + 1, srcEnd);
+    bounds[0] = srcBegin;
+    for (size_t i = 1; i < chunks; ++i) {
+        const auto split = srcBegin + length * i / chunks;
+        bounds[i] = std::max(srcBegin + boundary(srcBegin, split), bounds[i-1]);
+    }
+
+    // size chunks, and prefix-sum into output offsets
+    std::vector<size_t> offsets(chunks + 1, 0);
+    if (chunks == 1) {
+        offsets[1] = kernel::length(srcBegin, srcEnd, strict);
+    } else {
+        forEachChunk(chunks, [&](size_t i) {
+            offsets[i+1] = kernel::length(bounds[i], bounds[i+1], strict);
+        });
+    }
+    for (size_t i = 0; i < chunks; ++i) {
+        offsets[i+1] += offsets[i];
+    }
+
+    // transcode chunks into their output ranges
+    C2 *dst = allocate(offsets[chunks]);
+    if (chunks == 1) {
+        return kernel::convert(srcBegin, srcEnd, dst, dst + offsets[1], strict);
+    }
+    forEachChunk(chunks, [&](size_t i) {
+        kernel::convert(bounds[i], bounds[i+1], dst + offsets[i], dst + offsets[i+1], strict);
+    });
+
+    return offsets[chunks];
+}
+
+}   /* detail */
+}   /* utf */
+}   /* autocom */
@@ -0,0 +1,164 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/**
+ *  \addtogroup AutoCOM
+ *  \brief Vectorized UTF-8 and UTF-16 transcoding kernels.
+ *
+ *  The kernels transcode 16 (SSE2, NEON) or 32 (AVX2) code units per
+ *  iteration. All-ASCII blocks are widened or narrowed directly. Other
+ *  blocks are validated in vector registers, and their leading 1, 2
+ *  and 3-byte characters are decoded or encoded in parallel and packed
+ *  with byte shuffles. SSE2 has no byte shuffle, so it packs them with
+ *  a branch-free store loop instead. 4-byte sequences, surrogates and
+ *  invalid input fall back to the scalar converters in unicode.hpp,
+ *  one code point at a time, so the output is identical to theirs.
+ *
+ *  Also compares and case-folds UTF-16 strings, for BSTR ordering and
+ *  hashing, where folding only changes ASCII letters. The
+ *  instruction set is detected from the host CPU on first use.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace autocom
+{
+namespace utf
+{
+namespace simd
+{
+// ENUM
+// ----
+
+
+/** \brief Instruction sets with dedicated transcoding kernels.
+ */
+enum class Isa
+{
+    SCALAR          = 0,
+    SSE2            = 1,
+    AVX2            = 2,
+    NEON            = 3,
+};
+
+// FUNCTIONS
+// ---------
+
+/** \brief Check if the host CPU supports the instruction set.
+ */
+bool supported(const Isa isa);
+
+/** \brief Get the best instruction set supported by the host CPU.
+ */
+Isa detect();
+
+/** \brief Get the instruction set currently used by the kernels.
+ */
+Isa isa();
+
+/** \brief Override the instruction set used by the kernels.
+ *
+ *  \throws std::invalid_argument   If the host does not support `isa`.
+ */
+void setIsa(const Isa isa);
+
+/** \brief Get number of leading ASCII bytes in src.
+ */
+size_t asciiLength(const uint8_t *srcBegin,
+    const uint8_t *srcEnd);
+
+/** \brief Get number of leading ASCII code units in src.
+ */
+size_t asciiLength(const uint16_t *srcBegin,
+    const uint16_t *srcEnd);
+
+/** \brief Widen ASCII bytes to UTF-16.
+ *
+ *  \warning src must be ASCII and dst must hold `srcEnd - srcBegin`
+ *  code units.
+ */
+void widenAscii(const uint8_t *srcBegin,
+    const uint8_t *srcEnd,
+    uint16_t *dst);
+
+/** \brief Narrow ASCII code units to UTF-8.
+ *
+ *  \warning src must be ASCII and dst must hold `srcEnd - srcBegin`
+ *  bytes.
+ */
+void narrowAscii(const uint16_t *srcBegin,
+    const uint16_t *srcEnd,
+    uint8_t *dst);
+
+/** \brief Get number of leading code units which are identical.
+ */
+size_t mismatch(const uint16_t *left,
+    const uint16_t *right,
+    const size_t length);
+
+/** \brief Get number of leading code units which are identical,
+ *  after folding ASCII lowercase letters to uppercase.
+ */
+size_t mismatchNoCase(const uint16_t *left,
+    const uint16_t *right,
+    const size_t length);
+
+/** \brief Fold ASCII lowercase letters to uppercase.
+ *
+ *  Other code units are copied unchanged, and dst must hold
+ *  `srcEnd - srcBegin` code units. src and dst may be identical.
+ */
+void upperAscii(const uint16_t *srcBegin,
+    const uint16_t *srcEnd,
+    uint16_t *dst);
+
+/** \brief Get exact number of code units utf8To16 writes for src.
+ *
+ *  Counts 1 to 3-byte characters with the vectorized validator, and
+ *  decodes the remaining characters one at a time.
+ */
+size_t utf8To16Length(const uint8_t *srcBegin,
+    const uint8_t *srcEnd,
+    bool strict = true);
+
+/** \brief Get exact number of code units utf16To8 writes for src.
+ *
+ *  Counts code units up to the next surrogate with the vectorized
+ *  kernels, and decodes the remaining characters one at a time.
+ */
+size_t utf16To8Length(const uint16_t *srcBegin,
+    const uint16_t *srcEnd,
+    bool strict = true);
+
+/** \brief Convert UTF8 to UTF16.
+ *
+ *  Vectorized except for 4-byte characters and surrogates, see the
+ *  file documentation.
+ *
+ *  \return     Number of code units written to dst.
+ */
+size_t utf8To16(const uint8_t *srcBegin,
+    const uint8_t *srcEnd,
+    uint16_t *dstBegin,
+    uint16_t *dstEnd,
+    bool strict = true);
+
+/** \brief Convert UTF16 to UTF8.
+ *
+ *  Vectorized except for 4-byte characters and surrogates, see the
+ *  file documentation.
+ *
+ *  \return     Number of code units written to dst.
+ */
+size_t utf16To8(const uint16_t *srcBegin,
+    const uint16_t *srcEnd,
+    uint8_t *dstBegin,
+    uint8_t *dstEnd,
+    bool strict = true);
+
+}   /* simd */
+}   /* utf */
+}   /* autocom */
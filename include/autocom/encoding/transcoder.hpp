@@ -0,0 +1,303 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/**
+ *  \addtogroup AutoCOM
+ *  \brief Incremental transcoder for chunked Unicode input.
+ *
+ *  Converts input which arrives in arbitrary chunks, such as from
+ *  files or pipes, into caller-provided buffers. Sequences split across
+ *  chunk boundaries are carried over to the next call, so the output is
+ *  identical to converting the concatenated input at once.
+ */
+
+#pragma once
+
+#include "unicode.hpp"
+
+#include <algorithm>
+
+
+namespace autocom
+{
+namespace utf
+{
+namespace detail
+{
+// BOUNDARIES
+// ----------
+
+
+/** \brief Check if a code unit can extend an incomplete sequence.
+ */
+inline bool continues(const uint8_t c)
+{
+    return (c & 0xC0) == 0x80;
+}
+
+
+/** \brief Check if a code unit can extend an incomplete sequence.
+ */
+inline bool continues(const uint16_t c)
+{
+    return c >= 0xDC00 && c <= 0xDFFF;
+}
+
+
+/** \brief Check if a code unit can extend an incomplete sequence.
+ */
+inline bool continues(const uint32_t)
+{
+    return false;
+}
+
+
+/** \brief Get length of the prefix of src ending on a character boundary.
+ *
+ *  Only a trailing sequence which could still be completed by more
+ *  input is excluded, invalid bytes are left for the decoder.
+ */
+inline size_t boundary(const uint8_t *srcBegin,
+    const uint8_t *srcEnd)
+{
+    const size_t length = srcEnd - srcBegin;
+    size_t index = length;
+    size_t continuation = 0;
+    while (index > 0 && continuation < 3 && (srcBegin[index-1] & 0xC0) == 0x80) {
+        --index;
+        ++continuation;
+    }
+    if (index == 0) {
+        return length;
+    }
+
+    const uint8_t lead = srcBegin[index-1];
+    size_t bytes = 1;
+    if (lead >= 0xF0) {
+        bytes = 4;
+    } else if (lead >= 0xE0) {
+        bytes = 3;
+    } else if (lead >= 0xC0) {
+        bytes = 2;
+    }
+
+    return bytes > continuation + 1 ? index - 1 : length;
+}
+
+
+/** \brief Get length of the prefix of src ending on a character boundary.
+ */
+inline size_t boundary(const uint16_t *srcBegin,
+    const uint16_t *srcEnd)
+{
+    const size_t length = srcEnd - srcBegin;
+    if (length && srcEnd[-1] >= 0xD800 && srcEnd[-1] <= 0xDBFF) {
+        return length - 1;
+    }
+
+    return length;
+}
+
+
+/** \brief Get length of the prefix of src ending on a character boundary.
+ */
+inline size_t boundary(const uint32_t *srcBegin,
+    const uint32_t *srcEnd)
+{
+    return srcEnd - srcBegin;
+}
+
+}   /* detail */
+
+// OBJECTS
+// -------
+
+
+/** \brief Number of code units consumed and produced by a Transcoder.
+ */
+struct TranscodeResult
+{
+    size_t read = 0;
+    size_t written = 0;
+};
+
+
+/** \brief Stateful converter from `From` to `To` code units.
+ *
+ *  Each call consumes as much input as fits in the output buffer, and
+ *  reports the number of code units read and written. Call it again
+ *  with the unread input once the output has been drained, and call
+ *  `flush()` at the end of the input to emit any incomplete sequence.
+ *
+ *  \code
+ *      utf::Transcoder<uint8_t, uint16_t> transcoder;
+ *      while (auto size = read(file, chunk)) {
+ *          auto *src = chunk;
+ *          while (src < chunk + size) {
+ *              auto result = transcoder(src, chunk + size, out, out + 4096);
+ *              write(out, result.written);
+ *              src += result.read;
+ *          }
+ *      }
+ *      write(out, transcoder.flush(out, out + 4096));
+ *  \endcode
+ *
+ *  \warning The output buffer must hold at least `RATIO * 4` code
+ *  units to guarantee forward progress.
+ */
+template <typename From, typename To>
+class Transcoder
+{
+protected:
+    typedef Converter<From, To> converter;
+
+    static constexpr size_t MAX_SEQUENCE = 4;
+
+    From partial[MAX_SEQUENCE];
+    size_t size = 0;
+    bool strict;
+
+    size_t convertPartial(To *dstBegin,
+        To *dstEnd);
+
+public:
+    static constexpr size_t RATIO = converter::RATIO;
+
+    Transcoder(const bool strict = true);
+
+    TranscodeResult operator()(const From *srcBegin,
+        const From *srcEnd,
+        To *dstBegin,
+        To *dstEnd);
+    size_t flush(To *dstBegin,
+        To *dstEnd);
+    void reset();
+    size_t pending() const;
+};
+
+
+// IMPLEMENTATION
+// --------------
+
+
+/** \brief Initialize transcoder, with strict or replacement semantics.
+ */
+template <typename From, typename To>
+Transcoder<From, To>::Transcoder(const bool strict):
+    strict(strict)
+{}
+
+
+/** \brief Convert the carried sequence, if dst has room for it.
+ */
+template <typename From, typename To>
+size_t Transcoder<From, To>::convertPartial(To *dstBegin,
+    To *dstEnd)
+{
+    if (static_cast<size_t>(dstEnd - dstBegin) < size * RATIO) {
+        return 0;
+    }
+
+    const size_t count = size;
+    size = 0;
+
+    return converter::convert(partial, partial + count, dstBegin, dstEnd, strict);
+}
+
+
+/** \brief Convert a chunk of input into dst.
+ *
+ *  \return     Number of code units read from src and written to dst.
+ */
+template <typename From, typename To>
+TranscodeResult Transcoder<From, To>::operator()(const From *srcBegin,
+    const From *srcEnd,
+    To *dstBegin,
+    To *dstEnd)
+{
+    auto src = srcBegin;
+    auto dst = dstBegin;
+
+    // complete the sequence carried from the previous chunk, which
+    // is invalid if the next unit cannot extend it
+    bool complete = !size || detail::boundary(partial, partial + size) == size;
+    while (!complete && src < srcEnd && size < MAX_SEQUENCE && detail::continues(*src)) {
+        partial[size++] = *src++;
+        complete = detail::boundary(partial, partial + size) == size;
+    }
+    if (size && (complete || src < srcEnd || size == MAX_SEQUENCE)) {
+        dst += convertPartial(dst, dstEnd);
+    }
+
+    // convert whole characters, bounded by the worst-case output
+    while (!size && src < srcEnd) {
+        const size_t room = static_cast<size_t>(dstEnd - dst) / RATIO;
+        const size_t available = std::min<size_t>(room, srcEnd - src);
+        const auto stop = src + detail::boundary(src, src + available);
+        if (stop == src) {
+            break;
+        }
+        dst += converter::convert(src, stop, dst, dstEnd, strict);
+        src = stop;
+    }
+
+    // carry an incomplete trailing sequence
+    if (!size && src < srcEnd && detail::boundary(src, srcEnd) == 0) {
+        while (src < srcEnd) {
+            partial[size++] = *src++;
+        }
+    }
+
+    TranscodeResult result;
+    result.read = src - srcBegin;
+    result.written = dst - dstBegin;
+
+    return result;
+}
+
+
+/** \brief Write implementation for constexpr.
+ */
+template <typename From, typename To>
+constexpr size_t Transcoder<From, To>::MAX_SEQUENCE;
+
+
+/** \brief Convert any incomplete sequence at the end of the input.
+ *
+ *  \throws IllegalCharacterError   If strict and a sequence is pending.
+ *  \throws BufferRangeError        If dst cannot hold the replacement.
+ *  \return     Number of code units written to dst.
+ */
+template <typename From, typename To>
+size_t Transcoder<From, To>::flush(To *dstBegin,
+    To *dstEnd)
+{
+    if (!size) {
+        return 0;
+    } else if (static_cast<size_t>(dstEnd - dstBegin) < size * RATIO) {
+        throw detail::BufferRangeError();
+    }
+
+    return convertPartial(dstBegin, dstEnd);
+}
+
+
+/** \brief Discard any carried sequence.
+ */
+template <typename From, typename To>
+void Transcoder<From, To>::reset()
+{
+    size = 0;
+}
+
+
+/** \brief Get number of code units carried to the next call.
+ */
+template <typename From, typename To>
+size_t Transcoder<From, To>::pending() const
+{
+    return size;
+}
+
+
+}   /* utf */
+}   /* autocom */
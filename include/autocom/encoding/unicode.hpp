@@ -12,6 +12,10 @@
  *  their destination buffer.
  */
 
+#pragma once
+
+#include "autocom/encoding/simd.hpp"
+
 #include <array>
 #include <cstdint>
 #include <stdexcept>
@@ -31,7 +35,7 @@ namespace detail
 /** \brief Cast to UTF-32.
  */
 template <typename T>
-auto UTF32(T t)
+constexpr auto UTF32(T t)
     -> uint32_t
 {
     return static_cast<uint32_t>(t);
@@ -41,7 +45,7 @@ auto UTF32(T t)
 /** \brief Cast to UTF-16.
  */
 template <typename T>
-auto UTF16(T t)
+constexpr auto UTF16(T t)
     -> uint32_t
 {
     return static_cast<uint16_t>(t);
@@ -51,7 +55,7 @@ auto UTF16(T t)
 /** \brief Cast to UTF-8.
  */
 template <typename T>
-auto UTF8(T t)
+constexpr auto UTF8(T t)
     -> uint32_t
 {
     return static_cast<uint8_t>(t);
@@ -64,6 +68,38 @@ extern const std::array<uint8_t, 7> FIRST_BYTE_MARK;
 extern const std::array<uint8_t, 256> UTF8_BYTES;
 extern const std::array<uint32_t, 6> UTF8_OFFSETS;
 
+/** \brief UTF-8 decoder states, as offsets into Utf8Dfa::TRANSITIONS.
+ */
+constexpr uint8_t UTF8_ACCEPT = 0;
+constexpr uint8_t UTF8_REJECT = 12;
+
+/** \brief Character classes and state transitions for the UTF-8
+ *  decoder, see http://bjoern.hoehrmann.de/utf-8/decoder/dfa/
+ *
+ *  Constant expressions, so utf8To32 also decodes literals at compile
+ *  time.
+ */
+struct Utf8Dfa
+{
+    static constexpr std::array<uint8_t, 256> CLASSES = {{
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+        1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+        7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7, 7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+        8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2, 2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+        10,3,3,3,3,3,3,3,3,3,3,3,3,4,3,3, 11,6,6,6,5,8,8,8,8,8,8,8,8,8,8,8
+    }};
+    static constexpr std::array<uint8_t, 108> TRANSITIONS = {{
+        0,12,24,36,60,96,84,12,12,12,48,72, 12,12,12,12,12,12,12,12,12,12,12,12,
+        12,0,12,12,12,12,12,0,12,0,12,12, 12,24,12,12,12,12,12,24,12,24,12,12,
+        12,12,12,12,12,12,12,24,12,12,12,12, 12,24,12,12,12,12,12,12,12,24,12,12,
+        12,12,12,12,12,12,12,36,12,36,12,12, 12,36,12,12,12,12,12,36,12,36,12,12,
+        12,36,12,12,12,12,12,12,12,12,12,12
+    }};
+};
+
 // EXCEPTIONS
 // ----------
 
@@ -91,7 +127,14 @@ struct BufferRangeError: public std::exception
 
 /** \brief Replace illegal Unicode character if checkStrict is off.
  */
-uint32_t checkStrict(bool strict);
+constexpr uint32_t checkStrict(bool strict)
+{
+    constexpr uint32_t replacement = 0x0000FFFD;
+    if (strict) {
+        throw IllegalCharacterError();
+    }
+    return replacement;
+}
 
 
 // CHARACTERS
@@ -102,7 +145,7 @@ uint32_t checkStrict(bool strict);
 /** \brief Convert UTF-32 character to UTF-16.
  */
 template <typename Iter16>
-void utf32To16(uint32_t c,
+constexpr void utf32To16(uint32_t c,
     Iter16 &begin,
     Iter16 &end,
     bool strict)
@@ -111,6 +154,7 @@ void utf32To16(uint32_t c,
     constexpr uint32_t maxUtf32 = 0x0010FFFF;
     constexpr uint32_t highBegin = 0xD800;
     constexpr uint32_t lowBegin = 0xDC00;
+    constexpr uint32_t lowEnd = 0xDFFF;
     constexpr uint32_t maxbmp = 0x0000FFFF;
     constexpr int shift = 10;
     constexpr uint32_t base = 0x0010000UL;
@@ -118,7 +162,7 @@ void utf32To16(uint32_t c,
 
     // variables
     if (c <= maxbmp) {
-        if (c >= highBegin && c <= lowBegin) {
+        if (c >= highBegin && c <= lowEnd) {
             *begin++ = checkStrict(strict);
         } else {
             *begin++ = UTF16(c);
@@ -126,7 +170,7 @@ void utf32To16(uint32_t c,
     } else if (c > maxUtf32) {
         *begin++ = checkStrict(strict);
     } else {
-        if (begin + 1 > end) {
+        if (begin + 2 > end) {
             throw BufferRangeError();
         }
 
@@ -208,9 +252,13 @@ uint32_t utf16To32(Iter16 &begin,
 
     const uint32_t c1 = *begin++;
     if (c1 >= highBegin && c1 <= highEnd) {
-        // surrogate pairs
-        const uint32_t c2 = *begin++;
+        // surrogate pairs, leave an unpaired unit for the next character
+        if (begin == end) {
+            return checkStrict(strict);
+        }
+        const uint32_t c2 = *begin;
         if (c2 >= lowBegin && c2 <= lowEnd) {
+            ++begin;
             return ((c1 - highBegin) << shift) + (c2 - lowBegin) + base;
         } else {
             return checkStrict(strict);
@@ -224,44 +272,151 @@ uint32_t utf16To32(Iter16 &begin,
 
 
 /** \brief Convert UTF-8 character to UTF-32.
+ *
+ *  Validates and decodes the sequence with a DFA (after Bjoern
+ *  Hoehrmann's decoder), which rejects overlong forms, surrogates and
+ *  code points above U+10FFFF. Malformed sequences are replaced by
+ *  a single U+FFFD up to the first invalid byte, which is left for the
+ *  next character.
  */
 template <typename Iter8>
-uint32_t utf8To32(Iter8 &begin,
+constexpr uint32_t utf8To32(Iter8 &begin,
     Iter8 end,
     bool strict)
 {
+    const auto first = begin;
     uint32_t c = 0;
-    uint8_t bytes = UTF8_BYTES[*begin];
+    uint8_t state = UTF8_ACCEPT;
+    do {
+        const uint8_t byte = UTF8(*begin);
+        const uint8_t type = Utf8Dfa::CLASSES[byte];
+        c = state == UTF8_ACCEPT ? (0xFF >> type) & byte : (byte & 0x3F) | (c << 6);
+        state = Utf8Dfa::TRANSITIONS[state + type];
+        if (state == UTF8_REJECT) {
+            if (begin == first) {
+                ++begin;
+            }
+            return checkStrict(strict);
+        }
+        ++begin;
+    } while (state != UTF8_ACCEPT && begin < end);
 
-    // check range
-    if (begin + bytes >= end) {
-        // sourc ebuffer, check whether or not we have space to replace
-        throw IllegalCharacterError();
+    if (state != UTF8_ACCEPT) {
+        // truncated sequence
+        return checkStrict(strict);
     }
 
-    // get our UTF-32 character
-    switch (bytes) {
-        case 5:
-            c = checkStrict(strict);
-            c <<= 6;
-        case 4:
-            c = checkStrict(strict);
-            c <<= 6;
-        case 3:
-            c += *begin++;
-            c <<= 6;
-        case 2:
-            c += *begin++;
-            c <<= 6;
-        case 1:
-            c += *begin++;
-            c <<= 6;
-        case 0:
-            c += *begin++;
+    return c;
+}
+
+
+// TO UTF16
+
+/** \brief Convert UTF-8 character directly to UTF-16.
+ *
+ *  The decoder only accepts Unicode scalar values, so code points are
+ *  written as-is or split into a surrogate pair without re-validation.
+ */
+template <typename Iter8, typename Iter16>
+void utf8To16Char(Iter8 &src,
+    Iter8 srcEnd,
+    Iter16 &dst,
+    Iter16 dstEnd,
+    bool strict)
+{
+    uint32_t c = UTF8(*src);
+    if (c < 0x80) {
+        ++src;
+        *dst++ = UTF16(c);
+        return;
     }
-    c -= UTF8_OFFSETS[bytes];
 
-    return c;
+    c = utf8To32(src, srcEnd, strict);
+    if (c <= 0xFFFF) {
+        *dst++ = UTF16(c);
+    } else {
+        if (dst + 2 > dstEnd) {
+            throw BufferRangeError();
+        }
+        c -= 0x10000;
+        *dst++ = UTF16(0xD800 + (c >> 10));
+        *dst++ = UTF16(0xDC00 + (c & 0x3FF));
+    }
+}
+
+
+// TO UTF8
+
+/** \brief Convert UTF-16 character directly to UTF-8.
+ */
+template <typename Iter16, typename Iter8>
+void utf16To8Char(Iter16 &src,
+    Iter16 srcEnd,
+    Iter8 &dst,
+    Iter8 dstEnd,
+    bool strict)
+{
+    uint32_t c = UTF16(*src++);
+    if (c < 0x80) {
+        *dst++ = UTF8(c);
+        return;
+    } else if (c < 0x800) {
+        if (dst + 2 > dstEnd) {
+            throw BufferRangeError();
+        }
+        *dst++ = UTF8(0xC0 | (c >> 6));
+        *dst++ = UTF8(0x80 | (c & 0x3F));
+        return;
+    } else if (c >= 0xD800 && c <= 0xDFFF) {
+        const bool paired = c <= 0xDBFF && src < srcEnd && (UTF16(*src) & 0xFC00) == 0xDC00;
+        if (paired) {
+            if (dst + 4 > dstEnd) {
+                throw BufferRangeError();
+            }
+            c = ((c - 0xD800) << 10) + (UTF16(*src++) - 0xDC00) + 0x10000;
+            *dst++ = UTF8(0xF0 | (c >> 18));
+            *dst++ = UTF8(0x80 | ((c >> 12) & 0x3F));
+            *dst++ = UTF8(0x80 | ((c >> 6) & 0x3F));
+            *dst++ = UTF8(0x80 | (c & 0x3F));
+            return;
+        }
+        c = checkStrict(strict);
+    }
+
+    if (dst + 3 > dstEnd) {
+        throw BufferRangeError();
+    }
+    *dst++ = UTF8(0xE0 | (c >> 12));
+    *dst++ = UTF8(0x80 | ((c >> 6) & 0x3F));
+    *dst++ = UTF8(0x80 | (c & 0x3F));
+}
+
+
+// LENGTHS
+
+/** \brief Get number of UTF-16 code units written by utf32To16.
+ */
+inline size_t utf32To16Length(uint32_t c)
+{
+    return (c > 0x0000FFFF && c <= 0x0010FFFF) ? 2 : 1;
+}
+
+
+/** \brief Get number of UTF-8 code units written by utf32To8.
+ */
+inline size_t utf32To8Length(uint32_t c)
+{
+    if (c < 0x80) {
+        return 1;
+    } else if (c < 0x800) {
+        return 2;
+    } else if (c < 0x10000) {
+        return 3;
+    } else if (c <= 0x0010FFFF) {
+        return 4;
+    }
+
+    return 3;
 }
 
 
@@ -325,7 +480,7 @@ size_t utf16To8(Iter16 srcBegin,
     auto src = srcBegin;
     auto dst = dstBegin;
     while (src < srcEnd && dst < dstEnd) {
-        utf32To8(utf16To32(src, srcEnd, strict), dst, dstEnd, strict);
+        utf16To8Char(src, srcEnd, dst, dstEnd, strict);
     }
 
     return dst - dstBegin;
@@ -346,13 +501,85 @@ size_t utf8To16(Iter8 srcBegin,
     auto src = srcBegin;
     auto dst = dstBegin;
     while (src < srcEnd && dst < dstEnd) {
-        utf32To16(utf8To32(src, srcEnd, strict), dst, dstEnd, strict);
+        utf8To16Char(src, srcEnd, dst, dstEnd, strict);
     }
 
     return dst - dstBegin;
 }
 
 
+/** \brief Get exact number of code units utf8To16 writes for src.
+ */
+template <typename Iter8>
+size_t utf8To16Length(Iter8 srcBegin,
+    Iter8 srcEnd,
+    bool strict = true)
+{
+    size_t length = 0;
+    auto src = srcBegin;
+    while (src < srcEnd) {
+        length += utf32To16Length(utf8To32(src, srcEnd, strict));
+    }
+
+    return length;
+}
+
+
+/** \brief Get exact number of code units utf16To8 writes for src.
+ */
+template <typename Iter16>
+size_t utf16To8Length(Iter16 srcBegin,
+    Iter16 srcEnd,
+    bool strict = true)
+{
+    size_t length = 0;
+    auto src = srcBegin;
+    while (src < srcEnd) {
+        length += utf32To8Length(utf16To32(src, srcEnd, strict));
+    }
+
+    return length;
+}
+
+
+/** \brief Get exact number of code points utf8To32 writes for src.
+ */
+template <typename Iter8>
+size_t utf8To32Length(Iter8 srcBegin,
+    Iter8 srcEnd,
+    bool strict = true)
+{
+    size_t length = 0;
+    auto src = srcBegin;
+    while (src < srcEnd) {
+        utf8To32(src, srcEnd, strict);
+        ++length;
+    }
+
+    return length;
+}
+
+
+/** \brief Get exact number of code units utf32To8 writes for src.
+ */
+template <typename Iter32>
+size_t utf32To8Length(Iter32 srcBegin,
+    Iter32 srcEnd,
+    bool strict = true)
+{
+    size_t length = 0;
+    for (auto src = srcBegin; src < srcEnd; ++src) {
+        const uint32_t c = UTF32(*src);
+        if (c > 0x0010FFFF) {
+            checkStrict(strict);
+        }
+        length += utf32To8Length(c);
+    }
+
+    return length;
+}
+
+
 /** \brief Convert UTF32 to UTF8.
  *
  *  \return     Number of bytes written to dst.
@@ -396,6 +623,79 @@ size_t utf8To32(Iter8 srcBegin,
 
 }   /* detail */
 
+// CONVERTERS
+// ----------
+
+
+/** \brief Compile-time dispatched array converter from C1 to C2.
+ *
+ *  Each specialization provides `convert`, with the same signature as
+ *  the array converters, and `RATIO`, the maximum number of C2 code
+ *  units written for a single C1 code unit.
+ */
+template <typename C1, typename C2>
+struct Converter;
+
+
+/** \brief Specialize Converter for an encoding pair.
+ */
+#define AUTOCOM_CONVERTER(C1, C2, function, ratio)                      \
+    template <>                                                         \
+    struct Converter<C1, C2>                                            \
+    {                                                                   \
+        static constexpr size_t RATIO = ratio;                          \
+                                                                        \
+        static size_t convert(const C1 *srcBegin,                       \
+            const C1 *srcEnd,                                           \
+            C2 *dstBegin,                                               \
+            C2 *dstEnd,                                                 \
+            bool strict = true)                                         \
+        {                                                               \
+            return function(srcBegin, srcEnd, dstBegin, dstEnd, strict);\
+        }                                                               \
+    }
+
+AUTOCOM_CONVERTER(uint8_t, uint16_t, simd::utf8To16, 1);
+AUTOCOM_CONVERTER(uint8_t, uint32_t, detail::utf8To32, 1);
+AUTOCOM_CONVERTER(uint16_t, uint8_t, simd::utf16To8, 3);
+AUTOCOM_CONVERTER(uint16_t, uint32_t, detail::utf16To32, 1);
+AUTOCOM_CONVERTER(uint32_t, uint8_t, detail::utf32To8, 4);
+AUTOCOM_CONVERTER(uint32_t, uint16_t, detail::utf32To16, 2);
+
+#undef AUTOCOM_CONVERTER
+
+
+/** \brief Convert a string of C1 code units to C2 code units.
+ *
+ *  Short inputs, such as identifiers, are transcoded on the stack and
+ *  copied into an exactly-sized result, which usually fits the small
+ *  string buffer. Longer inputs are transcoded directly into a
+ *  worst-case sized result, which is then shrunk.
+ */
+template <typename C1, typename C2>
+std::string convert(const std::string &string)
+{
+    typedef Converter<C1, C2> converter;
+    constexpr size_t stack = 64;
+
+    const size_t srclen = string.size() / sizeof(C1);
+    const size_t dstlen = srclen * converter::RATIO;
+    auto *src = reinterpret_cast<const C1*>(string.data());
+
+    if (dstlen <= stack) {
+        C2 buffer[stack];
+        size_t out = converter::convert(src, src + srclen, buffer, buffer + dstlen, true);
+        return std::string(reinterpret_cast<const char*>(buffer), out * sizeof(C2));
+    }
+
+    std::string output(dstlen * sizeof(C2), '\0');
+    auto *dst = reinterpret_cast<C2*>(&output[0]);
+    size_t out = converter::convert(src, src + srclen, dst, dst + dstlen, true);
+    output.resize(out * sizeof(C2));
+
+    return output;
+}
+
 // FUNCTIONS
 // ---------
 
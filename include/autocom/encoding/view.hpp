@@ -0,0 +1,478 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/**
+ *  \addtogroup AutoCOM
+ *  \brief Lazy transcoding views over UTF-8, UTF-16 and UTF-32 ranges.
+ *
+ *  Decodes one character at a time while iterating, so a range can be
+ *  searched, hashed or streamed in another encoding without converting
+ *  a full copy first. The source encoding is deduced from the size of
+ *  the range's code units.
+ *
+ *  \code
+ *      for (char32_t c: utf::view<char32_t>(bstr)) {}
+ *      std::string narrow(utf::as_utf8(bstr).begin(), utf::as_utf8(bstr).end());
+ *  \endcode
+ *
+ *  \warning Views do not own their range, which must outlive them.
+ */
+
+#pragma once
+
+#include "unicode.hpp"
+
+#include <iterator>
+#include <type_traits>
+
+
+namespace autocom
+{
+namespace utf
+{
+namespace detail
+{
+// DECODERS
+// --------
+
+
+/** \brief Decode a character from code units of a given size.
+ */
+template <size_t Size>
+struct Decoder;
+
+
+template <>
+struct Decoder<1>
+{
+    template <typename Iter>
+    static uint32_t decode(Iter &begin,
+        Iter end,
+        bool strict)
+    {
+        return utf8To32(begin, end, strict);
+    }
+};
+
+
+template <>
+struct Decoder<2>
+{
+    template <typename Iter>
+    static uint32_t decode(Iter &begin,
+        Iter end,
+        bool strict)
+    {
+        return utf16To32(begin, end, strict);
+    }
+};
+
+
+template <>
+struct Decoder<4>
+{
+    template <typename Iter>
+    static uint32_t decode(Iter &begin,
+        Iter end,
+        bool strict)
+    {
+        const uint32_t c = UTF32(*begin++);
+        if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+            return checkStrict(strict);
+        }
+        return c;
+    }
+};
+
+}   /* detail */
+
+// ITERATORS
+// ---------
+
+
+/** \brief Forward iterator decoding code points from a code unit range.
+ */
+template <typename Iter>
+class CodePointIterator
+{
+protected:
+    typedef typename std::iterator_traits<Iter>::value_type unit_type;
+    typedef detail::Decoder<sizeof(unit_type)> decoder;
+
+    Iter current;
+    Iter next;
+    Iter last;
+    char32_t value = 0;
+    bool strict = true;
+
+    void decode();
+
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef char32_t value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const char32_t* pointer;
+    typedef const char32_t& reference;
+
+    CodePointIterator() = default;
+    CodePointIterator(Iter first,
+        Iter last,
+        const bool strict = true);
+
+    reference operator*() const;
+    CodePointIterator & operator++();
+    CodePointIterator operator++(int);
+
+    Iter base() const;
+
+    bool operator==(const CodePointIterator &other) const;
+    bool operator!=(const CodePointIterator &other) const;
+};
+
+
+/** \brief Forward iterator encoding code points as UTF-8 or UTF-16.
+ *
+ *  `Char` is the output code unit, and the units for a code point are
+ *  buffered so each character is only decoded once.
+ */
+template <typename Char, typename Iter>
+class EncodingIterator
+{
+protected:
+    CodePointIterator<Iter> source;
+    CodePointIterator<Iter> last;
+    Char units[4];
+    uint8_t index = 0;
+    uint8_t size = 0;
+
+    void encode();
+
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Char value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Char* pointer;
+    typedef const Char& reference;
+
+    EncodingIterator() = default;
+    EncodingIterator(Iter first,
+        Iter last,
+        const bool strict = true);
+
+    reference operator*() const;
+    EncodingIterator & operator++();
+    EncodingIterator operator++(int);
+
+    bool operator==(const EncodingIterator &other) const;
+    bool operator!=(const EncodingIterator &other) const;
+};
+
+// RANGES
+// ------
+
+
+/** \brief Select the iterator which yields `Char` code units.
+ */
+template <typename Char, typename Iter>
+struct ViewIterator
+{
+    typedef typename std::conditional<sizeof(Char) == 4,
+        CodePointIterator<Iter>,
+        EncodingIterator<Char, Iter>
+    >::type type;
+};
+
+
+/** \brief Non-owning range of lazily transcoded code units.
+ */
+template <typename Iterator>
+class View
+{
+protected:
+    Iterator first;
+    Iterator last;
+
+public:
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+    typedef typename std::iterator_traits<Iterator>::value_type value_type;
+
+    View(Iterator first,
+        Iterator last);
+
+    iterator begin() const;
+    iterator end() const;
+    bool empty() const;
+};
+
+// FUNCTIONS
+// ---------
+
+
+/** \brief View range of code units as `Char` code units.
+ *
+ *  `Char` may be `char32_t` for code points, `char`/`uint8_t` for
+ *  UTF-8, or `char16_t`/`wchar_t` for UTF-16.
+ */
+template <typename Char, typename Range>
+auto view(const Range &range,
+    const bool strict = true)
+    -> View<typename ViewIterator<Char, decltype(std::begin(range))>::type>
+{
+    typedef typename ViewIterator<Char, decltype(std::begin(range))>::type iterator;
+    return {iterator(std::begin(range), std::end(range), strict), iterator(std::end(range), std::end(range), strict)};
+}
+
+
+/** \brief View range as UTF-8 code units.
+ */
+template <typename Range>
+auto as_utf8(const Range &range,
+    const bool strict = true)
+    -> decltype(view<char>(range, strict))
+{
+    return view<char>(range, strict);
+}
+
+
+/** \brief View range as UTF-16 code units.
+ */
+template <typename Range>
+auto as_utf16(const Range &range,
+    const bool strict = true)
+    -> decltype(view<char16_t>(range, strict))
+{
+    return view<char16_t>(range, strict);
+}
+
+
+/** \brief View range as Unicode code points.
+ */
+template <typename Range>
+auto as_utf32(const Range &range,
+    const bool strict = true)
+    -> decltype(view<char32_t>(range, strict))
+{
+    return view<char32_t>(range, strict);
+}
+
+// IMPLEMENTATION
+// --------------
+
+
+/** \brief Decode the code point at the current position.
+ */
+template <typename Iter>
+void CodePointIterator<Iter>::decode()
+{
+    next = current;
+    if (current != last) {
+        value = static_cast<char32_t>(decoder::decode(next, last, strict));
+    }
+}
+
+
+/** \brief Initialize iterator at first, decoding the first code point.
+ */
+template <typename Iter>
+CodePointIterator<Iter>::CodePointIterator(Iter first,
+        Iter last,
+        const bool strict):
+    current(first),
+    next(first),
+    last(last),
+    strict(strict)
+{
+    decode();
+}
+
+
+/** \brief Get current code point.
+ */
+template <typename Iter>
+auto CodePointIterator<Iter>::operator*() const
+    -> reference
+{
+    return value;
+}
+
+
+/** \brief Advance to the next code point.
+ */
+template <typename Iter>
+auto CodePointIterator<Iter>::operator++()
+    -> CodePointIterator&
+{
+    current = next;
+    decode();
+    return *this;
+}
+
+
+/** \brief Advance to the next code point.
+ */
+template <typename Iter>
+auto CodePointIterator<Iter>::operator++(int)
+    -> CodePointIterator
+{
+    CodePointIterator copy(*this);
+    operator++();
+    return copy;
+}
+
+
+/** \brief Get iterator to the first code unit of the current code point.
+ */
+template <typename Iter>
+Iter CodePointIterator<Iter>::base() const
+{
+    return current;
+}
+
+
+/** \brief Equality operator.
+ */
+template <typename Iter>
+bool CodePointIterator<Iter>::operator==(const CodePointIterator &other) const
+{
+    return current == other.current;
+}
+
+
+/** \brief Inequality operator.
+ */
+template <typename Iter>
+bool CodePointIterator<Iter>::operator!=(const CodePointIterator &other) const
+{
+    return !operator==(other);
+}
+
+
+/** \brief Encode the current code point into the unit buffer.
+ */
+template <typename Char, typename Iter>
+void EncodingIterator<Char, Iter>::encode()
+{
+    index = 0;
+    size = 0;
+    if (source != last) {
+        const uint32_t c = *source;
+        auto *begin = units;
+        auto *end = units + 4;
+        if (sizeof(Char) == 1) {
+            detail::utf32To8(c, begin, end, false);
+        } else {
+            detail::utf32To16(c, begin, end, false);
+        }
+        size = static_cast<uint8_t>(begin - units);
+    }
+}
+
+
+/** \brief Initialize iterator at first, encoding the first code point.
+ */
+template <typename Char, typename Iter>
+EncodingIterator<Char, Iter>::EncodingIterator(Iter first,
+        Iter last,
+        const bool strict):
+    source(first, last, strict),
+    last(last, last, strict)
+{
+    encode();
+}
+
+
+/** \brief Get current code unit.
+ */
+template <typename Char, typename Iter>
+auto EncodingIterator<Char, Iter>::operator*() const
+    -> reference
+{
+    return units[index];
+}
+
+
+/** \brief Advance to the next code unit.
+ */
+template <typename Char, typename Iter>
+auto EncodingIterator<Char, Iter>::operator++()
+    -> EncodingIterator&
+{
+    if (++index == size) {
+        ++source;
+        encode();
+    }
+    return *this;
+}
+
+
+/** \brief Advance to the next code unit.
+ */
+template <typename Char, typename Iter>
+auto EncodingIterator<Char, Iter>::operator++(int)
+    -> EncodingIterator
+{
+    EncodingIterator copy(*this);
+    operator++();
+    return copy;
+}
+
+
+/** \brief Equality operator.
+ */
+template <typename Char, typename Iter>
+bool EncodingIterator<Char, Iter>::operator==(const EncodingIterator &other) const
+{
+    return source == other.source && index == other.index;
+}
+
+
+/** \brief Inequality operator.
+ */
+template <typename Char, typename Iter>
+bool EncodingIterator<Char, Iter>::operator!=(const EncodingIterator &other) const
+{
+    return !operator==(other);
+}
+
+
+/** \brief Initialize view from iterator pair.
+ */
+template <typename Iterator>
+View<Iterator>::View(Iterator first,
+        Iterator last):
+    first(first),
+    last(last)
+{}
+
+
+/** \brief Get iterator to first code unit.
+ */
+template <typename Iterator>
+auto View<Iterator>::begin() const
+    -> iterator
+{
+    return first;
+}
+
+
+/** \brief Get iterator past the last code unit.
+ */
+template <typename Iterator>
+auto View<Iterator>::end() const
+    -> iterator
+{
+    return last;
+}
+
+
+/** \brief Check if view is empty.
+ */
+template <typename Iterator>
+bool View<Iterator>::empty() const
+{
+    return first == last;
+}
+
+
+}   /* utf */
+}   /* autocom */
@@ -8,7 +8,7 @@
 #pragma once
 
 #include "iterator.hpp"
-#include "util/shared_ptr.hpp"
+#include "util/com_ptr.hpp"
 
 #include <oaidl.h>
 
@@ -31,7 +31,7 @@ IEnumVARIANT * newEnumVariant(IDispatch *dispatch);
 class EnumVariant
 {
 protected:
-    SharedPointer<IEnumVARIANT> ppv;
+    ComPtr<IEnumVARIANT> ppv;
 
     friend bool operator==(const EnumVariant &left,
         const EnumVariant &right);
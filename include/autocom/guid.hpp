@@ -25,7 +25,7 @@ protected:
 
     friend class Dispatch;
 
-    void open(const Bstr &string);
+    void open(const BstrView &string);
 
 public:
     Guid() = default;
@@ -36,6 +36,7 @@ public:
 
     Guid(const GUID &guid);
     Guid(const Bstr &string);
+    Guid(const BstrView &string);
     Guid(const char *cstring);
     Guid(const char *array,
         const size_t length);
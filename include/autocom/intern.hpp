@@ -0,0 +1,51 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoCOM
+ *  \brief Interned BSTRs for method and property names.
+ *
+ *  A process-wide, thread-safe table of immortal BSTRs, keyed by their
+ *  UTF-16 content. Repeated lookups of the same name share one string,
+ *  and allocate nothing once the name is interned.
+ */
+
+#pragma once
+
+#include "bstr.hpp"
+
+#include <string>
+
+
+namespace autocom
+{
+// FUNCTIONS
+// ---------
+
+/** \brief Get interned BSTR for a wide name.
+ *
+ *  \warning The result is shared and lives until the process exits:
+ *  never free or modify it.
+ */
+BSTR INTERN_BSTR(const BstrView &name);
+
+/** \brief Get interned BSTR for a UTF-8 name.
+ *
+ *  The name is transcoded in a thread-local buffer, so lookups of
+ *  interned names do not allocate.
+ */
+BSTR INTERN_BSTR(const char *name,
+    const size_t length);
+
+/** \brief Get interned BSTR for a UTF-8 C-string.
+ */
+BSTR INTERN_BSTR(const char *name);
+
+/** \brief Get interned BSTR for a UTF-8 string.
+ */
+BSTR INTERN_BSTR(const std::string &name);
+
+/** \brief Get number of interned BSTRs.
+ */
+size_t internedBstrs();
+
+}   /* autocom */
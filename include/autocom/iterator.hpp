@@ -26,7 +26,7 @@ class Iterator: public std::iterator<
     >
 {
 protected:
-    itl::weak_ptr<IEnumVARIANT> ppv;
+    ComPtr<IEnumVARIANT> ppv;
     DispatchBase dispatch;
 
 public:
@@ -36,7 +36,7 @@ public:
     Iterator(Iterator&&) = default;
     Iterator & operator=(Iterator&&) = default;
 
-    Iterator(itl::weak_ptr<IEnumVARIANT> ppv);
+    Iterator(const ComPtr<IEnumVARIANT> &ppv);
 
     DispatchBase & operator*();
     const DispatchBase & operator*() const;
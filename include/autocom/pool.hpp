@@ -0,0 +1,92 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoCOM
+ *  \brief Pooled BSTR allocation.
+ *
+ *  An optional backend which caches freed BSTRs in per-thread,
+ *  size-class freelists, and reuses them for later allocations, so
+ *  short-lived strings avoid a round-trip to the system allocator.
+ *
+ *  Handoff rule: pooled strings are ordinary SysAllocStringLen blocks,
+ *  and the pool only ever shortens the length prefix of a cached block,
+ *  so SysStringLen stays valid and ownership may pass to COM at any
+ *  time. COM may free them with SysFreeString, and any BSTR may be
+ *  freed with FREE_BSTR, including strings received from COM.
+ */
+
+#pragma once
+
+#include <wtypes.h>
+
+#include <cstddef>
+
+
+namespace autocom
+{
+// OBJECTS
+// -------
+
+
+/** \brief Allocation counters for the BSTR pool.
+ *
+ *  A hit reuses a cached string, and a miss falls back to
+ *  SysAllocStringLen while the pool is enabled.
+ */
+struct BstrPoolCounters
+{
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+// FUNCTIONS
+// ---------
+
+/** \brief Check if the BSTR pool is enabled.
+ */
+bool bstrPool();
+
+/** \brief Enable or disable the BSTR pool, process-wide.
+ *
+ *  The pool is opt-in, and disabled by default. Disabling it frees the
+ *  strings cached by the calling thread.
+ */
+void setBstrPool(const bool enabled);
+
+/** \brief Get pool counters, summed over all threads.
+ */
+BstrPoolCounters bstrPoolCounters();
+
+/** \brief Reset pool counters to zero.
+ */
+void resetBstrPoolCounters();
+
+/** \brief Free all strings cached by the calling thread.
+ */
+void trimBstrPool();
+
+/** \brief Allocate BSTR, from the pool if enabled.
+ *
+ *  Drop-in replacement for SysAllocStringLen: copies `length`
+ *  characters from string, if not null, and null-terminates the result.
+ */
+BSTR ALLOC_BSTR(const wchar_t *string,
+    const size_t length);
+
+/** \brief Shorten BSTR in place, by rewriting its length prefix.
+ *
+ *  The allocation keeps its size, so the string stays valid for
+ *  SysStringLen, SysFreeString and FREE_BSTR.
+ *
+ *  \warning `length` must not exceed the current length.
+ */
+void TRUNCATE_BSTR(BSTR bstr,
+    const size_t length);
+
+/** \brief Free BSTR, caching it in the pool if enabled.
+ *
+ *  Drop-in replacement for SysFreeString.
+ */
+void FREE_BSTR(BSTR bstr);
+
+}   /* autocom */
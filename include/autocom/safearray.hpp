@@ -12,6 +12,9 @@
 
 #include <oaidl.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
 #include <vector>
 
 
@@ -59,10 +62,165 @@ struct SafeArrayBound: SAFEARRAYBOUND
 };
 
 
+/** \brief Shape of a locked SAFEARRAY, computed once.
+ *
+ *  Dimensions are in index order, as passed to SafeArrayPtrOfIndex,
+ *  which is the reverse of SAFEARRAY::rgsabound. The first index
+ *  varies fastest, so strides are column-major, in elements.
+ *  Arrays with more than `MAX_RANK` dimensions only cache the base
+ *  pointer and element count.
+ */
+struct SafeArrayLayout
+{
+    static constexpr USHORT MAX_RANK = 4;
+
+    void *base = nullptr;
+    size_t count = 0;
+    USHORT rank = 0;
+    LONG lower[MAX_RANK] = {};
+    ULONG extent[MAX_RANK] = {};
+    size_t stride[MAX_RANK] = {};
+
+    void reset(const SAFEARRAY *array);
+    bool cached() const;
+};
+
+
+/** \brief Random-access iterator over elements a fixed stride apart.
+ */
+template <typename T>
+class StridedIterator
+{
+protected:
+    T *ptr = nullptr;
+    std::ptrdiff_t step = 1;
+
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename std::remove_const<T>::type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+
+    StridedIterator() = default;
+    StridedIterator(T *ptr,
+        const std::ptrdiff_t step);
+
+    reference operator*() const;
+    pointer operator->() const;
+    reference operator[](const difference_type n) const;
+
+    StridedIterator & operator++();
+    StridedIterator operator++(int);
+    StridedIterator & operator--();
+    StridedIterator operator--(int);
+    StridedIterator & operator+=(const difference_type n);
+    StridedIterator & operator-=(const difference_type n);
+    StridedIterator operator+(const difference_type n) const;
+    StridedIterator operator-(const difference_type n) const;
+    difference_type operator-(const StridedIterator &other) const;
+
+    bool operator==(const StridedIterator &other) const;
+    bool operator!=(const StridedIterator &other) const;
+    bool operator<(const StridedIterator &other) const;
+    bool operator>(const StridedIterator &other) const;
+    bool operator<=(const StridedIterator &other) const;
+    bool operator>=(const StridedIterator &other) const;
+};
+
+
+template <typename T>
+StridedIterator<T> operator+(const typename StridedIterator<T>::difference_type n,
+    const StridedIterator<T> &it);
+
+
+/** \brief Zero-copy view over a locked SAFEARRAY with `Rank` dimensions.
+ *
+ *  Dimensions are in index order, with the array's own lower bounds,
+ *  so `view(i, j)` addresses the same element as the index array
+ *  `{i, j}`. SAFEARRAYs are column-major: the first index varies
+ *  fastest, so for `[rows][columns]` data each column is contiguous
+ *  and each row is strided. Views do not own the array, and are only
+ *  valid while the SafeArray they came from is unchanged.
+ */
+template <typename T, USHORT Rank>
+class SafeArrayView
+{
+protected:
+    typedef SafeArrayView<T, Rank> This;
+
+    T *origin = nullptr;
+    LONG lowers[Rank] = {};
+    ULONG extents[Rank] = {};
+    size_t strides[Rank] = {};
+
+    template <typename U, USHORT R>
+    friend class SafeArrayView;
+
+    void checkDimension(const USHORT dimension) const;
+    size_t offset(const LONG *indices) const;
+
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef T& reference;
+    typedef StridedIterator<T> iterator;
+
+    SafeArrayView() = default;
+    SafeArrayView(T *origin,
+        const LONG *lower,
+        const ULONG *extent,
+        const size_t *stride);
+
+    template <
+        typename U,
+        typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type
+    >
+    SafeArrayView(const SafeArrayView<U, Rank> &other);
+
+    // LAYOUT
+    static constexpr USHORT rank();
+    size_t size() const;
+    bool empty() const;
+    bool contiguous() const;
+    size_t extent(const USHORT dimension) const;
+    LONG lower(const USHORT dimension) const;
+    size_t stride(const USHORT dimension) const;
+
+    // ELEMENT ACCESS
+    template <typename... Ts>
+    reference operator()(const Ts... indices) const;
+
+    template <typename... Ts>
+    reference at(const Ts... indices) const;
+
+    pointer data() const;
+
+    // ITERATORS
+    iterator begin() const;
+    iterator end() const;
+
+    // SLICING
+    SafeArrayView<T, Rank-1> slice(const USHORT dimension,
+        const LONG index) const;
+    This subview(const USHORT dimension,
+        const LONG first,
+        const size_t count) const;
+    SafeArrayView<T, Rank-1> row(const LONG index) const;
+    SafeArrayView<T, Rank-1> column(const LONG index) const;
+    This transpose() const;
+
+    // CONVERSIONS
+    template <typename U>
+    void copyRowMajor(U *out) const;
+};
+
+
 /** \brief C++ wrapper around SAFEARRAY.
  *
  *  Provides an STL-like interface with automatic std::vector
- *  conversions.
+ *  conversions. The array stays locked while owned, so the layout
+ *  is cached on lock, and element access is pointer arithmetic.
  */
 template <typename T>
 class SafeArray
@@ -71,6 +229,8 @@ protected:
     typedef SafeArray<T> This;
     typedef LPSAFEARRAY* LPLPSAFEARRAY;
 
+    SafeArrayLayout layout;
+
     void lock();
     void unlock();
     void checkNull() const;
@@ -126,6 +286,12 @@ public:
     size_t size(const LONG size = -1) const;
     bool empty() const;
 
+    // LAYOUT
+    USHORT dimensions() const;
+    size_t extent(const USHORT dimension) const;
+    LONG lower(const USHORT dimension) const;
+    size_t stride(const USHORT dimension) const;
+
     // ITERATORS
     iterator begin() noexcept;
     iterator end() noexcept;
@@ -176,12 +342,24 @@ public:
     typename std::enable_if<std::is_integral<U>::value, const_reference>::type
     at(const U index) const;
 
+    template <typename... Ts>
+    reference operator()(const Ts... indices);
+    template <typename... Ts>
+    const_reference operator()(const Ts... indices) const;
+
     reference front();
     const_reference front() const;
     reference back();
     const_reference back() const;
     const_pointer data() const;
 
+    // VIEWS
+    template <USHORT Rank>
+    SafeArrayView<T, Rank> view();
+
+    template <USHORT Rank>
+    SafeArrayView<const T, Rank> view() const;
+
     // MODIFIERS
     void resize(SafeArrayBound *bound);
     void resize(const LONG size);
@@ -203,6 +381,552 @@ static_assert(sizeof(SafeArrayBound) == sizeof(SAFEARRAYBOUND), "sizeof(SafeArra
 // --------------
 
 
+/** \brief Initialize from first element and distance between elements.
+ */
+template <typename T>
+StridedIterator<T>::StridedIterator(T *ptr,
+        const std::ptrdiff_t step):
+    ptr(ptr),
+    step(step)
+{}
+
+
+/** \brief Dereference iterator.
+ */
+template <typename T>
+T & StridedIterator<T>::operator*() const
+{
+    return *ptr;
+}
+
+
+/** \brief Dereference iterator.
+ */
+template <typename T>
+T * StridedIterator<T>::operator->() const
+{
+    return ptr;
+}
+
+
+/** \brief Get element `n` positions away.
+ */
+template <typename T>
+T & StridedIterator<T>::operator[](const difference_type n) const
+{
+    return ptr[n * step];
+}
+
+
+/** \brief Pre-increment iterator.
+ */
+template <typename T>
+auto StridedIterator<T>::operator++()
+    -> StridedIterator &
+{
+    ptr += step;
+    return *this;
+}
+
+
+/** \brief Post-increment iterator.
+ */
+template <typename T>
+auto StridedIterator<T>::operator++(int)
+    -> StridedIterator
+{
+    StridedIterator copy(*this);
+    ptr += step;
+    return copy;
+}
+
+
+/** \brief Pre-decrement iterator.
+ */
+template <typename T>
+auto StridedIterator<T>::operator--()
+    -> StridedIterator &
+{
+    ptr -= step;
+    return *this;
+}
+
+
+/** \brief Post-decrement iterator.
+ */
+template <typename T>
+auto StridedIterator<T>::operator--(int)
+    -> StridedIterator
+{
+    StridedIterator copy(*this);
+    ptr -= step;
+    return copy;
+}
+
+
+/** \brief Advance iterator by `n` positions.
+ */
+template <typename T>
+auto StridedIterator<T>::operator+=(const difference_type n)
+    -> StridedIterator &
+{
+    ptr += n * step;
+    return *this;
+}
+
+
+/** \brief Move iterator back by `n` positions.
+ */
+template <typename T>
+auto StridedIterator<T>::operator-=(const difference_type n)
+    -> StridedIterator &
+{
+    ptr -= n * step;
+    return *this;
+}
+
+
+/** \brief Get iterator `n` positions ahead.
+ */
+template <typename T>
+auto StridedIterator<T>::operator+(const difference_type n) const
+    -> StridedIterator
+{
+    return StridedIterator(ptr + n * step, step);
+}
+
+
+/** \brief Get iterator `n` positions back.
+ */
+template <typename T>
+auto StridedIterator<T>::operator-(const difference_type n) const
+    -> StridedIterator
+{
+    return StridedIterator(ptr - n * step, step);
+}
+
+
+/** \brief Get number of positions between iterators.
+ */
+template <typename T>
+auto StridedIterator<T>::operator-(const StridedIterator &other) const
+    -> difference_type
+{
+    return (ptr - other.ptr) / step;
+}
+
+
+/** \brief Equality operator.
+ */
+template <typename T>
+bool StridedIterator<T>::operator==(const StridedIterator &other) const
+{
+    return ptr == other.ptr;
+}
+
+
+/** \brief Inequality operator.
+ */
+template <typename T>
+bool StridedIterator<T>::operator!=(const StridedIterator &other) const
+{
+    return !operator==(other);
+}
+
+
+/** \brief Less than operator.
+ */
+template <typename T>
+bool StridedIterator<T>::operator<(const StridedIterator &other) const
+{
+    return *this - other < 0;
+}
+
+
+/** \brief Greater than operator.
+ */
+template <typename T>
+bool StridedIterator<T>::operator>(const StridedIterator &other) const
+{
+    return other < *this;
+}
+
+
+/** \brief Less than or equal to operator.
+ */
+template <typename T>
+bool StridedIterator<T>::operator<=(const StridedIterator &other) const
+{
+    return !(other < *this);
+}
+
+
+/** \brief Greater than or equal to operator.
+ */
+template <typename T>
+bool StridedIterator<T>::operator>=(const StridedIterator &other) const
+{
+    return !operator<(other);
+}
+
+
+/** \brief Get iterator `n` positions ahead of `it`.
+ */
+template <typename T>
+StridedIterator<T> operator+(const typename StridedIterator<T>::difference_type n,
+    const StridedIterator<T> &it)
+{
+    return it + n;
+}
+
+
+/** \brief Check dimension is within the view rank.
+ */
+template <typename T, USHORT Rank>
+void SafeArrayView<T, Rank>::checkDimension(const USHORT dimension) const
+{
+    if (dimension >= Rank) {
+        throw std::out_of_range("SafeArrayView:: Dimension requested is out of bounds");
+    }
+}
+
+
+/** \brief Get offset of element from the origin, without bounds checks.
+ */
+template <typename T, USHORT Rank>
+size_t SafeArrayView<T, Rank>::offset(const LONG *indices) const
+{
+    size_t offset = 0;
+    for (USHORT i = 0; i < Rank; ++i) {
+        offset += (indices[i] - lowers[i]) * strides[i];
+    }
+    return offset;
+}
+
+
+/** \brief Initialize from element at the lower bounds and layout,
+ *  in index order.
+ */
+template <typename T, USHORT Rank>
+SafeArrayView<T, Rank>::SafeArrayView(T *origin,
+        const LONG *lower,
+        const ULONG *extent,
+        const size_t *stride):
+    origin(origin)
+{
+    std::copy(lower, lower + Rank, lowers);
+    std::copy(extent, extent + Rank, extents);
+    std::copy(stride, stride + Rank, strides);
+}
+
+
+/** \brief Initialize from view of mutable elements.
+ */
+template <typename T, USHORT Rank>
+template <typename U, typename>
+SafeArrayView<T, Rank>::SafeArrayView(const SafeArrayView<U, Rank> &other):
+    SafeArrayView(other.origin, other.lowers, other.extents, other.strides)
+{}
+
+
+/** \brief Get number of dimensions.
+ */
+template <typename T, USHORT Rank>
+constexpr USHORT SafeArrayView<T, Rank>::rank()
+{
+    return Rank;
+}
+
+
+/** \brief Get number of elements in view.
+ */
+template <typename T, USHORT Rank>
+size_t SafeArrayView<T, Rank>::size() const
+{
+    size_t size = 1;
+    for (USHORT i = 0; i < Rank; ++i) {
+        size *= extents[i];
+    }
+    return size;
+}
+
+
+/** \brief Check if view has no elements.
+ */
+template <typename T, USHORT Rank>
+bool SafeArrayView<T, Rank>::empty() const
+{
+    return size() == 0;
+}
+
+
+/** \brief Check if elements are adjacent in memory, in index order.
+ */
+template <typename T, USHORT Rank>
+bool SafeArrayView<T, Rank>::contiguous() const
+{
+    size_t size = 1;
+    for (USHORT i = 0; i < Rank; ++i) {
+        if (extents[i] > 1 && strides[i] != size) {
+            return false;
+        }
+        size *= extents[i];
+    }
+    return true;
+}
+
+
+/** \brief Get number of elements along a dimension.
+ */
+template <typename T, USHORT Rank>
+size_t SafeArrayView<T, Rank>::extent(const USHORT dimension) const
+{
+    checkDimension(dimension);
+    return extents[dimension];
+}
+
+
+/** \brief Get lower bound of a dimension.
+ */
+template <typename T, USHORT Rank>
+LONG SafeArrayView<T, Rank>::lower(const USHORT dimension) const
+{
+    checkDimension(dimension);
+    return lowers[dimension];
+}
+
+
+/** \brief Get distance in elements between consecutive indexes of
+ *  a dimension.
+ */
+template <typename T, USHORT Rank>
+size_t SafeArrayView<T, Rank>::stride(const USHORT dimension) const
+{
+    checkDimension(dimension);
+    return strides[dimension];
+}
+
+
+/** \brief Get element at indexes, without bounds checks.
+ */
+template <typename T, USHORT Rank>
+template <typename... Ts>
+T & SafeArrayView<T, Rank>::operator()(const Ts... indices) const
+{
+    static_assert(sizeof...(Ts) == Rank, "Must provide one index per dimension");
+
+    const LONG list[] = {static_cast<LONG>(indices)...};
+    return origin[offset(list)];
+}
+
+
+/** \brief Get element at indexes.
+ *
+ *  \throw std::out_of_range    Index is outside the view bounds.
+ */
+template <typename T, USHORT Rank>
+template <typename... Ts>
+T & SafeArrayView<T, Rank>::at(const Ts... indices) const
+{
+    static_assert(sizeof...(Ts) == Rank, "Must provide one index per dimension");
+
+    const LONG list[] = {static_cast<LONG>(indices)...};
+    for (USHORT i = 0; i < Rank; ++i) {
+        const LONG index = list[i] - lowers[i];
+        if (index < 0 || static_cast<ULONG>(index) >= extents[i]) {
+            throw std::out_of_range("SafeArrayView:: Index is out of bounds");
+        }
+    }
+    return origin[offset(list)];
+}
+
+
+/** \brief Get pointer to element at the lower bounds.
+ */
+template <typename T, USHORT Rank>
+T * SafeArrayView<T, Rank>::data() const
+{
+    return origin;
+}
+
+
+/** \brief Get iterator to first element of 1-dimensional view.
+ */
+template <typename T, USHORT Rank>
+auto SafeArrayView<T, Rank>::begin() const
+    -> iterator
+{
+    static_assert(Rank == 1, "Can only iterate over 1-dimensional views");
+    return iterator(origin, strides[0]);
+}
+
+
+/** \brief Get iterator past last element of 1-dimensional view.
+ */
+template <typename T, USHORT Rank>
+auto SafeArrayView<T, Rank>::end() const
+    -> iterator
+{
+    static_assert(Rank == 1, "Can only iterate over 1-dimensional views");
+    return begin() + extents[0];
+}
+
+
+/** \brief Fix the index along a dimension, removing the dimension.
+ *
+ *  \throw std::out_of_range    Index is outside the view bounds.
+ */
+template <typename T, USHORT Rank>
+auto SafeArrayView<T, Rank>::slice(const USHORT dimension,
+    const LONG index) const
+    -> SafeArrayView<T, Rank-1>
+{
+    static_assert(Rank >= 2, "Cannot slice 1-dimensional view");
+
+    checkDimension(dimension);
+    const LONG position = index - lowers[dimension];
+    if (position < 0 || static_cast<ULONG>(position) >= extents[dimension]) {
+        throw std::out_of_range("SafeArrayView:: Index is out of bounds");
+    }
+
+    SafeArrayView<T, Rank-1> view;
+    view.origin = origin + position * strides[dimension];
+    for (USHORT i = 0, j = 0; i < Rank; ++i) {
+        if (i != dimension) {
+            view.lowers[j] = lowers[i];
+            view.extents[j] = extents[i];
+            view.strides[j] = strides[i];
+            ++j;
+        }
+    }
+    return view;
+}
+
+
+/** \brief Restrict a dimension to `count` indexes from `first`.
+ *
+ *  The view keeps the original indexes, so `first` becomes the lower
+ *  bound of the dimension.
+ *
+ *  \throw std::out_of_range    Range is outside the view bounds.
+ */
+template <typename T, USHORT Rank>
+auto SafeArrayView<T, Rank>::subview(const USHORT dimension,
+    const LONG first,
+    const size_t count) const
+    -> This
+{
+    checkDimension(dimension);
+    const LONG position = first - lowers[dimension];
+    if (position < 0 || position + count > extents[dimension]) {
+        throw std::out_of_range("SafeArrayView:: Range is out of bounds");
+    }
+
+    This view(*this);
+    view.origin = origin + position * strides[dimension];
+    view.lowers[dimension] = first;
+    view.extents[dimension] = static_cast<ULONG>(count);
+    return view;
+}
+
+
+/** \brief Get row of `[rows][columns]` view, strided in memory.
+ */
+template <typename T, USHORT Rank>
+auto SafeArrayView<T, Rank>::row(const LONG index) const
+    -> SafeArrayView<T, Rank-1>
+{
+    static_assert(Rank == 2, "Rows are only defined for 2-dimensional views");
+    return slice(0, index);
+}
+
+
+/** \brief Get column of `[rows][columns]` view, contiguous in memory
+ *  unless the view is transposed.
+ */
+template <typename T, USHORT Rank>
+auto SafeArrayView<T, Rank>::column(const LONG index) const
+    -> SafeArrayView<T, Rank-1>
+{
+    static_assert(Rank == 2, "Columns are only defined for 2-dimensional views");
+    return slice(1, index);
+}
+
+
+/** \brief Reverse the order of dimensions, without moving elements.
+ */
+template <typename T, USHORT Rank>
+auto SafeArrayView<T, Rank>::transpose() const
+    -> This
+{
+    This view(*this);
+    std::reverse(view.lowers, view.lowers + Rank);
+    std::reverse(view.extents, view.extents + Rank);
+    std::reverse(view.strides, view.strides + Rank);
+    return view;
+}
+
+
+/** \brief Copy elements to a buffer with the last index varying fastest.
+ *
+ *  The last two dimensions are copied in tiles, so neither the strided
+ *  reads nor the writes leave the cache, and no transposed copy of
+ *  the array is made. `out` must hold `size()` elements.
+ */
+template <typename T, USHORT Rank>
+template <typename U>
+void SafeArrayView<T, Rank>::copyRowMajor(U *out) const
+{
+    if (empty()) {
+        return;
+    } else if (Rank == 1) {
+        for (ULONG i = 0; i < extents[0]; ++i) {
+            out[i] = origin[i * strides[0]];
+        }
+        return;
+    }
+
+    constexpr ULONG TILE = 32;
+    constexpr USHORT rowDimension = Rank >= 2 ? Rank - 2 : 0;
+    constexpr USHORT columnDimension = Rank - 1;
+    const ULONG rows = extents[rowDimension];
+    const ULONG columns = extents[columnDimension];
+    const size_t rowStride = strides[rowDimension];
+    const size_t columnStride = strides[columnDimension];
+
+    // leading dimensions, with the last varying fastest
+    ULONG outer[Rank] = {};
+    const size_t planes = size() / (rows * columns);
+    for (size_t plane = 0; plane < planes; ++plane) {
+        size_t offset = 0;
+        for (USHORT i = 0; i < rowDimension; ++i) {
+            offset += outer[i] * strides[i];
+        }
+        const T *source = origin + offset;
+        U *destination = out + plane * rows * columns;
+
+        for (ULONG i0 = 0; i0 < rows; i0 += TILE) {
+            const ULONG i1 = std::min(rows, i0 + TILE);
+            for (ULONG j0 = 0; j0 < columns; j0 += TILE) {
+                const ULONG j1 = std::min(columns, j0 + TILE);
+                for (ULONG i = i0; i < i1; ++i) {
+                    for (ULONG j = j0; j < j1; ++j) {
+                        destination[i * columns + j] = source[i * rowStride + j * columnStride];
+                    }
+                }
+            }
+        }
+
+        for (USHORT i = rowDimension; i-- > 0; ) {
+            if (++outer[i] < extents[i]) {
+                break;
+            }
+            outer[i] = 0;
+        }
+    }
+}
+
+
 /** \brief Lock array, forcing it to take a take a fixed memory location.
  *
  *  \warning These functions do not check for NULL values.
@@ -210,11 +934,10 @@ static_assert(sizeof(SafeArrayBound) == sizeof(SAFEARRAYBOUND), "sizeof(SafeArra
 template <typename T>
 void SafeArray<T>::lock()
 {
-    auto hr = SafeArrayLock(array);
-    if (FAILED(hr)) {
-        printf("FUCK: %d\n", hr);
+    if (FAILED(SafeArrayLock(array))) {
         throw ComFunctionError("SafeArrayLock()");
     }
+    layout.reset(array);
 }
 
 
@@ -225,6 +948,7 @@ void SafeArray<T>::lock()
 template <typename T>
 void SafeArray<T>::unlock()
 {
+    layout.reset(nullptr);
     if (FAILED(SafeArrayUnlock(array))) {
         throw ComFunctionError("SafeArrayUnlock()");
     }
@@ -342,6 +1066,11 @@ template <typename T>
 auto SafeArray<T>::operator=(This &&other)
     -> This &
 {
+    if (this == &other) {
+        return *this;
+    }
+
+    close();
     if (other.array) {
         other.unlock();
     }
@@ -510,7 +1239,7 @@ auto SafeArray<T>::begin() noexcept
     -> iterator
 {
     checkNull();
-    return reinterpret_cast<iterator>(array->pvData);
+    return reinterpret_cast<iterator>(layout.base);
 }
 
 
@@ -520,7 +1249,7 @@ template <typename T>
 auto SafeArray<T>::end() noexcept
     -> iterator
 {
-    return begin() + size(-1);
+    return begin() + layout.count;
 }
 
 
@@ -550,7 +1279,8 @@ template <typename T>
 auto SafeArray<T>::cbegin() const noexcept
     -> const_iterator
 {
-    return const_cast<const_iterator>(begin());
+    checkNull();
+    return reinterpret_cast<const_iterator>(layout.base);
 }
 
 
@@ -560,7 +1290,7 @@ template <typename T>
 auto SafeArray<T>::cend() const noexcept
     -> const_iterator
 {
-    return cbegin() + size(-1);
+    return cbegin() + layout.count;
 }
 
 
@@ -625,6 +1355,9 @@ auto SafeArray<T>::crend() const noexcept
 
 
 /** \brief Get size of array.
+ *
+ *  \param size        Index into SAFEARRAY::rgsabound, or -1 for the
+ *                      total number of elements.
  */
 template <typename T>
 size_t SafeArray<T>::size(const LONG size) const
@@ -636,18 +1369,67 @@ size_t SafeArray<T>::size(const LONG size) const
     }
 
     if (size < 0) {
-        // get all dimensions
-        size_t size = 1;
-        for (USHORT i = 0; i < array->cDims; ++i) {
-            const auto &bound = array->rgsabound[i];
-            size *= (bound.cElements - bound.lLbound);
-        }
-        return size;
-    } else {
-        // get single dimension
-        const auto &bound = array->rgsabound[size];
-        return (bound.cElements - bound.lLbound);
+        return layout.count;
+    }
+    return array->rgsabound[size].cElements;
+}
+
+
+/** \brief Get number of dimensions.
+ */
+template <typename T>
+USHORT SafeArray<T>::dimensions() const
+{
+    checkNull();
+    return array->cDims;
+}
+
+
+/** \brief Get number of elements along a dimension, in index order.
+ */
+template <typename T>
+size_t SafeArray<T>::extent(const USHORT dimension) const
+{
+    checkNull();
+    if (dimension >= array->cDims) {
+        throw std::out_of_range("SafeArray:: Dimension requested is out of bounds");
+    }
+    return array->rgsabound[array->cDims - 1 - dimension].cElements;
+}
+
+
+/** \brief Get lower bound of a dimension, in index order.
+ */
+template <typename T>
+LONG SafeArray<T>::lower(const USHORT dimension) const
+{
+    checkNull();
+    if (dimension >= array->cDims) {
+        throw std::out_of_range("SafeArray:: Dimension requested is out of bounds");
+    }
+    return array->rgsabound[array->cDims - 1 - dimension].lLbound;
+}
+
+
+/** \brief Get distance in elements between consecutive indexes of
+ *  a dimension, in index order.
+ */
+template <typename T>
+size_t SafeArray<T>::stride(const USHORT dimension) const
+{
+    checkNull();
+    if (dimension >= array->cDims) {
+        throw std::out_of_range("SafeArray:: Dimension requested is out of bounds");
+    }
+    if (layout.cached()) {
+        return layout.stride[dimension];
+    }
+
+    size_t stride = 1;
+    for (USHORT i = 0; i < dimension; ++i) {
+        stride *= array->rgsabound[array->cDims - 1 - i].cElements;
     }
+    return stride;
 }
 
 
@@ -656,33 +1438,51 @@ size_t SafeArray<T>::size(const LONG size) const
 template <typename T>
 bool SafeArray<T>::empty() const
 {
-    return array ? size(-1) == 0 : true;
+    return array ? layout.count == 0 : true;
 }
 
 
-/** \brief Get element at multi-dimensional index.
+/** \brief Get element at multi-dimensional index, without bounds checks.
  */
 template <typename T>
 template <typename U>
 typename std::enable_if<std::is_pointer<U>::value, T&>::type
 SafeArray<T>::operator[](U indices)
 {
-    return at(indices);
+    auto *data = reinterpret_cast<pointer>(layout.base);
+    switch (layout.rank) {
+        case 1:
+            return data[indices[0] - layout.lower[0]];
+        case 2:
+            return data[(indices[0] - layout.lower[0]) + (indices[1] - layout.lower[1]) * layout.stride[1]];
+        case 0:
+            return at(indices);
+        default:
+            break;
+    }
+
+    size_t offset = 0;
+    for (USHORT i = 0; i < layout.rank; ++i) {
+        offset += (indices[i] - layout.lower[i]) * layout.stride[i];
+    }
+    return data[offset];
 }
 
 
-/** \brief Get element at multi-dimensional index.
+/** \brief Get element at multi-dimensional index, without bounds checks.
  */
 template <typename T>
 template <typename U>
 typename std::enable_if<std::is_pointer<U>::value, const T&>::type
 SafeArray<T>::operator[](U indices) const
 {
-    return at(indices);
+    return const_cast<This&>(*this)[indices];
 }
 
 
 /** \brief Get element at multi-dimensional index.
+ *
+ *  \throw std::out_of_range    Index is outside the array bounds.
  */
 template <typename T>
 template <typename U>
@@ -690,25 +1490,81 @@ typename std::enable_if<std::is_pointer<U>::value, T&>::type
 SafeArray<T>::at(U indices)
 {
     checkNull();
-    T *data;
-    SafeArrayPtrOfIndex(array, indices, (void**) &data);
+    if (!layout.cached()) {
+        T *data;
+        if (FAILED(SafeArrayPtrOfIndex(array, indices, (void**) &data))) {
+            throw std::out_of_range("SafeArray:: Index is out of bounds");
+        }
+        return *data;
+    }
 
-    return *data;
+    size_t offset = 0;
+    for (USHORT i = 0; i < layout.rank; ++i) {
+        const LONG index = indices[i] - layout.lower[i];
+        if (index < 0 || static_cast<ULONG>(index) >= layout.extent[i]) {
+            throw std::out_of_range("SafeArray:: Index is out of bounds");
+        }
+        offset += index * layout.stride[i];
+    }
+    return reinterpret_cast<pointer>(layout.base)[offset];
 }
 
 
 /** \brief Get element at multi-dimensional index.
+ *
+ *  \throw std::out_of_range    Index is outside the array bounds.
  */
 template <typename T>
 template <typename U>
 typename std::enable_if<std::is_pointer<U>::value, const T&>::type
 SafeArray<T>::at(U indices) const
 {
-    checkNull();
-    T *data;
-    SafeArrayPtrOfIndex(array, indices, (void**) &data);
+    return const_cast<This&>(*this).at(indices);
+}
+
+/** \brief Get element at indexes, in index order, without bounds checks.
+ *
+ *  Indexes are passed by value, so unlike operator[] the compiler can
+ *  keep the layout in registers within loops. Arrays with more than
+ *  `SafeArrayLayout::MAX_RANK` dimensions are not cached, and fall back
+ *  to the bounds-checked at().
+ *
+ *  \throw std::invalid_argument   Array does not have one dimension
+ *                                  per index.
+ */
+template <typename T>
+template <typename... Ts>
+T & SafeArray<T>::operator()(const Ts... indices)
+{
+    static_assert(sizeof...(Ts) >= 1, "Invalid number of indexes");
 
-    return const_cast<const_reference>(data);
+    LONG list[] = {static_cast<LONG>(indices)...};
+    if (sizeof...(Ts) > SafeArrayLayout::MAX_RANK || !layout.cached()) {
+        checkNull();
+        if (array->cDims != sizeof...(Ts)) {
+            throw std::invalid_argument("SafeArray:: Number of indexes does not match array rank");
+        }
+        return at(list);
+    }
+
+    if (layout.rank != sizeof...(Ts)) {
+        throw std::invalid_argument("SafeArray:: Number of indexes does not match array rank");
+    }
+    size_t offset = 0;
+    for (USHORT i = 0; i < sizeof...(Ts); ++i) {
+        offset += (list[i] - layout.lower[i]) * layout.stride[i];
+    }
+    return reinterpret_cast<pointer>(layout.base)[offset];
+}
+
+
+/** \brief Get element at indexes, in index order, without bounds checks.
+ */
+template <typename T>
+template <typename... Ts>
+const T & SafeArray<T>::operator()(const Ts... indices) const
+{
+    return const_cast<This&>(*this)(indices...);
 }
 
 
@@ -742,8 +1598,7 @@ typename std::enable_if<std::is_integral<U>::value, T&>::type
 SafeArray<T>::at(const U index)
 {
     checkNull();
-    auto *buffer = reinterpret_cast<pointer>(array->pvData);
-    return buffer[index];
+    return reinterpret_cast<pointer>(layout.base)[index];
 }
 
 
@@ -755,8 +1610,7 @@ typename std::enable_if<std::is_integral<U>::value, const T&>::type
 SafeArray<T>::at(const U index) const
 {
     checkNull();
-    auto *buffer = reinterpret_cast<pointer>(array->pvData);
-    return const_cast<const_reference>(buffer[index]);
+    return reinterpret_cast<const_pointer>(layout.base)[index];
 }
 
 
@@ -811,8 +1665,37 @@ auto SafeArray<T>::data() const
     -> const_pointer
 {
     checkNull();
-    auto *buffer = reinterpret_cast<pointer>(array->pvData);
-    return const_cast<const_pointer>(buffer);
+    return reinterpret_cast<const_pointer>(layout.base);
+}
+
+
+/** \brief Get view of array with `Rank` dimensions.
+ *
+ *  \throw std::invalid_argument   Array does not have `Rank` dimensions.
+ */
+template <typename T>
+template <USHORT Rank>
+SafeArrayView<T, Rank> SafeArray<T>::view()
+{
+    static_assert(Rank >= 1 && Rank <= SafeArrayLayout::MAX_RANK, "Invalid view rank");
+
+    checkNull();
+    if (!layout.cached() || layout.rank != Rank) {
+        throw std::invalid_argument("SafeArray:: View rank does not match array");
+    }
+    return SafeArrayView<T, Rank>(reinterpret_cast<pointer>(layout.base), layout.lower, layout.extent, layout.stride);
+}
+
+
+/** \brief Get view of array with `Rank` dimensions.
+ *
+ *  \throw std::invalid_argument   Array does not have `Rank` dimensions.
+ */
+template <typename T>
+template <USHORT Rank>
+SafeArrayView<const T, Rank> SafeArray<T>::view() const
+{
+    return const_cast<This&>(*this).template view<Rank>();
 }
 
 
@@ -9,10 +9,12 @@
 
 #include "guid.hpp"
 #include "safearray.hpp"
-#include "util/shared_ptr.hpp"
+#include "util/com_ptr.hpp"
 
 #include <oaidl.h>
 
+#include <memory>
+
 
 namespace autocom
 {
@@ -36,8 +38,8 @@ class ParamDesc;
 // TYPES
 // -----
 
-typedef SharedPointer<ITypeInfo> ITypeInfoPtr;
-typedef SharedPointer<ITypeLib> ITypeLibPtr;
+typedef ComPtr<ITypeInfo> ITypeInfoPtr;
+typedef ComPtr<ITypeLib> ITypeLibPtr;
 typedef std::shared_ptr<TYPEATTR> TYPEATTRPtr;
 typedef std::shared_ptr<TLIBATTR> TLIBATTRPtr;
 typedef std::shared_ptr<VARDESC> VARDESCPtr;
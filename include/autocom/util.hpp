@@ -8,9 +8,11 @@
 #pragma once
 
 #include "util/alias.hpp"
+#include "util/com_ptr.hpp"
 #include "util/define.hpp"
 #include "util/enum.hpp"
 #include "util/exception.hpp"
+#include "util/parallel.hpp"
 #include "util/sfinae.hpp"
 #include "util/shared_ptr.hpp"
 #include "util/type.hpp"
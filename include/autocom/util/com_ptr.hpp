@@ -0,0 +1,303 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoCOM
+ *  \brief Intrusive smart pointer for COM objects.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include <oaidl.h>
+
+
+namespace autocom
+{
+// OBJECTS
+// -------
+
+
+/** \brief Smart pointer using the COM object's own reference count.
+ *
+ *  Unlike SharedPointer, ComPtr allocates no control block and is
+ *  the size of a single pointer. Copies call AddRef, and destruction
+ *  calls Release. Like SharedPointer, raw pointers are adopted, so
+ *  the reference returned by a COM call is not added to.
+ */
+template <typename T>
+class ComPtr
+{
+protected:
+    typedef ComPtr<T> This;
+
+    T *ptr = nullptr;
+
+    template <typename U>
+    friend class ComPtr;
+
+public:
+    constexpr ComPtr() noexcept = default;
+    ComPtr(const ComPtr &other) noexcept;
+    This & operator=(const ComPtr &other) noexcept;
+    ComPtr(ComPtr &&other) noexcept;
+    This & operator=(ComPtr &&other) noexcept;
+    ~ComPtr();
+
+    constexpr ComPtr(std::nullptr_t nullp) noexcept;
+    ComPtr(T *t) noexcept;
+
+    template <
+        typename U,
+        typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type
+    >
+    ComPtr(const ComPtr<U> &other) noexcept;
+
+    // MODIFIERS
+    void reset() noexcept;
+    void reset(std::nullptr_t nullp) noexcept;
+    void reset(T *t) noexcept;
+    T * detach() noexcept;
+    void swap(ComPtr &other) noexcept;
+
+    // CONVERSION
+    template <typename U>
+    ComPtr<U> query(REFIID iid) const;
+
+    // OBSERVERS
+    T * get() const noexcept;
+    T & operator*() const noexcept;
+    T * operator->() const noexcept;
+    explicit operator bool() const noexcept;
+};
+
+
+// IMPLEMENTATION
+// --------------
+
+
+/** \brief Copy constructor, adding a reference.
+ */
+template <typename T>
+ComPtr<T>::ComPtr(const ComPtr &other) noexcept:
+    ptr(other.ptr)
+{
+    if (ptr) {
+        ptr->AddRef();
+    }
+}
+
+
+/** \brief Copy assignment operator, adding a reference.
+ */
+template <typename T>
+auto ComPtr<T>::operator=(const ComPtr &other) noexcept
+    -> This &
+{
+    ComPtr(other).swap(*this);
+    return *this;
+}
+
+
+/** \brief Move constructor, transferring the reference.
+ */
+template <typename T>
+ComPtr<T>::ComPtr(ComPtr &&other) noexcept:
+    ptr(other.ptr)
+{
+    other.ptr = nullptr;
+}
+
+
+/** \brief Move assignment operator, transferring the reference.
+ */
+template <typename T>
+auto ComPtr<T>::operator=(ComPtr &&other) noexcept
+    -> This &
+{
+    ComPtr(std::move(other)).swap(*this);
+    return *this;
+}
+
+
+/** \brief Destructor, releasing the reference.
+ */
+template <typename T>
+ComPtr<T>::~ComPtr()
+{
+    if (ptr) {
+        ptr->Release();
+    }
+}
+
+
+/** \brief Initialize from null pointer.
+ */
+template <typename T>
+constexpr ComPtr<T>::ComPtr(std::nullptr_t nullp) noexcept
+{}
+
+
+/** \brief Initialize from COM pointer, adopting its reference.
+ */
+template <typename T>
+ComPtr<T>::ComPtr(T *t) noexcept:
+    ptr(t)
+{}
+
+
+/** \brief Initialize from pointer to derived interface.
+ */
+template <typename T>
+template <typename U, typename>
+ComPtr<T>::ComPtr(const ComPtr<U> &other) noexcept:
+    ptr(other.ptr)
+{
+    if (ptr) {
+        ptr->AddRef();
+    }
+}
+
+
+/** \brief Release the reference.
+ */
+template <typename T>
+void ComPtr<T>::reset() noexcept
+{
+    ComPtr().swap(*this);
+}
+
+
+/** \brief Release the reference.
+ */
+template <typename T>
+void ComPtr<T>::reset(std::nullptr_t nullp) noexcept
+{
+    ComPtr().swap(*this);
+}
+
+
+/** \brief Release the reference, and adopt a COM pointer.
+ */
+template <typename T>
+void ComPtr<T>::reset(T *t) noexcept
+{
+    ComPtr(t).swap(*this);
+}
+
+
+/** \brief Give up ownership of the reference, without releasing it.
+ */
+template <typename T>
+T * ComPtr<T>::detach() noexcept
+{
+    T *t = ptr;
+    ptr = nullptr;
+    return t;
+}
+
+
+/** \brief Swap pointers.
+ */
+template <typename T>
+void ComPtr<T>::swap(ComPtr &other) noexcept
+{
+    std::swap(ptr, other.ptr);
+}
+
+
+/** \brief Query object for another interface.
+ *
+ *  \return     Pointer to interface, or null if it is not supported.
+ */
+template <typename T>
+template <typename U>
+ComPtr<U> ComPtr<T>::query(REFIID iid) const
+{
+    U *u = nullptr;
+    if (!ptr || FAILED(ptr->QueryInterface(iid, (void **) &u))) {
+        return ComPtr<U>();
+    }
+
+    return ComPtr<U>(u);
+}
+
+
+/** \brief Get raw pointer.
+ */
+template <typename T>
+T * ComPtr<T>::get() const noexcept
+{
+    return ptr;
+}
+
+
+/** \brief Dereference pointer.
+ */
+template <typename T>
+T & ComPtr<T>::operator*() const noexcept
+{
+    return *ptr;
+}
+
+
+/** \brief Dereference pointer.
+ */
+template <typename T>
+T * ComPtr<T>::operator->() const noexcept
+{
+    return ptr;
+}
+
+
+/** \brief Check if pointer is non-null.
+ */
+template <typename T>
+ComPtr<T>::operator bool() const noexcept
+{
+    return ptr != nullptr;
+}
+
+
+/** \brief Equality operator.
+ */
+template <typename T, typename U>
+bool operator==(const ComPtr<T> &left,
+    const ComPtr<U> &right) noexcept
+{
+    return left.get() == right.get();
+}
+
+
+/** \brief Inequality operator.
+ */
+template <typename T, typename U>
+bool operator!=(const ComPtr<T> &left,
+    const ComPtr<U> &right) noexcept
+{
+    return left.get() != right.get();
+}
+
+
+/** \brief Equality operator with null.
+ */
+template <typename T>
+bool operator==(const ComPtr<T> &left,
+    std::nullptr_t) noexcept
+{
+    return !left;
+}
+
+
+/** \brief Inequality operator with null.
+ */
+template <typename T>
+bool operator!=(const ComPtr<T> &left,
+    std::nullptr_t) noexcept
+{
+    return bool(left);
+}
+
+}   /* autocom */
@@ -0,0 +1,103 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/**
+ *  \addtogroup AutoCOM
+ *  \brief Chunked multi-threading for large inputs.
+ *
+ *  Shared by parallel transcoding and column conversion: a policy
+ *  which picks the number of chunks, and a helper which runs one
+ *  thread per chunk.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <vector>
+
+
+namespace autocom
+{
+// OBJECTS
+// -------
+
+
+/** \brief Policy for splitting work across threads.
+ *
+ *  Inputs with fewer than `threshold` elements stay on the serial
+ *  path. `threads` of 0 uses the hardware concurrency.
+ */
+struct Parallel
+{
+    size_t threshold = 1 << 20;
+    size_t threads = 0;
+
+    constexpr Parallel() = default;
+    constexpr Parallel(const size_t threshold,
+            const size_t threads = 0):
+        threshold(threshold),
+        threads(threads)
+    {}
+
+    size_t workers(const size_t length) const;
+};
+
+
+/** \brief Parallel policy which never leaves the serial path.
+ */
+constexpr Parallel SERIAL(std::numeric_limits<size_t>::max(), 1);
+
+// FUNCTIONS
+// ---------
+
+/** \brief Run function(i) for every chunk, one thread per chunk.
+ *
+ *  The calling thread handles the first chunk, and the first exception
+ *  thrown by any chunk is rethrown once all threads have joined.
+ *
+ *  \warning The threads do not initialize COM, so function must not
+ *  touch COM objects.
+ */
+template <typename Function>
+void forEachChunk(const size_t chunks,
+    Function function);
+
+// IMPLEMENTATION
+// --------------
+
+
+/** \brief Run function(i) for every chunk, one thread per chunk.
+ */
+template <typename Function>
+void forEachChunk(const size_t chunks,
+    Function function)
+{
+    std::vector<std::exception_ptr> errors(chunks);
+    auto run = [&](size_t i) {
+        try {
+            function(i);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunks - 1);
+    for (size_t i = 1; i < chunks; ++i) {
+        threads.emplace_back(run, i);
+    }
+    run(0);
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    for (auto &error: errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}   /* autocom */
@@ -329,6 +329,22 @@ AUTOCOM_SAFE_SPECIALIZER(IDispatch, VT_DISPATCH);
 AUTOCOM_SAFE_VALUE_SPECIALIZER(Variant, VT_VARIANT | VT_BYREF);
 AUTOCOM_SAFE_POINTER_SPECIALIZER(Decimal, VT_DECIMAL);
 
+// ARRAYS
+
+/** \brief SAFEARRAY(VARIANT) stores its elements by value.
+ */
+template<>
+struct VariantType<VARIANT, true>
+{
+    static constexpr VARTYPE vt = VT_VARIANT;
+};
+
+template<>
+struct VariantType<Variant, true>
+{
+    static constexpr VARTYPE vt = VT_VARIANT;
+};
+
 // IMPLEMENTATION
 // --------------
 
@@ -14,6 +14,8 @@
 
 #include <oaidl.h>
 
+#include <limits>
+#include <type_traits>
 #include <vector>
 
 
@@ -54,6 +56,74 @@ VARTYPE TO_VARTYPE(const T t)
     return static_cast<VARTYPE>(t);
 }
 
+// VISITOR
+// -------
+
+/** \brief Payload passed for VT_EMPTY.
+ */
+struct VariantEmpty
+{};
+
+/** \brief Payload passed for VT_NULL.
+ */
+struct VariantNull
+{};
+
+/** \brief Payload passed for VT_DATE, which otherwise aliases DOUBLE.
+ */
+struct VariantDate
+{
+    DATE value;
+};
+
+/** \brief Payload passed for VT_ERROR, which otherwise aliases LONG.
+ */
+struct VariantError
+{
+    SCODE value;
+};
+
+
+/** \brief Check if `From` converts to `To` without loss.
+ */
+template <
+    typename From,
+    typename To,
+    bool = std::is_arithmetic<From>::value && std::is_arithmetic<To>::value && !std::is_same<From, bool>::value
+>
+struct IsWidening: std::false_type
+{};
+
+template <typename From, typename To>
+struct IsWidening<From, To, true>: std::integral_constant<bool,
+        (std::is_floating_point<To>::value || (std::is_integral<From>::value && (std::is_signed<To>::value || !std::is_signed<From>::value)))
+        && std::numeric_limits<From>::digits <= std::numeric_limits<To>::digits>
+{};
+
+
+/** \brief Call visitor with the typed payload of a variant.
+ *
+ *  Dispatches with a single dense switch on `vt`, which compilers
+ *  lower to a jump table. Payloads whose C types would alias are
+ *  tagged: VT_BOOL passes `bool`, VT_DATE a VariantDate, and VT_ERROR
+ *  a VariantError. VT_VARIANT | VT_BYREF is followed, and any other
+ *  type (arrays, references, records) passes the VARIANT itself.
+ */
+template <typename Visitor>
+typename std::result_of<Visitor&(const VARIANT&)>::type visit(const VARIANT &variant,
+    Visitor &&visitor);
+
+/** \brief Convert numeric variant to value without VariantChangeType.
+ *
+ *  Only lossless widenings, such as VT_I4 to LONGLONG or VT_R4 to
+ *  DOUBLE, are handled.
+ *
+ *  \return             Value was set
+ */
+template <typename T>
+bool widenVariant(const VARIANT &variant,
+    T &value);
+
 // MACROS -- SETTERS
 // -----------------
 
@@ -208,6 +278,16 @@ void set(VARIANT &variant,
 void set(VARIANT &variant,
     Bstr *value);
 
+/** \brief Set a BSTR value copied from a view.
+ */
+void set(VARIANT &variant,
+    const BstrView &value);
+
+/** \brief Set a BSTR value copied from a wide string.
+ */
+void set(VARIANT &variant,
+    const std::wstring &value);
+
 /** \brief Set a BSTR value from wrapper.
  */
 void set(VARIANT &variant,
@@ -660,6 +740,100 @@ static_assert(sizeof(Variant) == sizeof(VARIANT), "sizeof(Variant) != sizeof(VAR
 // --------------
 
 
+/** \brief Visitor which assigns payloads that widen to T.
+ */
+template <typename T>
+struct WidenVisitor
+{
+    T &value;
+
+    template <typename U>
+    typename std::enable_if<IsWidening<U, T>::value, bool>::type operator()(const U &u) const
+    {
+        value = static_cast<T>(u);
+        return true;
+    }
+
+    template <typename U>
+    typename std::enable_if<!IsWidening<U, T>::value, bool>::type operator()(const U &) const
+    {
+        return false;
+    }
+};
+
+
+/** \brief Call visitor with the typed payload of a variant.
+ */
+template <typename Visitor>
+typename std::result_of<Visitor&(const VARIANT&)>::type visit(const VARIANT &variant,
+    Visitor &&visitor)
+{
+    switch (variant.vt) {
+        case VT_EMPTY:
+            return visitor(VariantEmpty());
+        case VT_NULL:
+            return visitor(VariantNull());
+        case VT_I2:
+            return visitor(variant.iVal);
+        case VT_I4:
+            return visitor(variant.lVal);
+        case VT_R4:
+            return visitor(variant.fltVal);
+        case VT_R8:
+            return visitor(variant.dblVal);
+        case VT_CY:
+            return visitor(variant.cyVal);
+        case VT_DATE:
+            return visitor(VariantDate {variant.date});
+        case VT_BSTR:
+            return visitor(variant.bstrVal);
+        case VT_DISPATCH:
+            return visitor(variant.pdispVal);
+        case VT_ERROR:
+            return visitor(VariantError {variant.scode});
+        case VT_BOOL:
+            return visitor(variant.boolVal != VARIANT_FALSE);
+        case VT_UNKNOWN:
+            return visitor(variant.punkVal);
+        case VT_DECIMAL:
+            return visitor(variant.decVal);
+        case VT_I1:
+            return visitor(variant.cVal);
+        case VT_UI1:
+            return visitor(variant.bVal);
+        case VT_UI2:
+            return visitor(variant.uiVal);
+        case VT_UI4:
+            return visitor(variant.ulVal);
+        case VT_I8:
+            return visitor(variant.llVal);
+        case VT_UI8:
+            return visitor(variant.ullVal);
+        case VT_INT:
+            return visitor(variant.intVal);
+        case VT_UINT:
+            return visitor(variant.uintVal);
+        case VT_VARIANT | VT_BYREF:
+            if (variant.pvarVal) {
+                return visit(*variant.pvarVal, visitor);
+            }
+            return visitor(variant);
+        default:
+            return visitor(variant);
+    }
+}
+
+
+/** \brief Convert numeric variant to value without VariantChangeType.
+ */
+template <typename T>
+bool widenVariant(const VARIANT &variant,
+    T &value)
+{
+    return visit(variant, WidenVisitor<T> {value});
+}
+
+
 /** \brief Set value in variant.
  */
 template <typename T>
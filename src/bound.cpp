@@ -0,0 +1,68 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoCOM
+ *  \brief Dispatch members bound to a DISPID.
+ */
+
+#include "autocom/bound.hpp"
+
+
+namespace autocom
+{
+// OBJECTS
+// -------
+
+
+/** \brief Bind member of IDispatch object.
+ */
+BoundMember::BoundMember(const ComPtr<IDispatch> &ppv,
+    const DISPID id):
+    ppv(ppv),
+    id(id)
+{}
+
+
+/** \brief Get bound dispatch identifier.
+ */
+DISPID BoundMember::function() const
+{
+    return id;
+}
+
+
+/** \brief Check if member is bound.
+ */
+BoundMember::operator bool() const
+{
+    return bool(ppv);
+}
+
+
+/** \brief Bind method, deriving the named arguments from the flags.
+ */
+BoundMethod::BoundMethod(const ComPtr<IDispatch> &ppv,
+    const DISPID id,
+    const DispatchFlags flags):
+    BoundMember(ppv, id),
+    flags(FROM_ENUM(flags)),
+    useNamed(!!(flags & (PUT | PUTREF)))
+{}
+
+
+/** \brief Bind property, using `put` for assignment.
+ *
+ *  \throw std::invalid_argument    `put` is not PUT or PUTREF.
+ */
+BoundProperty::BoundProperty(const ComPtr<IDispatch> &ppv,
+    const DISPID id,
+    const DispatchFlags put):
+    BoundMember(ppv, id),
+    putFlags(FROM_ENUM(put))
+{
+    if (put != PUT && put != PUTREF) {
+        throw std::invalid_argument("Property must be bound with PUT or PUTREF.");
+    }
+}
+
+}   /* autocom */
@@ -7,9 +7,19 @@
 
 #include "autocom/bstr.hpp"
 #include "autocom/encoding/converters.hpp"
+#include "autocom/encoding/simd.hpp"
+#include "autocom/encoding/view.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <cwchar>
+#include <iterator>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
 
 #ifdef _MSC_VER
 #   pragma warning(push)
@@ -19,6 +29,365 @@
 
 namespace autocom
 {
+// HELPERS
+// -------
+
+typedef std::conditional<sizeof(wchar_t) == 2, uint16_t, uint32_t>::type WideUnit;
+
+const uint64_t HASH_PRIME1 = 0x9E3779B185EBCA87ULL;
+const uint64_t HASH_PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t HASH_PRIME3 = 0x165667B19E3779F9ULL;
+const uint64_t HASH_PRIME4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t HASH_PRIME5 = 0x27D4EB2F165667C5ULL;
+
+/** Code units folded per block for case-insensitive hashing. Must
+ *  be a multiple of the 32-byte hash stripe.
+ */
+const size_t FOLD_BLOCK = 64;
+
+
+/** \brief Get number of leading code units which are identical.
+ */
+size_t mismatch(const wchar_t *left,
+    const wchar_t *right,
+    const size_t length)
+{
+    if (sizeof(wchar_t) == 2) {
+        auto l = reinterpret_cast<const uint16_t*>(left);
+        auto r = reinterpret_cast<const uint16_t*>(right);
+        return utf::simd::mismatch(l, r, length);
+    } else if (wmemcmp(left, right, length) == 0) {
+        return length;
+    }
+
+    return std::mismatch(left, left + length, right).first - left;
+}
+
+
+/** \brief Range of code units with the same simple uppercase offset.
+ *
+ *  Every `stride`-th code unit from `first` to `last` maps to its
+ *  uppercase form by adding `delta`, modulo 2^16.
+ */
+struct UpperRange
+{
+    uint16_t first;
+    uint16_t last;
+    uint16_t delta;
+    uint16_t stride;
+};
+
+/** Simple uppercase mappings for the non-ASCII BMP, from the Unicode
+ *  14.0.0 character database. The table is fixed, so case-insensitive
+ *  hashes and comparisons never change with the C locale.
+ */
+const UpperRange UPPER_RANGES[] = {
+    {0x00B5, 0x00B5, 0x02E7, 1}, {0x00E0, 0x00F6, 0xFFE0, 1}, {0x00F8, 0x00FE, 0xFFE0, 1},
+    {0x00FF, 0x00FF, 0x0079, 1}, {0x0101, 0x012F, 0xFFFF, 2}, {0x0131, 0x0131, 0xFF18, 1},
+    {0x0133, 0x0137, 0xFFFF, 2}, {0x013A, 0x0148, 0xFFFF, 2}, {0x014B, 0x0177, 0xFFFF, 2},
+    {0x017A, 0x017E, 0xFFFF, 2}, {0x017F, 0x017F, 0xFED4, 1}, {0x0180, 0x0180, 0x00C3, 1},
+    {0x0183, 0x0185, 0xFFFF, 2}, {0x0188, 0x0188, 0xFFFF, 1}, {0x018C, 0x018C, 0xFFFF, 1},
+    {0x0192, 0x0192, 0xFFFF, 1}, {0x0195, 0x0195, 0x0061, 1}, {0x0199, 0x0199, 0xFFFF, 1},
+    {0x019A, 0x019A, 0x00A3, 1}, {0x019E, 0x019E, 0x0082, 1}, {0x01A1, 0x01A5, 0xFFFF, 2},
+    {0x01A8, 0x01A8, 0xFFFF, 1}, {0x01AD, 0x01AD, 0xFFFF, 1}, {0x01B0, 0x01B0, 0xFFFF, 1},
+    {0x01B4, 0x01B6, 0xFFFF, 2}, {0x01B9, 0x01B9, 0xFFFF, 1}, {0x01BD, 0x01BD, 0xFFFF, 1},
+    {0x01BF, 0x01BF, 0x0038, 1}, {0x01C5, 0x01C5, 0xFFFF, 1}, {0x01C6, 0x01C6, 0xFFFE, 1},
+    {0x01C8, 0x01C8, 0xFFFF, 1}, {0x01C9, 0x01C9, 0xFFFE, 1}, {0x01CB, 0x01CB, 0xFFFF, 1},
+    {0x01CC, 0x01CC, 0xFFFE, 1}, {0x01CE, 0x01DC, 0xFFFF, 2}, {0x01DD, 0x01DD, 0xFFB1, 1},
+    {0x01DF, 0x01EF, 0xFFFF, 2}, {0x01F2, 0x01F2, 0xFFFF, 1}, {0x01F3, 0x01F3, 0xFFFE, 1},
+    {0x01F5, 0x01F5, 0xFFFF, 1}, {0x01F9, 0x021F, 0xFFFF, 2}, {0x0223, 0x0233, 0xFFFF, 2},
+    {0x023C, 0x023C, 0xFFFF, 1}, {0x023F, 0x0240, 0x2A3F, 1}, {0x0242, 0x0242, 0xFFFF, 1},
+    {0x0247, 0x024F, 0xFFFF, 2}, {0x0250, 0x0250, 0x2A1F, 1}, {0x0251, 0x0251, 0x2A1C, 1},
+    {0x0252, 0x0252, 0x2A1E, 1}, {0x0253, 0x0253, 0xFF2E, 1}, {0x0254, 0x0254, 0xFF32, 1},
+    {0x0256, 0x0257, 0xFF33, 1}, {0x0259, 0x0259, 0xFF36, 1}, {0x025B, 0x025B, 0xFF35, 1},
+    {0x025C, 0x025C, 0xA54F, 1}, {0x0260, 0x0260, 0xFF33, 1}, {0x0261, 0x0261, 0xA54B, 1},
+    {0x0263, 0x0263, 0xFF31, 1}, {0x0265, 0x0265, 0xA528, 1}, {0x0266, 0x0266, 0xA544, 1},
+    {0x0268, 0x0268, 0xFF2F, 1}, {0x0269, 0x0269, 0xFF2D, 1}, {0x026A, 0x026A, 0xA544, 1},
+    {0x026B, 0x026B, 0x29F7, 1}, {0x026C, 0x026C, 0xA541, 1}, {0x026F, 0x026F, 0xFF2D, 1},
+    {0x0271, 0x0271, 0x29FD, 1}, {0x0272, 0x0272, 0xFF2B, 1}, {0x0275, 0x0275, 0xFF2A, 1},
+    {0x027D, 0x027D, 0x29E7, 1}, {0x0280, 0x0280, 0xFF26, 1}, {0x0282, 0x0282, 0xA543, 1},
+    {0x0283, 0x0283, 0xFF26, 1}, {0x0287, 0x0287, 0xA52A, 1}, {0x0288, 0x0288, 0xFF26, 1},
+    {0x0289, 0x0289, 0xFFBB, 1}, {0x028A, 0x028B, 0xFF27, 1}, {0x028C, 0x028C, 0xFFB9, 1},
+    {0x0292, 0x0292, 0xFF25, 1}, {0x029D, 0x029D, 0xA515, 1}, {0x029E, 0x029E, 0xA512, 1},
+    {0x0345, 0x0345, 0x0054, 1}, {0x0371, 0x0373, 0xFFFF, 2}, {0x0377, 0x0377, 0xFFFF, 1},
+    {0x037B, 0x037D, 0x0082, 1}, {0x03AC, 0x03AC, 0xFFDA, 1}, {0x03AD, 0x03AF, 0xFFDB, 1},
+    {0x03B1, 0x03C1, 0xFFE0, 1}, {0x03C2, 0x03C2, 0xFFE1, 1}, {0x03C3, 0x03CB, 0xFFE0, 1},
+    {0x03CC, 0x03CC, 0xFFC0, 1}, {0x03CD, 0x03CE, 0xFFC1, 1}, {0x03D0, 0x03D0, 0xFFC2, 1},
+    {0x03D1, 0x03D1, 0xFFC7, 1}, {0x03D5, 0x03D5, 0xFFD1, 1}, {0x03D6, 0x03D6, 0xFFCA, 1},
+    {0x03D7, 0x03D7, 0xFFF8, 1}, {0x03D9, 0x03EF, 0xFFFF, 2}, {0x03F0, 0x03F0, 0xFFAA, 1},
+    {0x03F1, 0x03F1, 0xFFB0, 1}, {0x03F2, 0x03F2, 0x0007, 1}, {0x03F3, 0x03F3, 0xFF8C, 1},
+    {0x03F5, 0x03F5, 0xFFA0, 1}, {0x03F8, 0x03F8, 0xFFFF, 1}, {0x03FB, 0x03FB, 0xFFFF, 1},
+    {0x0430, 0x044F, 0xFFE0, 1}, {0x0450, 0x045F, 0xFFB0, 1}, {0x0461, 0x0481, 0xFFFF, 2},
+    {0x048B, 0x04BF, 0xFFFF, 2}, {0x04C2, 0x04CE, 0xFFFF, 2}, {0x04CF, 0x04CF, 0xFFF1, 1},
+    {0x04D1, 0x052F, 0xFFFF, 2}, {0x0561, 0x0586, 0xFFD0, 1}, {0x10D0, 0x10FA, 0x0BC0, 1},
+    {0x10FD, 0x10FF, 0x0BC0, 1}, {0x13F8, 0x13FD, 0xFFF8, 1}, {0x1C80, 0x1C80, 0xE792, 1},
+    {0x1C81, 0x1C81, 0xE793, 1}, {0x1C82, 0x1C82, 0xE79C, 1}, {0x1C83, 0x1C84, 0xE79E, 1},
+    {0x1C85, 0x1C85, 0xE79D, 1}, {0x1C86, 0x1C86, 0xE7A4, 1}, {0x1C87, 0x1C87, 0xE7DB, 1},
+    {0x1C88, 0x1C88, 0x89C2, 1}, {0x1D79, 0x1D79, 0x8A04, 1}, {0x1D7D, 0x1D7D, 0x0EE6, 1},
+    {0x1D8E, 0x1D8E, 0x8A38, 1}, {0x1E01, 0x1E95, 0xFFFF, 2}, {0x1E9B, 0x1E9B, 0xFFC5, 1},
+    {0x1EA1, 0x1EFF, 0xFFFF, 2}, {0x1F00, 0x1F07, 0x0008, 1}, {0x1F10, 0x1F15, 0x0008, 1},
+    {0x1F20, 0x1F27, 0x0008, 1}, {0x1F30, 0x1F37, 0x0008, 1}, {0x1F40, 0x1F45, 0x0008, 1},
+    {0x1F51, 0x1F57, 0x0008, 2}, {0x1F60, 0x1F67, 0x0008, 1}, {0x1F70, 0x1F71, 0x004A, 1},
+    {0x1F72, 0x1F75, 0x0056, 1}, {0x1F76, 0x1F77, 0x0064, 1}, {0x1F78, 0x1F79, 0x0080, 1},
+    {0x1F7A, 0x1F7B, 0x0070, 1}, {0x1F7C, 0x1F7D, 0x007E, 1}, {0x1FB0, 0x1FB1, 0x0008, 1},
+    {0x1FBE, 0x1FBE, 0xE3DB, 1}, {0x1FD0, 0x1FD1, 0x0008, 1}, {0x1FE0, 0x1FE1, 0x0008, 1},
+    {0x1FE5, 0x1FE5, 0x0007, 1}, {0x214E, 0x214E, 0xFFE4, 1}, {0x2170, 0x217F, 0xFFF0, 1},
+    {0x2184, 0x2184, 0xFFFF, 1}, {0x24D0, 0x24E9, 0xFFE6, 1}, {0x2C30, 0x2C5F, 0xFFD0, 1},
+    {0x2C61, 0x2C61, 0xFFFF, 1}, {0x2C65, 0x2C65, 0xD5D5, 1}, {0x2C66, 0x2C66, 0xD5D8, 1},
+    {0x2C68, 0x2C6C, 0xFFFF, 2}, {0x2C73, 0x2C73, 0xFFFF, 1}, {0x2C76, 0x2C76, 0xFFFF, 1},
+    {0x2C81, 0x2CE3, 0xFFFF, 2}, {0x2CEC, 0x2CEE, 0xFFFF, 2}, {0x2CF3, 0x2CF3, 0xFFFF, 1},
+    {0x2D00, 0x2D25, 0xE3A0, 1}, {0x2D27, 0x2D27, 0xE3A0, 1}, {0x2D2D, 0x2D2D, 0xE3A0, 1},
+    {0xA641, 0xA66D, 0xFFFF, 2}, {0xA681, 0xA69B, 0xFFFF, 2}, {0xA723, 0xA72F, 0xFFFF, 2},
+    {0xA733, 0xA76F, 0xFFFF, 2}, {0xA77A, 0xA77C, 0xFFFF, 2}, {0xA77F, 0xA787, 0xFFFF, 2},
+    {0xA78C, 0xA78C, 0xFFFF, 1}, {0xA791, 0xA793, 0xFFFF, 2}, {0xA794, 0xA794, 0x0030, 1},
+    {0xA797, 0xA7A9, 0xFFFF, 2}, {0xA7B5, 0xA7C3, 0xFFFF, 2}, {0xA7C8, 0xA7CA, 0xFFFF, 2},
+    {0xA7D1, 0xA7D1, 0xFFFF, 1}, {0xA7D7, 0xA7D9, 0xFFFF, 2}, {0xA7F6, 0xA7F6, 0xFFFF, 1},
+    {0xAB53, 0xAB53, 0xFC60, 1}, {0xAB70, 0xABBF, 0x6830, 1}, {0xFF41, 0xFF5A, 0xFFE0, 1},
+};
+
+
+/** \brief Fold code unit to uppercase.
+ *
+ *  ASCII is folded directly, and other code units use the invariant
+ *  simple uppercase mapping, independent of the locale.
+ */
+WideUnit foldCase(const wchar_t c)
+{
+    const WideUnit unit = static_cast<WideUnit>(c);
+    if (unit < 0x80) {
+        return static_cast<WideUnit>(unit - 'a') < 26 ? unit - 0x20 : unit;
+    } else if (unit > 0xFFFF) {
+        return unit;
+    }
+
+    auto first = std::begin(UPPER_RANGES);
+    auto last = std::end(UPPER_RANGES);
+    auto range = std::upper_bound(first, last, unit, [](const WideUnit value, const UpperRange &item) {
+        return value < item.first;
+    });
+    if (range == first) {
+        return unit;
+    }
+    --range;
+    if (unit <= range->last && (unit - range->first) % range->stride == 0) {
+        return static_cast<uint16_t>(unit + range->delta);
+    }
+
+    return unit;
+}
+
+
+/** \brief Fold code units to uppercase.
+ */
+void foldCase(const wchar_t *src,
+    const size_t length,
+    wchar_t *dst)
+{
+    size_t ascii = 0;
+    if (sizeof(wchar_t) == 2) {
+        auto first = reinterpret_cast<const uint16_t*>(src);
+        auto last = first + length;
+        utf::simd::upperAscii(first, last, reinterpret_cast<uint16_t*>(dst));
+        ascii = utf::simd::asciiLength(first, last);
+    }
+    for (size_t i = ascii; i < length; ++i) {
+        dst[i] = static_cast<wchar_t>(foldCase(src[i]));
+    }
+}
+
+
+/** \brief Compare code units, ignoring case.
+ */
+int compareNoCase(const wchar_t *left,
+    const size_t leftLength,
+    const wchar_t *right,
+    const size_t rightLength)
+{
+    const size_t length = std::min(leftLength, rightLength);
+    size_t i = 0;
+    while (i < length) {
+        if (sizeof(wchar_t) == 2) {
+            auto l = reinterpret_cast<const uint16_t*>(left);
+            auto r = reinterpret_cast<const uint16_t*>(right);
+            i += utf::simd::mismatchNoCase(l + i, r + i, length - i);
+            if (i == length) {
+                break;
+            }
+        }
+        const WideUnit l = foldCase(left[i]);
+        const WideUnit r = foldCase(right[i]);
+        if (l != r) {
+            return l < r ? -1 : 1;
+        }
+        ++i;
+    }
+
+    if (leftLength != rightLength) {
+        return leftLength < rightLength ? -1 : 1;
+    }
+
+    return 0;
+}
+
+
+/** \brief Rotate bits left.
+ */
+inline uint64_t rotateLeft(const uint64_t value,
+    const int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+
+/** \brief Read unaligned 64-bit word.
+ */
+inline uint64_t read64(const uint8_t *data)
+{
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+
+/** \brief Read unaligned 32-bit word.
+ */
+inline uint32_t read32(const uint8_t *data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+
+/** \brief Mix word into hash lane.
+ */
+inline uint64_t hashRound(uint64_t lane,
+    const uint64_t word)
+{
+    lane += word * HASH_PRIME2;
+    lane = rotateLeft(lane, 31);
+    return lane * HASH_PRIME1;
+}
+
+
+/** \brief Streaming XXH64 hash of UTF-16 payloads.
+ *
+ *  Four independent lanes consume 32-byte stripes, so long strings
+ *  hash at several bytes per cycle, while short strings skip
+ *  straight to the tail.
+ */
+struct WideHash
+{
+    uint64_t lanes[4] = {HASH_PRIME1 + HASH_PRIME2, HASH_PRIME2, 0, 0 - HASH_PRIME1};
+    uint64_t total = 0;
+
+    void update(const uint8_t *data,
+        const size_t length);
+    uint64_t finish(const uint8_t *data,
+        size_t length);
+};
+
+
+/** \brief Hash all whole 32-byte stripes of data.
+ *
+ *  \warning Any partial stripe must be passed to finish.
+ */
+void WideHash::update(const uint8_t *data,
+    const size_t length)
+{
+    const uint8_t *last = data + length / 32 * 32;
+    for (; data < last; data += 32) {
+        lanes[0] = hashRound(lanes[0], read64(data));
+        lanes[1] = hashRound(lanes[1], read64(data + 8));
+        lanes[2] = hashRound(lanes[2], read64(data + 16));
+        lanes[3] = hashRound(lanes[3], read64(data + 24));
+    }
+    total += length / 32 * 32;
+}
+
+
+/** \brief Hash the remaining data and get the digest.
+ */
+uint64_t WideHash::finish(const uint8_t *data,
+    size_t length)
+{
+    update(data, length);
+    data += length / 32 * 32;
+    length %= 32;
+    total += length;
+
+    uint64_t hash;
+    if (total >= 32) {
+        hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+        for (uint64_t lane: lanes) {
+            hash ^= hashRound(0, lane);
+            hash = hash * HASH_PRIME1 + HASH_PRIME4;
+        }
+    } else {
+        hash = HASH_PRIME5;
+    }
+    hash += total;
+
+    for (; length >= 8; data += 8, length -= 8) {
+        hash ^= hashRound(0, read64(data));
+        hash = rotateLeft(hash, 27) * HASH_PRIME1 + HASH_PRIME4;
+    }
+    if (length >= 4) {
+        hash ^= read32(data) * HASH_PRIME1;
+        hash = rotateLeft(hash, 23) * HASH_PRIME2 + HASH_PRIME3;
+        data += 4;
+        length -= 4;
+    }
+    for (; length; ++data, --length) {
+        hash ^= *data * HASH_PRIME5;
+        hash = rotateLeft(hash, 11) * HASH_PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= HASH_PRIME3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+// FUNCTIONS
+// ---------
+
+
+/** \brief Convert UTF-8 character array directly to a new BSTR.
+ *
+ *  Allocates the BSTR at its exact UTF-16 length and transcodes into
+ *  it, without an intermediate std::wstring.
+ */
+BSTR WIDE_BSTR(const char *narrow,
+    const size_t length)
+{
+    const size_t size = WIDE_LENGTH(narrow, length);
+    BSTR bstr = ALLOC_BSTR(nullptr, size);
+    if (!bstr) {
+        throw std::bad_alloc();
+    }
+
+    try {
+        WIDE_EXACT(narrow, length, bstr, size);
+    } catch (...) {
+        FREE_BSTR(bstr);
+        throw;
+    }
+
+    return bstr;
+}
+
+
+/** \brief Convert UTF-8 directly to a new BSTR.
+ */
+BSTR WIDE_BSTR(const std::string &narrow)
+{
+    return WIDE_BSTR(narrow.data(), narrow.size());
+}
+
 // OBJECTS
 // -------
 
@@ -68,7 +437,7 @@ Bstr::~Bstr()
 /** \brief Copy constructor.
  */
 Bstr::Bstr(const BSTR &other):
-    string(SysAllocStringLen(other, SysStringLen(other)))
+    string(ALLOC_BSTR(other, SysStringLen(other)))
 {}
 
 
@@ -77,7 +446,7 @@ Bstr::Bstr(const BSTR &other):
 Bstr & Bstr::operator=(const BSTR &other)
 {
     clear();
-    string = SysAllocStringLen(other, SysStringLen(other));
+    string = ALLOC_BSTR(other, SysStringLen(other));
     return *this;
 }
 
@@ -104,17 +473,15 @@ Bstr & Bstr::operator=(BSTR &&other)
 
 /** \brief Initialize string from narrow string.
  */
-Bstr::Bstr(const std::string &string)
-{
-    auto wide = WIDE(string);
-    this->string = SysAllocStringLen(wide.data(), wide.size());
-}
+Bstr::Bstr(const std::string &string):
+    string(WIDE_BSTR(string))
+{}
 
 
 /** \brief Initialize string from wide string.
  */
 Bstr::Bstr(const std::wstring &string):
-    string(SysAllocStringLen(string.data(), string.size()))
+    string(ALLOC_BSTR(string.data(), string.size()))
 {}
 
 
@@ -129,29 +496,25 @@ Bstr::Bstr(VARIANT &variant)
 
 /** \brief Initialize string from narrow C-string.
  */
-Bstr::Bstr(const char *cstring)
-{
-    auto wide = WIDE(std::string(cstring));
-    this->string = SysAllocStringLen(wide.data(), wide.size());
-}
+Bstr::Bstr(const char *cstring):
+    string(WIDE_BSTR(cstring, strlen(cstring)))
+{}
 
 
 /** \brief Initialize string from wide C-string.
  */
 Bstr::Bstr(const wchar_t *cstring)
 {
-    this->string = SysAllocStringLen(cstring, wcslen(cstring));
+    this->string = ALLOC_BSTR(cstring, wcslen(cstring));
 }
 
 
 /** \brief Initialize string from narrow character array.
  */
 Bstr::Bstr(const char *array,
-    const size_t length)
-{
-    auto wide = WIDE(std::string(array, length));
-    this->string = SysAllocStringLen(wide.data(), wide.size());
-}
+    const size_t length):
+    string(WIDE_BSTR(array, length))
+{}
 
 
 /** \brief Initialize string from wide character array.
@@ -159,7 +522,7 @@ Bstr::Bstr(const char *array,
 Bstr::Bstr(const wchar_t *array,
         const size_t length)
 {
-    this->string = SysAllocStringLen(array, length);
+    this->string = ALLOC_BSTR(array, length);
 }
 
 
@@ -296,7 +659,7 @@ size_t Bstr::length() const
 void Bstr::clear()
 {
     if (string) {
-        SysFreeString(string);
+        FREE_BSTR(string);
         string = nullptr;
     }
 }
@@ -385,7 +748,7 @@ auto Bstr::back() const
 BSTR Bstr::copy() const
 {
     if (string) {
-        return SysAllocStringLen(string, SysStringLen(string));
+        return ALLOC_BSTR(string, SysStringLen(string));
     }
 
     return nullptr;
@@ -399,7 +762,7 @@ void Bstr::push_back(const wchar_t c)
     std::wstring wide(string, size());
     wide.push_back(c);
     clear();
-    string = SysAllocStringLen(wide.data(), wide.size());
+    string = ALLOC_BSTR(wide.data(), wide.size());
 }
 
 
@@ -435,6 +798,52 @@ void Bstr::reset(VARIANT &variant)
 }
 
 
+/** \brief Release ownership of the BSTR, without a copy.
+ *
+ *  The caller owns the result, for instance to hand it to COM as an
+ *  out-parameter or a VT_BSTR value.
+ */
+BSTR Bstr::release()
+{
+    BSTR bstr = string;
+    string = nullptr;
+    return bstr;
+}
+
+
+/** \brief Transcode UTF-8 into the BSTR, reusing its storage if possible.
+ *
+ *  The UTF-16 length is computed up-front, and narrow is transcoded
+ *  directly into a BSTR of that length, with no intermediate
+ *  std::wstring. If the current BSTR is long enough, it is truncated
+ *  in place rather than reallocated.
+ */
+Bstr & Bstr::fromUtf8Into(const char *narrow,
+    const size_t length)
+{
+    const size_t size = WIDE_LENGTH(narrow, length);
+    if (!string || SysStringLen(string) < size) {
+        clear();
+        string = ALLOC_BSTR(nullptr, size);
+        if (!string) {
+            throw std::bad_alloc();
+        }
+    }
+    WIDE_EXACT(narrow, length, string, size);
+    TRUNCATE_BSTR(string, size);
+
+    return *this;
+}
+
+
+/** \brief Transcode UTF-8 into the BSTR, reusing its storage if possible.
+ */
+Bstr & Bstr::fromUtf8Into(const std::string &narrow)
+{
+    return fromUtf8Into(narrow.data(), narrow.size());
+}
+
+
 /** \brief Get BSTR data.
  */
 BSTR & Bstr::data()
@@ -459,6 +868,22 @@ Bstr::operator bool() const
 }
 
 
+/** \brief Compare code units with another string.
+ */
+int Bstr::compare(const BstrView &other) const
+{
+    return BstrView(*this).compare(other);
+}
+
+
+/** \brief Compare code units with another string, ignoring case.
+ */
+int Bstr::compareNoCase(const BstrView &other) const
+{
+    return BstrView(*this).compareNoCase(other);
+}
+
+
 /** \brief Convert type to BSTR.
  */
 Bstr::operator BSTR()
@@ -476,71 +901,904 @@ Bstr::operator BSTR() const
 
 
 /** \brief Convert type explicitly to narrow string.
+ *
+ *  Transcodes on every call, use ShadowBstr for repeated access.
  */
 Bstr::operator std::string() const
 {
-    return NARROW(std::wstring(string, size()));
+    return NARROW(string, size());
 }
 
 
-/** \brief Equality operator.
+/** \brief Grow buffer geometrically, to at least `minimum` characters.
  */
-bool operator==(const Bstr &left,
-    const Bstr &right)
+void BstrBuilder::grow(const size_t minimum)
 {
-    if (left.size() == right.size()) {
-        auto l = left.cbegin();
-        auto r = right.cbegin();
-        while (l != left.cend()) {
-            if (*l++ != *r++) {
-                return false;
-            }
-        }
-        return true;
+    reserve(std::max(minimum, std::max<size_t>(16, reserved * 2)));
+}
+
+
+/** \brief Move constructor.
+ */
+BstrBuilder::BstrBuilder(BstrBuilder &&other)
+{
+    std::swap(string, other.string);
+    std::swap(count, other.count);
+    std::swap(reserved, other.reserved);
+}
+
+
+/** \brief Move asignment operator.
+ */
+BstrBuilder & BstrBuilder::operator=(BstrBuilder &&other)
+{
+    std::swap(string, other.string);
+    std::swap(count, other.count);
+    std::swap(reserved, other.reserved);
+    return *this;
+}
+
+
+/** \brief Destructor.
+ */
+BstrBuilder::~BstrBuilder()
+{
+    FREE_BSTR(string);
+}
+
+
+/** \brief Initialize builder with reserved capacity.
+ */
+BstrBuilder::BstrBuilder(const size_t capacity)
+{
+    reserve(capacity);
+}
+
+
+/** \brief Get number of characters appended.
+ */
+size_t BstrBuilder::size() const
+{
+    return count;
+}
+
+
+/** \brief Get number of characters which fit without reallocating.
+ */
+size_t BstrBuilder::capacity() const
+{
+    return reserved;
+}
+
+
+/** \brief Check if no characters have been appended.
+ */
+bool BstrBuilder::empty() const
+{
+    return count == 0;
+}
+
+
+/** \brief Reserve space for at least `capacity` characters.
+ *
+ *  SysReAllocStringLen does not guarantee the characters survive a
+ *  null source, so the appended characters are copied explicitly.
+ */
+void BstrBuilder::reserve(const size_t capacity)
+{
+    if (capacity <= reserved) {
+        return;
     }
 
-    return false;
+    BSTR buffer = ALLOC_BSTR(nullptr, capacity);
+    if (!buffer) {
+        throw std::bad_alloc();
+    }
+    if (string) {
+        std::copy(string, string + count, buffer);
+        FREE_BSTR(string);
+    }
+    string = buffer;
+    reserved = capacity;
 }
 
 
-/** \brief Inequality operator.
+/** \brief Remove all characters, keeping the buffer.
  */
-bool operator!=(const Bstr &left,
-    const Bstr &right)
+void BstrBuilder::clear()
 {
-    return !(left == right);
+    count = 0;
 }
 
 
-/** \brief Print to ostream.
+/** \brief Get pointer to appended characters.
+ *
+ *  \warning The characters are not null-terminated until release().
  */
-std::ostream & operator<<(std::ostream &os,
-    const Bstr &string)
+const wchar_t * BstrBuilder::data() const
 {
-    os << std::string(string);
-    return os;
+    return string;
 }
 
 
-/** \brief Print to wostream.
+/** \brief Append character.
  */
-std::wostream & operator<<(std::wostream &os,
-    const Bstr &string)
+BstrBuilder & BstrBuilder::push_back(const wchar_t c)
 {
-    os << std::wstring(string.string, string.size());
-    return os;
+    if (count == reserved) {
+        grow(count + 1);
+    }
+    string[count++] = c;
+
+    return *this;
 }
 
 
-/** \brief Swap left and right strings.
+/** \brief Append character.
  */
-void swap(Bstr &left,
-    Bstr &right)
+BstrBuilder & BstrBuilder::append(const wchar_t c)
 {
-    std::swap(left.string, right.string);
+    return push_back(c);
 }
 
-}   /* autocom */
+
+/** \brief Append wide character array.
+ */
+BstrBuilder & BstrBuilder::append(const wchar_t *array,
+    const size_t length)
+{
+    if (count + length > reserved) {
+        grow(count + length);
+    }
+    std::copy(array, array + length, string + count);
+    count += length;
+
+    return *this;
+}
+
+
+/** \brief Append wide C-string.
+ */
+BstrBuilder & BstrBuilder::append(const wchar_t *cstring)
+{
+    return append(cstring, wcslen(cstring));
+}
+
+
+/** \brief Append wide string.
+ */
+BstrBuilder & BstrBuilder::append(const std::wstring &wide)
+{
+    return append(wide.data(), wide.size());
+}
+
+
+/** \brief Append BSTR wrapper.
+ */
+BstrBuilder & BstrBuilder::append(const Bstr &bstr)
+{
+    return append(bstr.cbegin(), bstr.size());
+}
+
+
+/** \brief Append UTF-8 character array, transcoding in place.
+ */
+BstrBuilder & BstrBuilder::append(const char *array,
+    const size_t length)
+{
+    const size_t size = WIDE_LENGTH(array, length);
+    if (count + size > reserved) {
+        grow(count + size);
+    }
+    count += WIDE_EXACT(array, length, string + count, size);
+
+    return *this;
+}
+
+
+/** \brief Append UTF-8 C-string.
+ */
+BstrBuilder & BstrBuilder::append(const char *cstring)
+{
+    return append(cstring, strlen(cstring));
+}
+
+
+/** \brief Append UTF-8 string.
+ */
+BstrBuilder & BstrBuilder::append(const std::string &narrow)
+{
+    return append(narrow.data(), narrow.size());
+}
+
+
+/** \brief Finalize and release the BSTR, which the caller owns.
+ *
+ *  Shrinking the BSTR to its size only rewrites the length prefix and
+ *  terminator, the characters are not copied. The builder is empty
+ *  afterwards.
+ */
+BSTR BstrBuilder::release()
+{
+    if (string) {
+        TRUNCATE_BSTR(string, count);
+    }
+
+    BSTR bstr = string;
+    string = nullptr;
+    count = 0;
+    reserved = 0;
+
+    return bstr;
+}
+
+
+/** \brief Finalize into a BSTR wrapper.
+ */
+Bstr BstrBuilder::str()
+{
+    return Bstr(release());
+}
+
+
+constexpr size_t BstrView::npos;
+
+
+/** \brief Initialize view from BSTR wrapper.
+ */
+BstrView::BstrView(const Bstr &bstr):
+    BstrView(bstr.string)
+{}
+
+
+/** \brief Initialize view from BSTR, using its length prefix.
+ */
+BstrView::BstrView(const BSTR &bstr):
+    string(bstr ? bstr : L""),
+    count(SysStringLen(bstr))
+{}
+
+
+/** \brief Initialize view from wide string.
+ */
+BstrView::BstrView(const std::wstring &wide):
+    string(wide.c_str()),
+    count(wide.size())
+{}
+
+
+/** \brief Initialize view from wide C-string.
+ */
+BstrView::BstrView(const wchar_t *cstring):
+    string(cstring),
+    count(wcslen(cstring))
+{}
+
+
+/** \brief Initialize view from wide character array.
+ *
+ *  The array is not assumed to be null-terminated.
+ */
+BstrView::BstrView(const wchar_t *array,
+        const size_t length):
+    string(array),
+    count(length),
+    terminator(false)
+{}
+
+
+/** \brief Initialize view from BSTR held by VARIANT, or by reference.
+ */
+BstrView::BstrView(const VARIANT &variant)
+{
+    if (variant.vt == VT_BSTR) {
+        *this = BstrView(variant.bstrVal);
+    } else if (variant.vt == (VT_BSTR | VT_BYREF)) {
+        *this = BstrView(*variant.pbstrVal);
+    } else {
+        throw std::runtime_error("VARIANT does not hold a BSTR");
+    }
+}
+
+
+/** \brief Get iterator at beginning of string.
+ */
+auto BstrView::begin() const noexcept
+    -> const_iterator
+{
+    return string;
+}
+
+
+/** \brief Get iterator past end of string.
+ */
+auto BstrView::end() const noexcept
+    -> const_iterator
+{
+    return string + count;
+}
+
+
+/** \brief Get iterator at beginning of string.
+ */
+auto BstrView::cbegin() const noexcept
+    -> const_iterator
+{
+    return begin();
+}
+
+
+/** \brief Get iterator past end of string.
+ */
+auto BstrView::cend() const noexcept
+    -> const_iterator
+{
+    return end();
+}
+
+
+/** \brief Get iterator at reverse beginning of string.
+ */
+auto BstrView::rbegin() const noexcept
+    -> const_reverse_iterator
+{
+    return const_reverse_iterator(end());
+}
+
+
+/** \brief Get iterator past reverse end of string.
+ */
+auto BstrView::rend() const noexcept
+    -> const_reverse_iterator
+{
+    return const_reverse_iterator(begin());
+}
+
+
+/** \brief Get iterator at reverse beginning of string.
+ */
+auto BstrView::crbegin() const noexcept
+    -> const_reverse_iterator
+{
+    return rbegin();
+}
+
+
+/** \brief Get iterator past reverse end of string.
+ */
+auto BstrView::crend() const noexcept
+    -> const_reverse_iterator
+{
+    return rend();
+}
+
+
+/** \brief Get length of view.
+ */
+size_t BstrView::size() const
+{
+    return count;
+}
+
+
+/** \brief Get length of view.
+ */
+size_t BstrView::length() const
+{
+    return count;
+}
+
+
+/** \brief Check if view is empty.
+ */
+bool BstrView::empty() const
+{
+    return count == 0;
+}
+
+
+/** \brief Access character at index.
+ */
+auto BstrView::operator[](size_t position) const
+    -> const_reference
+{
+    return string[position];
+}
+
+
+/** \brief Access character at index.
+ */
+auto BstrView::at(size_t position) const
+    -> const_reference
+{
+    if (position >= count) {
+        throw std::out_of_range("Index is out of range");
+    }
+
+    return string[position];
+}
+
+
+/** \brief Get reference to first element in view.
+ */
+auto BstrView::front() const
+    -> const_reference
+{
+    assert(!empty() && "BstrView::front(): view is empty");
+    return string[0];
+}
+
+
+/** \brief Get reference to last element in view.
+ */
+auto BstrView::back() const
+    -> const_reference
+{
+    assert(!empty() && "BstrView::back(): view is empty");
+    return string[count - 1];
+}
+
+
+/** \brief Get pointer to first character.
+ */
+const wchar_t * BstrView::data() const
+{
+    return string;
+}
+
+
+/** \brief Check if data() is null-terminated at size().
+ *
+ *  Views of BSTRs, wide strings and C-strings are terminated, and can
+ *  be passed directly to APIs expecting an OLE string.
+ */
+bool BstrView::terminated() const
+{
+    return terminator;
+}
+
+
+/** \brief Get view of substring.
+ */
+BstrView BstrView::substr(size_t position,
+    size_t length) const
+{
+    if (position > count) {
+        throw std::out_of_range("Index is out of range");
+    }
+
+    length = std::min(length, count - position);
+    BstrView view(string + position, length);
+    view.terminator = terminator && position + length == count;
+
+    return view;
+}
+
+
+/** \brief Compare code units lexicographically.
+ */
+int BstrView::compare(const BstrView &other) const
+{
+    const size_t length = std::min(count, other.count);
+    const size_t i = mismatch(string, other.string, length);
+    if (i < length) {
+        return static_cast<WideUnit>(string[i]) < static_cast<WideUnit>(other.string[i]) ? -1 : 1;
+    } else if (count < other.count) {
+        return -1;
+    } else if (count > other.count) {
+        return 1;
+    }
+
+    return 0;
+}
+
+
+/** \brief Compare code units after folding to uppercase.
+ *
+ *  Ordinal, case-insensitive comparison, as COM uses for names.
+ */
+int BstrView::compareNoCase(const BstrView &other) const
+{
+    return autocom::compareNoCase(string, count, other.string, other.count);
+}
+
+
+/** \brief Find first position of character, or npos.
+ */
+size_t BstrView::find(const wchar_t c,
+    size_t position) const
+{
+    for (; position < count; ++position) {
+        if (string[position] == c) {
+            return position;
+        }
+    }
+
+    return npos;
+}
+
+
+/** \brief Find first position of substring, or npos.
+ */
+size_t BstrView::find(const BstrView &other,
+    size_t position) const
+{
+    if (position > count) {
+        return npos;
+    }
+
+    auto it = std::search(begin() + position, end(), other.begin(), other.end());
+    if (it == end() && !other.empty()) {
+        return npos;
+    }
+
+    return it - begin();
+}
+
+
+/** \brief Copy view to wide string.
+ */
+std::wstring BstrView::wstr() const
+{
+    return std::wstring(string, count);
+}
+
+
+/** \brief Convert view explicitly to narrow string.
+ */
+BstrView::operator std::string() const
+{
+    return NARROW(string, count);
+}
+
+
+/** \brief Copy string, transcoding lazily.
+ */
+ShadowBstr::ShadowBstr(const Bstr &bstr):
+    wide(bstr)
+{}
+
+
+/** \brief Adopt string, transcoding lazily.
+ */
+ShadowBstr::ShadowBstr(Bstr &&bstr):
+    wide(std::move(bstr))
+{}
+
+
+/** \brief Initialize from UTF-8, which is kept as the shadow.
+ */
+ShadowBstr::ShadowBstr(const std::string &string):
+    wide(string),
+    narrow(string),
+    cached(true)
+{}
+
+
+/** \brief Initialize from UTF-8, adopting its buffer as the shadow.
+ */
+ShadowBstr::ShadowBstr(std::string &&string):
+    wide(string),
+    narrow(std::move(string)),
+    cached(true)
+{}
+
+
+/** \brief Get length of the wide string.
+ */
+size_t ShadowBstr::size() const
+{
+    return wide.size();
+}
+
+
+/** \brief Check if string is empty.
+ */
+bool ShadowBstr::empty() const
+{
+    return wide.empty();
+}
+
+
+/** \brief Check if the UTF-8 shadow is populated.
+ */
+bool ShadowBstr::shadowed() const
+{
+    return cached;
+}
+
+
+/** \brief Get wide string.
+ */
+const Bstr & ShadowBstr::bstr() const
+{
+    return wide;
+}
+
+
+/** \brief Get BSTR data.
+ */
+const BSTR & ShadowBstr::data() const
+{
+    return wide.data();
+}
+
+
+/** \brief Get UTF-8 string, transcoding it on first use only.
+ */
+const std::string & ShadowBstr::str() const
+{
+    if (!cached) {
+        narrow = std::string(wide);
+        cached = true;
+    }
+
+    return narrow;
+}
+
+
+/** \brief Clear string and shadow.
+ */
+void ShadowBstr::reset()
+{
+    wide.clear();
+    narrow.clear();
+    cached = false;
+}
+
+
+/** \brief Adopt a new string, transcoding lazily.
+ */
+void ShadowBstr::reset(Bstr &&bstr)
+{
+    wide = std::move(bstr);
+    narrow.clear();
+    cached = false;
+}
+
+
+/** \brief Adopt a new UTF-8 string as the shadow.
+ */
+void ShadowBstr::reset(std::string &&string)
+{
+    wide.fromUtf8Into(string);
+    narrow = std::move(string);
+    cached = true;
+}
+
+
+/** \brief Release ownership of the BSTR, and drop the shadow.
+ */
+BSTR ShadowBstr::release()
+{
+    narrow.clear();
+    cached = false;
+    return wide.release();
+}
+
+
+/** \brief Convert to a view of the wide string.
+ */
+ShadowBstr::operator BstrView() const
+{
+    return BstrView(wide);
+}
+
+
+/** \brief Hash code units after folding to uppercase.
+ *
+ *  Folds blocks into a stack buffer, so hashing allocates nothing.
+ */
+size_t BstrHashNoCase::operator()(const BstrView &view) const
+{
+    WideHash hash;
+    wchar_t buffer[FOLD_BLOCK];
+    const wchar_t *first = view.data();
+    size_t length = view.size();
+    while (length > FOLD_BLOCK) {
+        foldCase(first, FOLD_BLOCK, buffer);
+        hash.update(reinterpret_cast<const uint8_t*>(buffer), sizeof(buffer));
+        first += FOLD_BLOCK;
+        length -= FOLD_BLOCK;
+    }
+    foldCase(first, length, buffer);
+
+    return static_cast<size_t>(hash.finish(reinterpret_cast<const uint8_t*>(buffer), length * sizeof(wchar_t)));
+}
+
+
+/** \brief Check if strings are equal, ignoring case.
+ */
+bool BstrEqualNoCase::operator()(const BstrView &left,
+    const BstrView &right) const
+{
+    return left.size() == right.size() && left.compareNoCase(right) == 0;
+}
+
+
+/** \brief Check if left orders before right, ignoring case.
+ */
+bool BstrLessNoCase::operator()(const BstrView &left,
+    const BstrView &right) const
+{
+    return left.compareNoCase(right) < 0;
+}
+
+
+/** \brief Equality operator.
+ */
+bool operator==(const Bstr &left,
+    const Bstr &right)
+{
+    return BstrView(left) == BstrView(right);
+}
+
+
+/** \brief Inequality operator.
+ */
+bool operator!=(const Bstr &left,
+    const Bstr &right)
+{
+    return !(left == right);
+}
+
+
+/** \brief Less than operator, comparing code units.
+ */
+bool operator<(const Bstr &left,
+    const Bstr &right)
+{
+    return left.compare(right) < 0;
+}
+
+
+/** \brief Less than or equal to operator, comparing code units.
+ */
+bool operator<=(const Bstr &left,
+    const Bstr &right)
+{
+    return left.compare(right) <= 0;
+}
+
+
+/** \brief Greater than operator, comparing code units.
+ */
+bool operator>(const Bstr &left,
+    const Bstr &right)
+{
+    return left.compare(right) > 0;
+}
+
+
+/** \brief Greater than or equal to operator, comparing code units.
+ */
+bool operator>=(const Bstr &left,
+    const Bstr &right)
+{
+    return left.compare(right) >= 0;
+}
+
+
+/** \brief Print to ostream.
+ */
+std::ostream & operator<<(std::ostream &os,
+    const Bstr &string)
+{
+    // stream through a lazy UTF-8 view in small blocks, without
+    // converting a temporary copy of the whole string
+    char buffer[256];
+    size_t size = 0;
+    for (char c: utf::as_utf8(string)) {
+        buffer[size++] = c;
+        if (size == sizeof(buffer)) {
+            os.write(buffer, size);
+            size = 0;
+        }
+    }
+    os.write(buffer, size);
+
+    return os;
+}
+
+
+/** \brief Print to wostream.
+ */
+std::wostream & operator<<(std::wostream &os,
+    const Bstr &string)
+{
+    os << std::wstring(string.string, string.size());
+    return os;
+}
+
+
+/** \brief Swap left and right strings.
+ */
+void swap(Bstr &left,
+    Bstr &right)
+{
+    std::swap(left.string, right.string);
+}
+
+
+/** \brief Equality operator.
+ */
+bool operator==(const BstrView &left,
+    const BstrView &right)
+{
+    return left.size() == right.size() && mismatch(left.data(), right.data(), left.size()) == left.size();
+}
+
+
+/** \brief Inequality operator.
+ */
+bool operator!=(const BstrView &left,
+    const BstrView &right)
+{
+    return !(left == right);
+}
+
+
+/** \brief Less than operator, comparing code units.
+ */
+bool operator<(const BstrView &left,
+    const BstrView &right)
+{
+    return left.compare(right) < 0;
+}
+
+
+/** \brief Less than or equal to operator, comparing code units.
+ */
+bool operator<=(const BstrView &left,
+    const BstrView &right)
+{
+    return left.compare(right) <= 0;
+}
+
+
+/** \brief Greater than operator, comparing code units.
+ */
+bool operator>(const BstrView &left,
+    const BstrView &right)
+{
+    return left.compare(right) > 0;
+}
+
+
+/** \brief Greater than or equal to operator, comparing code units.
+ */
+bool operator>=(const BstrView &left,
+    const BstrView &right)
+{
+    return left.compare(right) >= 0;
+}
+
+}   /* autocom */
+
+namespace std
+{
+// SPECIALIZATION
+// --------------
+
+
+/** \brief Hash the code units of a Bstr.
+ */
+size_t hash<autocom::Bstr>::operator()(const autocom::Bstr &bstr) const
+{
+    return hash<autocom::BstrView>()(bstr);
+}
+
+
+/** \brief Hash the code units of a BstrView with XXH64.
+ */
+size_t hash<autocom::BstrView>::operator()(const autocom::BstrView &view) const
+{
+    autocom::WideHash hash;
+    auto data = reinterpret_cast<const uint8_t*>(view.data());
+    return static_cast<size_t>(hash.finish(data, view.size() * sizeof(wchar_t)));
+}
+
+}   /* std */
 
 #ifdef _MSC_VER
 #   pragma warning(pop)
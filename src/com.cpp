@@ -9,6 +9,8 @@
 #include "autocom/encoding/converters.hpp"
 #include "autocom/util/exception.hpp"
 
+#include <memory>
+#include <stdexcept>
 #include <thread>
 
 
@@ -55,14 +57,44 @@ void uninitialize()
 // -------
 
 
-/** \brief Get dispatch identifier from function identifier.
+/** \brief Get the DISPID cache, creating it on first use.
+ *
+ *  Copies call this before copying, so a cache created by any copy
+ *  is shared by all of them. The cache is published atomically, so
+ *  copying a const object from several threads is safe.
  */
-Function DispatchBase::getFunction(const Bstr &name)
+DispidCachePtr DispatchBase::sharedCache() const
+{
+    DispidCachePtr current = std::atomic_load(&cache);
+    if (!current && ppv) {
+        DispidCachePtr created = newDispidCache(ppv.get());
+        if (std::atomic_compare_exchange_strong(&cache, &current, created)) {
+            current = std::move(created);
+        }
+    }
+
+    return current;
+}
+
+
+/** \brief Get dispatch identifier from the object, bypassing the cache.
+ *
+ *  GetIDsOfNames only needs a null-terminated OLE string, so only
+ *  views which are not null-terminated are copied.
+ */
+Function DispatchBase::lookupFunction(const BstrView &name)
 {
+    std::wstring copy;
+    const wchar_t *data = name.data();
+    if (!name.terminated()) {
+        copy = name.wstr();
+        data = copy.c_str();
+    }
+
     DISPID id;
     WORD flags = DISPATCH_METHOD;
     LCID locale = LOCALE_USER_DEFAULT;
-    LPOLESTR string = const_cast<wchar_t*>(name.data());
+    LPOLESTR string = const_cast<wchar_t*>(data);
     if (FAILED(ppv->GetIDsOfNames(IID_NULL, &string, flags, locale, &id))) {
         throw ComMethodError("IDispatch", "GetIDsOfNames(IID_NULL, ...)");
     }
@@ -71,6 +103,87 @@ Function DispatchBase::getFunction(const Bstr &name)
 }
 
 
+/** \brief Get dispatch identifier from function identifier.
+ */
+Function DispatchBase::getFunction(const Bstr &name)
+{
+    return getFunction(BstrView(name));
+}
+
+
+/** \brief Get dispatch identifier from a viewed function name.
+ *
+ *  Names are resolved once per cache, so later calls by name cost
+ *  the same as calls by DISPID. The cache is created on the first
+ *  lookup or copy, so handles only used by DISPID, such as items
+ *  from an enumerator, never allocate one. The cache is only read
+ *  through sharedCache(), since copies may publish it concurrently.
+ *
+ *  \throw std::runtime_error  The handle is null.
+ */
+Function DispatchBase::getFunction(const BstrView &name)
+{
+    DispidCachePtr current = sharedCache();
+    if (!current) {
+        throw std::runtime_error("Cannot look up names, IDispatch is null.");
+    }
+
+    DISPID id;
+    if (current->find(name, id)) {
+        return id;
+    }
+
+    id = lookupFunction(name);
+    current->insert(name, id);
+
+    return id;
+}
+
+
+/** \brief Get dispatch identifier from wide function name.
+ */
+Function DispatchBase::getFunction(const wchar_t *name)
+{
+    return getFunction(BstrView(name));
+}
+
+
+/** \brief Bind method by name, resolving the DISPID once.
+ */
+BoundMethod DispatchBase::bind(const BstrView &name,
+    const DispatchFlags flags)
+{
+    return BoundMethod(ppv, getFunction(name), flags);
+}
+
+
+/** \brief Bind method by function ID.
+ */
+BoundMethod DispatchBase::bind(const Function id,
+    const DispatchFlags flags)
+{
+    return BoundMethod(ppv, id, flags);
+}
+
+
+/** \brief Bind property by name, resolving the DISPID once.
+ */
+BoundProperty DispatchBase::bindProperty(const BstrView &name,
+    const DispatchFlags put)
+{
+    return BoundProperty(ppv, getFunction(name), put);
+}
+
+
+/** \brief Bind property by function ID.
+ */
+BoundProperty DispatchBase::bindProperty(const Function id,
+    const DispatchFlags put)
+{
+    return BoundProperty(ppv, id, put);
+}
+
+
 /** \brief Equality operator.
  */
 bool operator==(const DispatchBase &left,
@@ -89,6 +202,28 @@ bool operator!=(const DispatchBase &left,
 }
 
 
+/** \brief Copy constructor, sharing the DISPID cache.
+ */
+DispatchBase::DispatchBase(const DispatchBase &other):
+    ppv(other.ppv),
+    cache(other.sharedCache())
+{}
+
+
+/** \brief Copy assignment operator, sharing the DISPID cache.
+ */
+DispatchBase & DispatchBase::operator=(const DispatchBase &other)
+{
+    if (this != &other) {
+        DispidCachePtr shared = other.sharedCache();
+        ppv = other.ppv;
+        cache = std::move(shared);
+    }
+
+    return *this;
+}
+
+
 /** \brief Inherit dispatcher.
  */
 DispatchBase::DispatchBase(IDispatch *dispatch)
@@ -102,6 +237,7 @@ DispatchBase::DispatchBase(IDispatch *dispatch)
 void DispatchBase::open(IDispatch *dispatch)
 {
     ppv.reset(dispatch);
+    cache.reset();
 }
 
 
@@ -110,6 +246,19 @@ void DispatchBase::open(IDispatch *dispatch)
 void DispatchBase::reset()
 {
     ppv.reset();
+    cache.reset();
+}
+
+
+/** \brief Forget cached DISPIDs, for objects whose members can change.
+ *
+ *  Caches shared by type are cleared for every object of the type.
+ */
+void DispatchBase::invalidate()
+{
+    if (DispidCachePtr current = std::atomic_load(&cache)) {
+        current->clear();
+    }
 }
 
 
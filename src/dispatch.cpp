@@ -85,7 +85,7 @@ void Dispatch::open(const Guid &guid,
     if (FAILED(CoCreateInstance(guid.id, outter, context, IID_IDispatch, (void **) &dispatch))) {
         throw ComFunctionError("CoCreateInstance()");
     }
-    DispatchBase::ppv.reset(dispatch);
+    DispatchBase::open(dispatch);
 }
 
 
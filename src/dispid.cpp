@@ -0,0 +1,196 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoCOM
+ *  \brief Cached DISPID lookup for late-bound calls.
+ */
+
+#include "autocom/dispid.hpp"
+
+#include <dispex.h>
+
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+
+namespace autocom
+{
+// CONSTANTS
+// ---------
+
+std::atomic<bool> DISPID_BY_TYPE(false);
+
+// HELPERS
+// -------
+
+
+/** \brief Order GUIDs bytewise, for the per-type registry.
+ */
+struct GuidLess
+{
+    bool operator()(const GUID &left,
+        const GUID &right) const
+    {
+        return std::memcmp(&left, &right, sizeof(GUID)) < 0;
+    }
+};
+
+
+/** \brief Process-wide caches, by type GUID.
+ *
+ *  The registry is intentionally leaked, like the intern table, so
+ *  caches stay valid during static destruction.
+ */
+struct DispidRegistry
+{
+    std::mutex mutex;
+    std::map<GUID, DispidCachePtr, GuidLess> caches;
+};
+
+
+/** \brief Get the process-wide registry.
+ */
+DispidRegistry & dispidRegistry()
+{
+    static DispidRegistry *registry = new DispidRegistry;
+    return *registry;
+}
+
+
+/** \brief Read the GUID of the object's type.
+ *
+ *  \return     Type is known and has a non-null GUID.
+ */
+bool dispatchType(IDispatch *dispatch,
+    GUID &guid)
+{
+    UINT count = 0;
+    if (FAILED(dispatch->GetTypeInfoCount(&count)) || count == 0) {
+        return false;
+    }
+
+    ITypeInfo *info = nullptr;
+    if (FAILED(dispatch->GetTypeInfo(0, LOCALE_USER_DEFAULT, &info)) || !info) {
+        return false;
+    }
+
+    TYPEATTR *attr = nullptr;
+    bool known = false;
+    if (SUCCEEDED(info->GetTypeAttr(&attr)) && attr) {
+        guid = attr->guid;
+        known = guid != IID_NULL;
+        info->ReleaseTypeAttr(attr);
+    }
+    info->Release();
+
+    return known;
+}
+
+// OBJECTS
+// -------
+
+
+/** \brief Find cached DISPID by name.
+ *
+ *  \return     Name was cached.
+ */
+bool DispidCache::find(const BstrView &name,
+    DISPID &id) const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    auto it = ids.find(name);
+    if (it == ids.end()) {
+        return false;
+    }
+
+    id = it->second;
+    return true;
+}
+
+
+/** \brief Cache DISPID for name, copying the name once.
+ */
+void DispidCache::insert(const BstrView &name,
+    const DISPID id)
+{
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    if (ids.find(name) != ids.end()) {
+        return;
+    }
+
+    names.emplace_back(name.data(), name.size());
+    ids.emplace(BstrView(names.back()), id);
+}
+
+
+/** \brief Remove all cached DISPIDs.
+ */
+void DispidCache::clear()
+{
+    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    ids.clear();
+    names.clear();
+}
+
+
+/** \brief Get number of cached DISPIDs.
+ */
+size_t DispidCache::size() const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    return ids.size();
+}
+
+// FUNCTIONS
+// ---------
+
+
+/** \brief Check if DISPID caches are shared by type.
+ */
+bool dispidCacheByType()
+{
+    return DISPID_BY_TYPE.load(std::memory_order_relaxed);
+}
+
+
+/** \brief Share DISPID caches between objects with the same type.
+ */
+void setDispidCacheByType(const bool enabled)
+{
+    DISPID_BY_TYPE.store(enabled, std::memory_order_relaxed);
+}
+
+
+/** \brief Get a DISPID cache for an object.
+ */
+DispidCachePtr newDispidCache(IDispatch *dispatch)
+{
+    if (!dispidCacheByType() || !dispatch) {
+        return std::make_shared<DispidCache>();
+    }
+
+    // dynamic members cannot be shared
+    IDispatchEx *dynamic = nullptr;
+    if (SUCCEEDED(dispatch->QueryInterface(IID_IDispatchEx, (void **) &dynamic)) && dynamic) {
+        dynamic->Release();
+        return std::make_shared<DispidCache>();
+    }
+
+    GUID guid;
+    if (!dispatchType(dispatch, guid)) {
+        return std::make_shared<DispidCache>();
+    }
+
+    DispidRegistry &registry = dispidRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    DispidCachePtr &cache = registry.caches[guid];
+    if (!cache) {
+        cache = std::make_shared<DispidCache>();
+    }
+
+    return cache;
+}
+
+}   /* autocom */
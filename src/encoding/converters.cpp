@@ -6,11 +6,148 @@
  */
 
 #include "autocom/encoding/converters.hpp"
+#include "autocom/encoding/parallel.hpp"
+#include "autocom/encoding/simd.hpp"
 #include "autocom/encoding/unicode.hpp"
 
+#include <algorithm>
+#include <type_traits>
+
 
 namespace autocom
 {
+// HELPERS
+// -------
+
+
+/** \brief Code unit of the native wide string.
+ *
+ *  wchar_t is UTF-16 on Windows, and UTF-32 where it is 4 bytes.
+ */
+typedef std::conditional<sizeof(wchar_t) == 2, uint16_t, uint32_t>::type WideUnit;
+
+
+/** \brief Sizing and conversion kernels for a wide code unit.
+ *
+ *  `RATIO` is the maximum number of UTF-8 bytes per wide code unit.
+ *  Every length and conversion takes the length of the ASCII prefix,
+ *  which is widened or narrowed in one pass.
+ */
+template <typename Wide>
+struct WideKernel;
+
+
+template <>
+struct WideKernel<uint16_t>
+{
+    static constexpr size_t RATIO = 3;
+
+    static size_t asciiLength(const uint16_t *src,
+        const uint16_t *srcEnd)
+    {
+        return utf::simd::asciiLength(src, srcEnd);
+    }
+
+    static size_t wideLength(const uint8_t *src,
+        const uint8_t *srcEnd,
+        const size_t ascii)
+    {
+        if (src + ascii == srcEnd) {
+            return ascii;
+        }
+        return ascii + utf::simd::utf8To16Length(src + ascii, srcEnd);
+    }
+
+    static size_t narrowLength(const uint16_t *src,
+        const uint16_t *srcEnd,
+        const size_t ascii)
+    {
+        if (src + ascii == srcEnd) {
+            return ascii;
+        }
+        return ascii + utf::simd::utf16To8Length(src + ascii, srcEnd);
+    }
+
+    static size_t widen(const uint8_t *src,
+        const uint8_t *srcEnd,
+        const size_t ascii,
+        uint16_t *dst,
+        uint16_t *dstEnd)
+    {
+        utf::simd::widenAscii(src, src + ascii, dst);
+        if (src + ascii == srcEnd) {
+            return ascii;
+        }
+        return ascii + utf::simd::utf8To16(src + ascii, srcEnd, dst + ascii, dstEnd);
+    }
+
+    static size_t narrow(const uint16_t *src,
+        const uint16_t *srcEnd,
+        const size_t ascii,
+        uint8_t *dst,
+        uint8_t *dstEnd)
+    {
+        utf::simd::narrowAscii(src, src + ascii, dst);
+        if (src + ascii == srcEnd) {
+            return ascii;
+        }
+        return ascii + utf::simd::utf16To8(src + ascii, srcEnd, dst + ascii, dstEnd);
+    }
+};
+
+
+template <>
+struct WideKernel<uint32_t>
+{
+    static constexpr size_t RATIO = 4;
+
+    static size_t asciiLength(const uint32_t *src,
+        const uint32_t *srcEnd)
+    {
+        return std::find_if(src, srcEnd, [](uint32_t c) {
+            return c >= 0x80;
+        }) - src;
+    }
+
+    static size_t wideLength(const uint8_t *src,
+        const uint8_t *srcEnd,
+        const size_t ascii)
+    {
+        return ascii + utf::detail::utf8To32Length(src + ascii, srcEnd);
+    }
+
+    static size_t narrowLength(const uint32_t *src,
+        const uint32_t *srcEnd,
+        const size_t ascii)
+    {
+        return ascii + utf::detail::utf32To8Length(src + ascii, srcEnd);
+    }
+
+    static size_t widen(const uint8_t *src,
+        const uint8_t *srcEnd,
+        const size_t ascii,
+        uint32_t *dst,
+        uint32_t *dstEnd)
+    {
+        std::copy(src, src + ascii, dst);
+        return ascii + utf::detail::utf8To32(src + ascii, srcEnd, dst + ascii, dstEnd);
+    }
+
+    static size_t narrow(const uint32_t *src,
+        const uint32_t *srcEnd,
+        const size_t ascii,
+        uint8_t *dst,
+        uint8_t *dstEnd)
+    {
+        std::transform(src, src + ascii, dst, [](uint32_t c) {
+            return static_cast<uint8_t>(c);
+        });
+        return ascii + utf::detail::utf32To8(src + ascii, srcEnd, dst + ascii, dstEnd);
+    }
+};
+
+typedef WideKernel<WideUnit> kernel;
+
 // FUNCTIONS
 // ---------
 
@@ -18,11 +155,135 @@ namespace autocom
  */
 std::wstring WIDE(const std::string &narrow)
 {
-    auto utf16 = UTF8_TO_UTF16(narrow);
-    auto *data = reinterpret_cast<const wchar_t*>(utf16.data());
-    const size_t size = utf16.size() / sizeof(wchar_t);
+    return WIDE(narrow.data(), narrow.size());
+}
+
 
-    return std::wstring(data, size);
+/** \brief Convert UTF-8 character array to wide UTF-16.
+ *
+ *  Pure ASCII input, the common case for COM identifiers, is widened
+ *  in a single vectorized pass. Otherwise, the exact output length is
+ *  computed up front so the result is transcoded directly into the
+ *  returned string, with a single allocation. Inputs above the
+ *  threshold of the default parallel policy are split across threads.
+ */
+std::wstring WIDE(const char *narrow,
+    const size_t length)
+{
+    return WIDE(narrow, length, utf::parallel());
+}
+
+
+/** \brief Convert UTF-8 to wide UTF-16, in parallel for large inputs.
+ */
+std::wstring WIDE(const std::string &narrow,
+    const utf::Parallel &parallel)
+{
+    return WIDE(narrow.data(), narrow.size(), parallel);
+}
+
+
+/** \brief Convert UTF-8 character array to wide UTF-16, in parallel
+ *  for large inputs.
+ */
+std::wstring WIDE(const char *narrow,
+    const size_t length,
+    const utf::Parallel &parallel)
+{
+    auto *src = reinterpret_cast<const uint8_t*>(narrow);
+    auto *srcEnd = src + length;
+    if (parallel.workers(length) == 1) {
+        const size_t ascii = utf::simd::asciiLength(src, srcEnd);
+        std::wstring wide(kernel::wideLength(src, srcEnd, ascii), L'\0');
+        auto *dst = reinterpret_cast<WideUnit*>(&wide[0]);
+        kernel::widen(src, srcEnd, ascii, dst, dst + wide.size());
+
+        return wide;
+    }
+
+    std::wstring wide;
+    utf::detail::transcode<uint8_t, WideUnit>(src, srcEnd, [&](size_t size) {
+        wide.resize(size);
+        return reinterpret_cast<WideUnit*>(&wide[0]);
+    }, parallel);
+
+    return wide;
+}
+
+
+/** \brief Convert UTF-8 to wide UTF-16 in a caller-provided buffer.
+ *
+ *  UTF-16 never needs more code units than UTF-8, so the exact length
+ *  is only computed if the buffer is smaller than the input.
+ */
+size_t WIDE(const char *narrow,
+    const size_t length,
+    wchar_t *wide,
+    const size_t capacity)
+{
+    auto *src = reinterpret_cast<const uint8_t*>(narrow);
+    auto *srcEnd = src + length;
+    auto *dst = reinterpret_cast<WideUnit*>(wide);
+    const size_t ascii = utf::simd::asciiLength(src, srcEnd);
+    if (capacity < length && capacity < kernel::wideLength(src, srcEnd, ascii)) {
+        throw utf::detail::BufferRangeError();
+    }
+
+    return kernel::widen(src, srcEnd, ascii, dst, dst + capacity);
+}
+
+
+/** \brief Get exact number of UTF-16 code units to store narrow.
+ */
+size_t WIDE_LENGTH(const char *narrow,
+    const size_t length)
+{
+    auto *src = reinterpret_cast<const uint8_t*>(narrow);
+    auto *srcEnd = src + length;
+
+    return kernel::wideLength(src, srcEnd, utf::simd::asciiLength(src, srcEnd));
+}
+
+
+/** \brief Convert UTF-8 to wide UTF-16 in a buffer sized by WIDE_LENGTH.
+ *
+ *  The ASCII prefix is clamped to `size`, since it is widened without
+ *  checking the output bound.
+ */
+size_t WIDE_EXACT(const char *narrow,
+    const size_t length,
+    wchar_t *wide,
+    const size_t size)
+{
+    auto *src = reinterpret_cast<const uint8_t*>(narrow);
+    auto *srcEnd = src + length;
+    auto *dst = reinterpret_cast<WideUnit*>(wide);
+    const size_t ascii = utf::simd::asciiLength(src, src + std::min(length, size));
+
+    return kernel::widen(src, srcEnd, ascii, dst, dst + size);
+}
+
+
+/** \brief Convert UTF-8 to wide UTF-16 in a thread-local buffer.
+ *
+ *  The buffer only grows, so steady-state calls do not allocate.
+ */
+const std::wstring & WIDE_SCRATCH(const char *narrow,
+    const size_t length)
+{
+    thread_local std::wstring wide;
+    wide.resize(length);
+    wide.resize(WIDE(narrow, length, &wide[0], length));
+
+    return wide;
+}
+
+
+/** \brief Convert UTF-8 to wide UTF-16 in a thread-local buffer.
+ */
+const std::wstring & WIDE_SCRATCH(const std::string &narrow)
+{
+    return WIDE_SCRATCH(narrow.data(), narrow.size());
 }
 
 
@@ -30,11 +291,132 @@ std::wstring WIDE(const std::string &narrow)
  */
 std::string NARROW(const std::wstring &wide)
 {
-    auto *data = reinterpret_cast<const char*>(wide.data());
-    const size_t size = wide.size() * sizeof(wchar_t);
-    std::string utf16(data, size);
+    return NARROW(wide.data(), wide.size());
+}
+
+
+/** \brief Convert UTF-16 character array to narrow UTF-8.
+ *
+ *  Mirrors WIDE(): narrows pure ASCII in a single pass, and otherwise
+ *  transcodes directly into an exactly-sized result.
+ */
+std::string NARROW(const wchar_t *wide,
+    const size_t length)
+{
+    return NARROW(wide, length, utf::parallel());
+}
+
+
+/** \brief Convert UTF-16 to narrow UTF-8, in parallel for large inputs.
+ */
+std::string NARROW(const std::wstring &wide,
+    const utf::Parallel &parallel)
+{
+    return NARROW(wide.data(), wide.size(), parallel);
+}
+
+
+/** \brief Convert UTF-16 character array to narrow UTF-8, in parallel
+ *  for large inputs.
+ */
+std::string NARROW(const wchar_t *wide,
+    const size_t length,
+    const utf::Parallel &parallel)
+{
+    auto *src = reinterpret_cast<const WideUnit*>(wide);
+    auto *srcEnd = src + length;
+    if (parallel.workers(length) == 1) {
+        const size_t ascii = kernel::asciiLength(src, srcEnd);
+        std::string narrow(kernel::narrowLength(src, srcEnd, ascii), '\0');
+        auto *dst = reinterpret_cast<uint8_t*>(&narrow[0]);
+        kernel::narrow(src, srcEnd, ascii, dst, dst + narrow.size());
+
+        return narrow;
+    }
+
+    std::string narrow;
+    utf::detail::transcode<WideUnit, uint8_t>(src, srcEnd, [&](size_t size) {
+        narrow.resize(size);
+        return reinterpret_cast<uint8_t*>(&narrow[0]);
+    }, parallel);
+
+    return narrow;
+}
+
+
+/** \brief Convert UTF-16 to narrow UTF-8 in a caller-provided buffer.
+ *
+ *  The exact length is only computed if the buffer could be too small
+ *  for the worst case, 3 bytes per UTF-16 or 4 per UTF-32 code unit.
+ */
+size_t NARROW(const wchar_t *wide,
+    const size_t length,
+    char *narrow,
+    const size_t capacity)
+{
+    auto *src = reinterpret_cast<const WideUnit*>(wide);
+    auto *srcEnd = src + length;
+    auto *dst = reinterpret_cast<uint8_t*>(narrow);
+    const size_t ascii = kernel::asciiLength(src, srcEnd);
+    if (capacity < length * kernel::RATIO && capacity < kernel::narrowLength(src, srcEnd, ascii)) {
+        throw utf::detail::BufferRangeError();
+    }
+
+    return kernel::narrow(src, srcEnd, ascii, dst, dst + capacity);
+}
+
+
+/** \brief Get exact number of UTF-8 code units to store wide.
+ */
+size_t NARROW_LENGTH(const wchar_t *wide,
+    const size_t length)
+{
+    auto *src = reinterpret_cast<const WideUnit*>(wide);
+    auto *srcEnd = src + length;
+
+    return kernel::narrowLength(src, srcEnd, kernel::asciiLength(src, srcEnd));
+}
+
 
-    return UTF16_TO_UTF8(utf16);
+/** \brief Convert UTF-16 to narrow UTF-8 in a buffer sized by NARROW_LENGTH.
+ *
+ *  The ASCII prefix is clamped to `size`, since it is narrowed without
+ *  checking the output bound.
+ */
+size_t NARROW_EXACT(const wchar_t *wide,
+    const size_t length,
+    char *narrow,
+    const size_t size)
+{
+    auto *src = reinterpret_cast<const WideUnit*>(wide);
+    auto *srcEnd = src + length;
+    auto *dst = reinterpret_cast<uint8_t*>(narrow);
+    const size_t ascii = kernel::asciiLength(src, src + std::min(length, size));
+
+    return kernel::narrow(src, srcEnd, ascii, dst, dst + size);
+}
+
+
+/** \brief Convert UTF-16 to narrow UTF-8 in a thread-local buffer.
+ *
+ *  The buffer only grows, so steady-state calls do not allocate.
+ */
+const std::string & NARROW_SCRATCH(const wchar_t *wide,
+    const size_t length)
+{
+    thread_local std::string narrow;
+    narrow.resize(length * kernel::RATIO);
+    narrow.resize(NARROW(wide, length, &narrow[0], narrow.size()));
+
+    return narrow;
+}
+
+
+/** \brief Convert UTF-16 to narrow UTF-8 in a thread-local buffer.
+ */
+const std::string & NARROW_SCRATCH(const std::wstring &wide)
+{
+    return NARROW_SCRATCH(wide.data(), wide.size());
 }
 
 
@@ -0,0 +1,87 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/**
+ *  \addtogroup AutoCOM
+ *  \brief Multi-threaded UTF-8 and UTF-16 transcoding for large inputs.
+ */
+
+#include "autocom/encoding/parallel.hpp"
+
+#include <atomic>
+
+
+namespace autocom
+{
+namespace utf
+{
+// CONSTANTS
+// ---------
+
+/** Default policy used by WIDE() and NARROW().
+ */
+std::atomic<size_t> THRESHOLD(SERIAL.threshold);
+std::atomic<size_t> THREADS(SERIAL.threads);
+
+// FUNCTIONS
+// ---------
+
+
+/** \brief Get the default policy used by WIDE() and NARROW().
+ */
+Parallel parallel()
+{
+    return Parallel(THRESHOLD.load(std::memory_order_relaxed), THREADS.load(std::memory_order_relaxed));
+}
+
+
+/** \brief Set the default policy used by WIDE() and NARROW().
+ */
+void setParallel(const Parallel &parallel)
+{
+    THRESHOLD.store(parallel.threshold, std::memory_order_relaxed);
+    THREADS.store(parallel.threads, std::memory_order_relaxed);
+}
+
+
+/** \brief Convert UTF8 to UTF16, in parallel for large inputs.
+ */
+std::string utf8To16(const std::string &string,
+    const Parallel &parallel)
+{
+    if (parallel.workers(string.size()) == 1) {
+        return utf8To16(string);
+    }
+
+    auto *src = reinterpret_cast<const uint8_t*>(string.data());
+    std::string output;
+    detail::transcode<uint8_t, uint16_t>(src, src + string.size(), [&](size_t length) {
+        output.resize(length * sizeof(uint16_t));
+        return reinterpret_cast<uint16_t*>(&output[0]);
+    }, parallel);
+
+    return output;
+}
+
+
+/** \brief Convert UTF16 to UTF8, in parallel for large inputs.
+ */
+std::string utf16To8(const std::string &string,
+    const Parallel &parallel)
+{
+    auto *src = reinterpret_cast<const uint16_t*>(string.data());
+    const size_t length = string.size() / sizeof(uint16_t);
+    if (parallel.workers(length) == 1) {
+        return utf16To8(string);
+    }
+
+    std::string output;
+    detail::transcode<uint16_t, uint8_t>(src, src + length, [&](size_t length) {
+        output.resize(length);
+        return reinterpret_cast<uint8_t*>(&output[0]);
+    }, parallel);
+
+    return output;
+}
+
+}   /* utf */
+}   /* autocom */
@@ -0,0 +1,1859 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/**
+ *  \addtogroup AutoCOM
+ *  \brief Vectorized UTF-8 and UTF-16 transcoding kernels.
+ */
+
+#include "autocom/encoding/simd.hpp"
+#include "autocom/encoding/unicode.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#   define AUTOCOM_SIMD_X86
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   endif
+#   include <immintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#   define AUTOCOM_SIMD_NEON
+#   include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit SSE2/AVX2 instructions for functions which
+// opt-in, while MSVC allows any intrinsic in any function.
+#if defined(__GNUC__) || defined(__clang__)
+#   define AUTOCOM_TARGET_SSE2 __attribute__((target("sse2")))
+#   define AUTOCOM_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#   define AUTOCOM_TARGET_SSE2
+#   define AUTOCOM_TARGET_AVX2
+#endif
+
+#define AUTOCOM_TARGET_NEON
+
+
+namespace autocom
+{
+namespace utf
+{
+namespace simd
+{
+// CONSTANTS
+// ---------
+
+/** Active instruction set, or -1 if not yet detected.
+ */
+std::atomic<int> ACTIVE(-1);
+
+// MACROS
+// ------
+
+
+/** \brief Define a UTF-8 to UTF-16 kernel from block conversion functions.
+ *
+ *  `widen` converts `width` bytes to UTF-16 if they are all ASCII,
+ *  and returns false otherwise. `expand` converts the leading 1 to
+ *  3-byte characters of the block, storing at most `width` code units,
+ *  and returns the number of bytes consumed. It stops before any
+ *  4-byte or invalid sequence, which is handed to the scalar converter
+ *  one code point at a time, so the output is identical to
+ *  `detail::utf8To16`.
+ */
+#define AUTOCOM_UTF8_TO_UTF16_KERNEL(name, target, width, widen, expand) \
+    target size_t name(const uint8_t *srcBegin,                         \
+        const uint8_t *srcEnd,                                          \
+        uint16_t *dstBegin,                                             \
+        uint16_t *dstEnd,                                               \
+        bool strict)                                                    \
+    {                                                                   \
+        auto src = srcBegin;                                            \
+        auto dst = dstBegin;                                            \
+        while (src < srcEnd && dst < dstEnd) {                          \
+            if (srcEnd - src >= width && dstEnd - dst >= width) {       \
+                if (widen(src, dst)) {                                  \
+                    src += width;                                       \
+                    dst += width;                                       \
+                    continue;                                           \
+                }                                                       \
+                const size_t bytes = expand(src, dst);                  \
+                if (bytes) {                                            \
+                    src += bytes;                                       \
+                    continue;                                           \
+                }                                                       \
+            }                                                           \
+            detail::utf8To16Char(src, srcEnd, dst, dstEnd, strict);     \
+        }                                                               \
+                                                                        \
+        return dst - dstBegin;                                          \
+    }
+
+
+/** \brief Define a UTF-16 to UTF-8 kernel from block conversion functions.
+ *
+ *  `narrow` converts `width` code units to UTF-8 if they are all
+ *  ASCII, and returns false otherwise. `compress` converts the
+ *  leading code units up to the first surrogate, and returns the
+ *  number of code units consumed. It may store up to 16 bytes past
+ *  its output, so it needs `4 * width` bytes of room.
+ */
+#define AUTOCOM_UTF16_TO_UTF8_KERNEL(name, target, width, narrow, compress) \
+    target size_t name(const uint16_t *srcBegin,                        \
+        const uint16_t *srcEnd,                                         \
+        uint8_t *dstBegin,                                              \
+        uint8_t *dstEnd,                                                \
+        bool strict)                                                    \
+    {                                                                   \
+        auto src = srcBegin;                                            \
+        auto dst = dstBegin;                                            \
+        while (src < srcEnd && dst < dstEnd) {                          \
+            if (srcEnd - src >= width) {                                \
+                if (dstEnd - dst >= width && narrow(src, dst)) {        \
+                    src += width;                                       \
+                    dst += width;                                       \
+                    continue;                                           \
+                }                                                       \
+                if (dstEnd - dst >= 4 * width) {                        \
+                    const size_t units = compress(src, dst);            \
+                    if (units) {                                        \
+                        src += units;                                   \
+                        continue;                                       \
+                    }                                                   \
+                }                                                       \
+            }                                                           \
+            detail::utf16To8Char(src, srcEnd, dst, dstEnd, strict);     \
+        }                                                               \
+                                                                        \
+        return dst - dstBegin;                                          \
+    }
+
+
+/** \brief Define a transcoded length counter from a block measuring
+ *  function.
+ *
+ *  `measure` adds the output length of the leading characters of a
+ *  block, and returns the number of code units consumed. Characters
+ *  it cannot measure are counted by the scalar `step`.
+ */
+#define AUTOCOM_LENGTH_KERNEL(name, target, Char, width, measure, step) \
+    target size_t name(const Char *srcBegin,                            \
+        const Char *srcEnd,                                             \
+        bool strict)                                                    \
+    {                                                                   \
+        size_t length = 0;                                              \
+        auto src = srcBegin;                                            \
+        while (src < srcEnd) {                                          \
+            if (srcEnd - src >= width) {                                \
+                const size_t count = measure(src, length);              \
+                if (count) {                                            \
+                    src += count;                                       \
+                    continue;                                           \
+                }                                                       \
+            }                                                           \
+            length += step(src, srcEnd, strict);                        \
+        }                                                               \
+                                                                        \
+        return length;                                                  \
+    }
+
+
+/** \brief Define an ASCII prefix scanner from a block check function.
+ */
+#define AUTOCOM_ASCII_LENGTH_KERNEL(name, target, Char, width, check)   \
+    target size_t name(const Char *srcBegin,                            \
+        const Char *srcEnd)                                             \
+    {                                                                   \
+        auto src = srcBegin;                                            \
+        while (srcEnd - src >= width && check(src)) {                   \
+            src += width;                                               \
+        }                                                               \
+        while (src < srcEnd && *src < 0x80) {                           \
+            ++src;                                                      \
+        }                                                               \
+                                                                        \
+        return src - srcBegin;                                          \
+    }
+
+
+/** \brief Define an ASCII widening or narrowing copy.
+ */
+#define AUTOCOM_ASCII_COPY_KERNEL(name, target, C1, C2, width, copy)    \
+    target void name(const C1 *srcBegin,                                \
+        const C1 *srcEnd,                                               \
+        C2 *dst)                                                        \
+    {                                                                   \
+        auto src = srcBegin;                                            \
+        while (srcEnd - src >= width && copy(src, dst)) {               \
+            src += width;                                               \
+            dst += width;                                               \
+        }                                                               \
+        while (src < srcEnd) {                                          \
+            *dst++ = static_cast<C2>(*src++);                           \
+        }                                                               \
+    }
+
+
+/** \brief Define a UTF-16 mismatch scanner from a block equality check.
+ *
+ *  `equal` compares `width` code units, and the first differing block
+ *  is scanned with the scalar `same`.
+ */
+#define AUTOCOM_MISMATCH_KERNEL(name, target, width, equal, same)      \
+    target size_t name(const uint16_t *left,                            \
+        const uint16_t *right,                                          \
+        const size_t length)                                            \
+    {                                                                   \
+        size_t i = 0;                                                   \
+        while (length - i >= width && equal(left + i, right + i)) {     \
+            i += width;                                                 \
+        }                                                               \
+        while (i < length && same(left[i], right[i])) {                 \
+            ++i;                                                        \
+        }                                                               \
+                                                                        \
+        return i;                                                       \
+    }
+
+
+/** \brief Define an ASCII uppercase copy from a block folding function.
+ */
+#define AUTOCOM_UPPER_KERNEL(name, target, width, upper)                \
+    target void name(const uint16_t *srcBegin,                          \
+        const uint16_t *srcEnd,                                         \
+        uint16_t *dst)                                                  \
+    {                                                                   \
+        auto src = srcBegin;                                            \
+        while (srcEnd - src >= width) {                                 \
+            upper(src, dst);                                            \
+            src += width;                                               \
+            dst += width;                                               \
+        }                                                               \
+        while (src < srcEnd) {                                          \
+            *dst++ = upperAsciiChar(*src++);                            \
+        }                                                               \
+    }
+
+// SCALAR
+// ------
+
+
+/** \brief Fold ASCII lowercase letters to uppercase.
+ */
+inline uint16_t upperAsciiChar(const uint16_t c)
+{
+    return static_cast<uint16_t>(c - 'a') < 26 ? static_cast<uint16_t>(c - 0x20) : c;
+}
+
+
+/** \brief Check if two code units are identical.
+ */
+inline bool sameChar(const uint16_t left,
+    const uint16_t right)
+{
+    return left == right;
+}
+
+
+/** \brief Check if two code units are identical, ignoring ASCII case.
+ */
+inline bool sameCharNoCase(const uint16_t left,
+    const uint16_t right)
+{
+    return upperAsciiChar(left) == upperAsciiChar(right);
+}
+
+
+/** \brief Count the set bits in a mask.
+ */
+inline size_t popcount(uint64_t mask)
+{
+    mask = mask - ((mask >> 1) & 0x5555555555555555ULL);
+    mask = (mask & 0x3333333333333333ULL) + ((mask >> 2) & 0x3333333333333333ULL);
+    mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<size_t>((mask * 0x0101010101010101ULL) >> 56);
+}
+
+
+/** \brief Get the bits below the lowest set bit of error, within width.
+ */
+inline uint64_t prefixMask(const uint64_t error,
+    const unsigned width)
+{
+    const uint64_t full = (uint64_t(1) << width) - 1;
+    return ((error & (~error + 1)) - 1) & full;
+}
+
+
+/** \brief Spread the low 4 bits of mask to every other bit.
+ */
+inline unsigned spread(const uint64_t mask)
+{
+    return static_cast<unsigned>((mask & 1) | ((mask & 2) << 1) | ((mask & 4) << 2) | ((mask & 8) << 3));
+}
+
+
+/** \brief Byte classes of a UTF-8 block, one bit per byte.
+ */
+struct Utf8Masks
+{
+    uint64_t ge80;
+    uint64_t geA0;
+    uint64_t geC0;
+    uint64_t geC2;
+    uint64_t geE0;
+    uint64_t geF0;
+    uint64_t eqE0;
+    uint64_t eqED;
+};
+
+
+/** \brief Leading 1 to 3-byte characters of a UTF-8 block.
+ *
+ *  `length` is the number of bytes, and `lead` marks the first byte
+ *  of each character, which is the position of its UTF-16 code unit
+ *  before packing.
+ */
+struct Utf8Prefix
+{
+    size_t length;
+    uint64_t lead;
+};
+
+
+/** \brief Code unit classes of a UTF-16 block, one bit per code unit.
+ */
+struct Utf16Masks
+{
+    uint64_t ge80;
+    uint64_t ge800;
+    uint64_t surrogate;
+};
+
+
+/** \brief Leading non-surrogate code units of a UTF-16 block.
+ *
+ *  `valid` marks the code units, and `ge80` and `ge800` those which
+ *  need a second and third UTF-8 byte.
+ */
+struct Utf16Prefix
+{
+    size_t length;
+    uint64_t valid;
+    uint64_t ge80;
+    uint64_t ge800;
+};
+
+
+/** \brief Validate a UTF-8 block from its byte classes.
+ *
+ *  Every continuation byte must follow a 2 or 3-byte lead, and every
+ *  lead must be followed by its continuation bytes. Overlong forms,
+ *  surrogates, 4-byte leads and invalid bytes end the prefix, as does
+ *  a sequence cut off by the end of the block.
+ */
+inline Utf8Prefix utf8Prefix(const Utf8Masks &masks,
+    const unsigned width)
+{
+    const uint64_t continuation = masks.ge80 & ~masks.geC0;
+    const uint64_t lead3 = masks.geE0 & ~masks.geF0;
+    const uint64_t lead = (masks.geC2 & ~masks.geE0) | lead3;
+    const uint64_t invalid = masks.geF0 | (masks.geC0 & ~masks.geC2);
+    const uint64_t expected = (lead << 1) | (lead3 << 2);
+    const uint64_t overlong = masks.eqE0 & ~(masks.geA0 >> 1);
+    const uint64_t surrogate = masks.eqED & (masks.geA0 >> 1);
+    uint64_t valid = prefixMask(invalid | (continuation ^ expected) | overlong | surrogate, width);
+
+    // drop a trailing sequence missing its continuation bytes
+    const uint64_t last = valid & ~(valid >> 1);
+    const uint64_t second = (valid >> 1) & ~(valid >> 2);
+    if (lead & last) {
+        valid &= ~last;
+    } else if (lead3 & second) {
+        valid &= ~(last | second);
+    }
+
+    return {popcount(valid), valid & ~continuation};
+}
+
+
+/** \brief Find the leading non-surrogate code units of a UTF-16 block.
+ */
+inline Utf16Prefix utf16Prefix(const Utf16Masks &masks,
+    const unsigned width)
+{
+    const uint64_t valid = prefixMask(masks.surrogate, width);
+    return {popcount(valid), valid, masks.ge80 & valid, masks.ge800 & valid};
+}
+
+
+/** \brief Get number of code units utf8To16Char writes for one character.
+ */
+inline size_t utf8To16CharLength(const uint8_t *&src,
+    const uint8_t *srcEnd,
+    bool strict)
+{
+    return detail::utf32To16Length(detail::utf8To32(src, srcEnd, strict));
+}
+
+
+/** \brief Get number of bytes utf16To8Char writes for one character.
+ */
+inline size_t utf16To8CharLength(const uint16_t *&src,
+    const uint16_t *srcEnd,
+    bool strict)
+{
+    return detail::utf32To8Length(detail::utf16To32(src, srcEnd, strict));
+}
+
+// TABLES
+// ------
+
+
+/** \brief Byte shuffles which pack the kept 16-bit lanes of a vector.
+ *
+ *  Indexed by a mask of the 8 lanes to keep. Unused bytes are zeroed.
+ */
+struct UnitShuffles
+{
+    uint8_t shuffle[256][16];
+    uint8_t count[256];
+
+    constexpr UnitShuffles():
+        shuffle(),
+        count()
+    {
+        for (unsigned mask = 0; mask < 256; ++mask) {
+            unsigned k = 0;
+            for (unsigned lane = 0; lane < 8; ++lane) {
+                if (mask & (1 << lane)) {
+                    shuffle[mask][k++] = static_cast<uint8_t>(2 * lane);
+                    shuffle[mask][k++] = static_cast<uint8_t>(2 * lane + 1);
+                }
+            }
+            count[mask] = static_cast<uint8_t>(k / 2);
+            while (k < 16) {
+                shuffle[mask][k++] = 0x80;
+            }
+        }
+    }
+};
+
+
+/** \brief Byte shuffles which pack UTF-8 characters from 32-bit lanes.
+ *
+ *  Each of the 4 lanes holds a character in its low bytes. Indexed by
+ *  the number of bytes to keep from each lane, 2 bits per lane.
+ */
+struct ByteShuffles
+{
+    uint8_t shuffle[256][16];
+    uint8_t count[256];
+
+    constexpr ByteShuffles():
+        shuffle(),
+        count()
+    {
+        for (unsigned index = 0; index < 256; ++index) {
+            unsigned k = 0;
+            for (unsigned lane = 0; lane < 4; ++lane) {
+                const unsigned bytes = (index >> (2 * lane)) & 3;
+                for (unsigned byte = 0; byte < bytes; ++byte) {
+                    shuffle[index][k++] = static_cast<uint8_t>(4 * lane + byte);
+                }
+            }
+            count[index] = static_cast<uint8_t>(k);
+            while (k < 16) {
+                shuffle[index][k++] = 0x80;
+            }
+        }
+    }
+};
+
+
+constexpr UnitShuffles UNIT_SHUFFLES;
+constexpr ByteShuffles BYTE_SHUFFLES;
+
+// X86
+// ---
+
+#if defined(AUTOCOM_SIMD_X86)
+
+
+/** \brief Check if the CPU supports SSE2.
+ */
+bool cpuSse2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+
+/** \brief Check if the CPU and OS support AVX2.
+ */
+bool cpuAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+
+    // the OS must save the YMM registers on context switches
+    __cpuid(info, 1);
+    const int osxsave = 1 << 27;
+    const int avx = 1 << 28;
+    if ((info[2] & (osxsave | avx)) != (osxsave | avx)) {
+        return false;
+    } else if ((_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+
+/** \brief Check if 16 bytes are ASCII.
+ */
+AUTOCOM_TARGET_SSE2
+inline bool asciiSse2(const uint8_t *src)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    return _mm_movemask_epi8(v) == 0;
+}
+
+
+/** \brief Check if 16 code units are ASCII.
+ */
+AUTOCOM_TARGET_SSE2
+inline bool asciiSse2(const uint16_t *src)
+{
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+    const __m128i mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i high = _mm_and_si128(_mm_or_si128(lo, hi), mask);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) == 0xFFFF;
+}
+
+
+/** \brief Check if 32 bytes are ASCII.
+ */
+AUTOCOM_TARGET_AVX2
+inline bool asciiAvx2(const uint8_t *src)
+{
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    return _mm256_movemask_epi8(v) == 0;
+}
+
+
+/** \brief Check if 32 code units are ASCII.
+ */
+AUTOCOM_TARGET_AVX2
+inline bool asciiAvx2(const uint16_t *src)
+{
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 16));
+    const __m256i mask = _mm256_set1_epi16(static_cast<short>(0xFF80));
+    return _mm256_testz_si256(_mm256_or_si256(lo, hi), mask) != 0;
+}
+
+
+/** \brief Widen 16 ASCII bytes to UTF-16.
+ */
+AUTOCOM_TARGET_SSE2
+inline bool widenSse2(const uint8_t *src,
+    uint16_t *dst)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    if (_mm_movemask_epi8(v)) {
+        return false;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi8(v, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_unpackhi_epi8(v, zero));
+
+    return true;
+}
+
+
+/** \brief Narrow 16 ASCII code units to UTF-8.
+ */
+AUTOCOM_TARGET_SSE2
+inline bool narrowSse2(const uint16_t *src,
+    uint8_t *dst)
+{
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+    const __m128i mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i high = _mm_and_si128(_mm_or_si128(lo, hi), mask);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) != 0xFFFF) {
+        return false;
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(lo, hi));
+
+    return true;
+}
+
+
+/** \brief Widen 32 ASCII bytes to UTF-16.
+ */
+AUTOCOM_TARGET_AVX2
+inline bool widenAvx2(const uint8_t *src,
+    uint16_t *dst)
+{
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    if (_mm256_movemask_epi8(v)) {
+        return false;
+    }
+
+    const __m256i lo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v));
+    const __m256i hi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 16), hi);
+
+    return true;
+}
+
+
+/** \brief Narrow 32 ASCII code units to UTF-8.
+ */
+AUTOCOM_TARGET_AVX2
+inline bool narrowAvx2(const uint16_t *src,
+    uint8_t *dst)
+{
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 16));
+    const __m256i mask = _mm256_set1_epi16(static_cast<short>(0xFF80));
+    if (!_mm256_testz_si256(_mm256_or_si256(lo, hi), mask)) {
+        return false;
+    }
+
+    // packus interleaves the 128-bit lanes, restore their order
+    const __m256i packed = _mm256_packus_epi16(lo, hi);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute4x64_epi64(packed, 0xD8));
+
+    return true;
+}
+
+
+/** \brief Fold 8 code units to ASCII uppercase.
+ *
+ *  SSE2 only has signed 16-bit comparisons, so the range check flips
+ *  the sign bit to compare `c - 'a'` as unsigned.
+ */
+AUTOCOM_TARGET_SSE2
+inline __m128i upperSse2(const __m128i v)
+{
+    const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+    const __m128i offset = _mm_xor_si128(_mm_sub_epi16(v, _mm_set1_epi16('a')), bias);
+    const __m128i lower = _mm_cmplt_epi16(offset, _mm_set1_epi16(static_cast<short>(0x8000 + 26)));
+    return _mm_sub_epi16(v, _mm_and_si128(lower, _mm_set1_epi16(0x20)));
+}
+
+
+/** \brief Fold 16 code units to ASCII uppercase.
+ */
+AUTOCOM_TARGET_AVX2
+inline __m256i upperAvx2(const __m256i v)
+{
+    const __m256i bias = _mm256_set1_epi16(static_cast<short>(0x8000));
+    const __m256i offset = _mm256_xor_si256(_mm256_sub_epi16(v, _mm256_set1_epi16('a')), bias);
+    const __m256i lower = _mm256_cmpgt_epi16(_mm256_set1_epi16(static_cast<short>(0x8000 + 26)), offset);
+    return _mm256_sub_epi16(v, _mm256_and_si256(lower, _mm256_set1_epi16(0x20)));
+}
+
+
+/** \brief Check if 16 code units are identical.
+ */
+AUTOCOM_TARGET_SSE2
+inline bool equalSse2(const uint16_t *left,
+    const uint16_t *right)
+{
+    const __m128i lo = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(right)));
+    const __m128i hi = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left + 8)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + 8)));
+    return _mm_movemask_epi8(_mm_and_si128(lo, hi)) == 0xFFFF;
+}
+
+
+/** \brief Check if 16 code units are identical, ignoring ASCII case.
+ */
+AUTOCOM_TARGET_SSE2
+inline bool equalNoCaseSse2(const uint16_t *left,
+    const uint16_t *right)
+{
+    const __m128i l0 = upperSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left)));
+    const __m128i l1 = upperSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left + 8)));
+    const __m128i r0 = upperSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right)));
+    const __m128i r1 = upperSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right + 8)));
+    const __m128i equal = _mm_and_si128(_mm_cmpeq_epi16(l0, r0), _mm_cmpeq_epi16(l1, r1));
+    return _mm_movemask_epi8(equal) == 0xFFFF;
+}
+
+
+/** \brief Check if 32 code units are identical.
+ */
+AUTOCOM_TARGET_AVX2
+inline bool equalAvx2(const uint16_t *left,
+    const uint16_t *right)
+{
+    const __m256i l0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left));
+    const __m256i l1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + 16));
+    const __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right));
+    const __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + 16));
+    const __m256i diff = _mm256_or_si256(_mm256_xor_si256(l0, r0), _mm256_xor_si256(l1, r1));
+    return _mm256_testz_si256(diff, diff) != 0;
+}
+
+
+/** \brief Check if 32 code units are identical, ignoring ASCII case.
+ */
+AUTOCOM_TARGET_AVX2
+inline bool equalNoCaseAvx2(const uint16_t *left,
+    const uint16_t *right)
+{
+    const __m256i l0 = upperAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(left)));
+    const __m256i l1 = upperAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + 16)));
+    const __m256i r0 = upperAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(right)));
+    const __m256i r1 = upperAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + 16)));
+    const __m256i diff = _mm256_or_si256(_mm256_xor_si256(l0, r0), _mm256_xor_si256(l1, r1));
+    return _mm256_testz_si256(diff, diff) != 0;
+}
+
+
+/** \brief Fold 16 code units to ASCII uppercase.
+ */
+AUTOCOM_TARGET_SSE2
+inline void upperSse2(const uint16_t *src,
+    uint16_t *dst)
+{
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), upperSse2(lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), upperSse2(hi));
+}
+
+
+/** \brief Fold 32 code units to ASCII uppercase.
+ */
+AUTOCOM_TARGET_AVX2
+inline void upperAvx2(const uint16_t *src,
+    uint16_t *dst)
+{
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 16));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), upperAvx2(lo));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 16), upperAvx2(hi));
+}
+
+
+/** \brief Get a bitmask of bytes which are at least bound.
+ */
+AUTOCOM_TARGET_SSE2
+inline uint64_t atLeastSse2(const __m128i v,
+    const uint8_t bound)
+{
+    const __m128i b = _mm_set1_epi8(static_cast<char>(bound));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, b), v)));
+}
+
+
+/** \brief Get a bitmask of bytes which equal value.
+ */
+AUTOCOM_TARGET_SSE2
+inline uint64_t equalBytesSse2(const __m128i v,
+    const uint8_t value)
+{
+    const __m128i b = _mm_set1_epi8(static_cast<char>(value));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, b)));
+}
+
+
+/** \brief Get a bitmask of 16 code units from two 16-bit comparisons.
+ */
+AUTOCOM_TARGET_SSE2
+inline uint64_t movemask16Sse2(const __m128i lo,
+    const __m128i hi)
+{
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(lo, hi)));
+}
+
+
+/** \brief Classify 16 bytes of UTF-8.
+ */
+AUTOCOM_TARGET_SSE2
+inline Utf8Masks utf8MasksSse2(const __m128i v)
+{
+    return {
+        static_cast<uint32_t>(_mm_movemask_epi8(v)),
+        atLeastSse2(v, 0xA0),
+        atLeastSse2(v, 0xC0),
+        atLeastSse2(v, 0xC2),
+        atLeastSse2(v, 0xE0),
+        atLeastSse2(v, 0xF0),
+        equalBytesSse2(v, 0xE0),
+        equalBytesSse2(v, 0xED),
+    };
+}
+
+
+/** \brief Classify 16 code units of UTF-16.
+ */
+AUTOCOM_TARGET_SSE2
+inline Utf16Masks utf16MasksSse2(const __m128i lo,
+    const __m128i hi)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i plane = _mm_set1_epi16(static_cast<short>(0xF800));
+    const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+    const __m128i planeLo = _mm_and_si128(lo, plane);
+    const __m128i planeHi = _mm_and_si128(hi, plane);
+    const uint64_t narrow = movemask16Sse2(_mm_cmpeq_epi16(_mm_and_si128(lo, ascii), zero), _mm_cmpeq_epi16(_mm_and_si128(hi, ascii), zero));
+    const uint64_t wide = movemask16Sse2(_mm_cmpeq_epi16(planeLo, zero), _mm_cmpeq_epi16(planeHi, zero));
+
+    return {
+        ~narrow & 0xFFFF,
+        ~wide & 0xFFFF,
+        movemask16Sse2(_mm_cmpeq_epi16(planeLo, surrogate), _mm_cmpeq_epi16(planeHi, surrogate)),
+    };
+}
+
+
+/** \brief Decode 8 lead bytes to UTF-16, from the lead bytes and the
+ *  next two bytes in 16-bit lanes.
+ */
+AUTOCOM_TARGET_SSE2
+inline __m128i decodeSse2(const __m128i b,
+    const __m128i n1,
+    const __m128i n2)
+{
+    const __m128i mask = _mm_set1_epi16(0x3F);
+    const __m128i c1 = _mm_and_si128(n1, mask);
+    const __m128i c2 = _mm_and_si128(n2, mask);
+    const __m128i is3 = _mm_cmpgt_epi16(b, _mm_set1_epi16(0xDF));
+    const __m128i is2 = _mm_andnot_si128(is3, _mm_cmpgt_epi16(b, _mm_set1_epi16(0xBF)));
+    const __m128i two = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b, _mm_set1_epi16(0x1F)), 6), c1);
+    const __m128i three = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(b, 12), _mm_slli_epi16(c1, 6)), c2);
+    const __m128i one = _mm_andnot_si128(_mm_or_si128(is2, is3), b);
+
+    return _mm_or_si128(one, _mm_or_si128(_mm_and_si128(is2, two), _mm_and_si128(is3, three)));
+}
+
+
+/** \brief Encode 4 code units in 32-bit lanes as UTF-8, lead byte first.
+ */
+AUTOCOM_TARGET_SSE2
+inline __m128i encodeSse2(const __m128i x)
+{
+    const __m128i mask = _mm_set1_epi32(0x3F);
+    const __m128i low = _mm_and_si128(x, mask);
+    const __m128i middle = _mm_and_si128(_mm_srli_epi32(x, 6), mask);
+    const __m128i two = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(x, 6), _mm_slli_epi32(low, 8)), _mm_set1_epi32(0x80C0));
+    const __m128i three = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(x, 12), _mm_slli_epi32(middle, 8)), _mm_or_si128(_mm_slli_epi32(low, 16), _mm_set1_epi32(0x8080E0)));
+    const __m128i is2 = _mm_cmpgt_epi32(x, _mm_set1_epi32(0x7F));
+    const __m128i is3 = _mm_cmpgt_epi32(x, _mm_set1_epi32(0x7FF));
+    const __m128i one = _mm_andnot_si128(is2, x);
+
+    return _mm_or_si128(one, _mm_or_si128(_mm_and_si128(_mm_andnot_si128(is3, is2), two), _mm_and_si128(is3, three)));
+}
+
+
+/** \brief Convert the leading 1 to 3-byte characters of 16 bytes to UTF-16.
+ *
+ *  SSE2 has no byte shuffle, so the decoded lanes are packed with a
+ *  branch-free store loop.
+ */
+AUTOCOM_TARGET_SSE2
+inline size_t expandSse2(const uint8_t *src,
+    uint16_t *&dst)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const Utf8Prefix prefix = utf8Prefix(utf8MasksSse2(v), 16);
+    if (!prefix.length) {
+        return 0;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i n1 = _mm_srli_si128(v, 1);
+    const __m128i n2 = _mm_srli_si128(v, 2);
+    alignas(16) uint16_t units[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(units), decodeSse2(_mm_unpacklo_epi8(v, zero), _mm_unpacklo_epi8(n1, zero), _mm_unpacklo_epi8(n2, zero)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(units + 8), decodeSse2(_mm_unpackhi_epi8(v, zero), _mm_unpackhi_epi8(n1, zero), _mm_unpackhi_epi8(n2, zero)));
+
+    size_t count = 0;
+    for (unsigned i = 0; i < 16; ++i) {
+        dst[count] = units[i];
+        count += (prefix.lead >> i) & 1;
+    }
+    dst += count;
+
+    return prefix.length;
+}
+
+
+/** \brief Convert the leading non-surrogate code units of 16 to UTF-8.
+ *
+ *  Packed like expandSse2, each character is stored as 4 bytes and
+ *  the output advances by its length.
+ */
+AUTOCOM_TARGET_SSE2
+inline size_t compressSse2(const uint16_t *src,
+    uint8_t *&dst)
+{
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+    const Utf16Prefix prefix = utf16Prefix(utf16MasksSse2(lo, hi), 16);
+    if (!prefix.length) {
+        return 0;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    alignas(16) uint32_t words[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(words), encodeSse2(_mm_unpacklo_epi16(lo, zero)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(words + 4), encodeSse2(_mm_unpackhi_epi16(lo, zero)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(words + 8), encodeSse2(_mm_unpacklo_epi16(hi, zero)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(words + 12), encodeSse2(_mm_unpackhi_epi16(hi, zero)));
+
+    for (size_t i = 0; i < prefix.length; ++i) {
+        std::memcpy(dst, words + i, 4);
+        dst += 1 + ((prefix.ge80 >> i) & 1) + ((prefix.ge800 >> i) & 1);
+    }
+
+    return prefix.length;
+}
+
+
+/** \brief Count UTF-16 code units for the leading characters of 16 bytes.
+ */
+AUTOCOM_TARGET_SSE2
+inline size_t measureSse2(const uint8_t *src,
+    size_t &length)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const Utf8Prefix prefix = utf8Prefix(utf8MasksSse2(v), 16);
+    length += popcount(prefix.lead);
+
+    return prefix.length;
+}
+
+
+/** \brief Count UTF-8 bytes for the leading code units of 16.
+ */
+AUTOCOM_TARGET_SSE2
+inline size_t measureSse2(const uint16_t *src,
+    size_t &length)
+{
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+    const Utf16Prefix prefix = utf16Prefix(utf16MasksSse2(lo, hi), 16);
+    length += prefix.length + popcount(prefix.ge80) + popcount(prefix.ge800);
+
+    return prefix.length;
+}
+
+
+/** \brief Get a bitmask of bytes which are at least bound.
+ */
+AUTOCOM_TARGET_AVX2
+inline uint64_t atLeastAvx2(const __m256i v,
+    const uint8_t bound)
+{
+    const __m256i b = _mm256_set1_epi8(static_cast<char>(bound));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, b), v)));
+}
+
+
+/** \brief Get a bitmask of bytes which equal value.
+ */
+AUTOCOM_TARGET_AVX2
+inline uint64_t equalBytesAvx2(const __m256i v,
+    const uint8_t value)
+{
+    const __m256i b = _mm256_set1_epi8(static_cast<char>(value));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, b)));
+}
+
+
+/** \brief Get a bitmask of 32 code units from two 16-bit comparisons.
+ */
+AUTOCOM_TARGET_AVX2
+inline uint64_t movemask16Avx2(const __m256i lo,
+    const __m256i hi)
+{
+    // packs interleaves the 128-bit lanes, restore their order
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8);
+    return static_cast<uint32_t>(_mm256_movemask_epi8(packed));
+}
+
+
+/** \brief Classify 32 bytes of UTF-8.
+ */
+AUTOCOM_TARGET_AVX2
+inline Utf8Masks utf8MasksAvx2(const __m256i v)
+{
+    return {
+        static_cast<uint32_t>(_mm256_movemask_epi8(v)),
+        atLeastAvx2(v, 0xA0),
+        atLeastAvx2(v, 0xC0),
+        atLeastAvx2(v, 0xC2),
+        atLeastAvx2(v, 0xE0),
+        atLeastAvx2(v, 0xF0),
+        equalBytesAvx2(v, 0xE0),
+        equalBytesAvx2(v, 0xED),
+    };
+}
+
+
+/** \brief Classify 32 code units of UTF-16.
+ */
+AUTOCOM_TARGET_AVX2
+inline Utf16Masks utf16MasksAvx2(const __m256i lo,
+    const __m256i hi)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ascii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+    const __m256i plane = _mm256_set1_epi16(static_cast<short>(0xF800));
+    const __m256i surrogate = _mm256_set1_epi16(static_cast<short>(0xD800));
+    const __m256i planeLo = _mm256_and_si256(lo, plane);
+    const __m256i planeHi = _mm256_and_si256(hi, plane);
+    const uint64_t narrow = movemask16Avx2(_mm256_cmpeq_epi16(_mm256_and_si256(lo, ascii), zero), _mm256_cmpeq_epi16(_mm256_and_si256(hi, ascii), zero));
+    const uint64_t wide = movemask16Avx2(_mm256_cmpeq_epi16(planeLo, zero), _mm256_cmpeq_epi16(planeHi, zero));
+
+    return {
+        ~narrow & 0xFFFFFFFF,
+        ~wide & 0xFFFFFFFF,
+        movemask16Avx2(_mm256_cmpeq_epi16(planeLo, surrogate), _mm256_cmpeq_epi16(planeHi, surrogate)),
+    };
+}
+
+
+/** \brief Decode 16 lead bytes to UTF-16, see decodeSse2.
+ */
+AUTOCOM_TARGET_AVX2
+inline __m256i decodeAvx2(const __m256i b,
+    const __m256i n1,
+    const __m256i n2)
+{
+    const __m256i mask = _mm256_set1_epi16(0x3F);
+    const __m256i c1 = _mm256_and_si256(n1, mask);
+    const __m256i c2 = _mm256_and_si256(n2, mask);
+    const __m256i is3 = _mm256_cmpgt_epi16(b, _mm256_set1_epi16(0xDF));
+    const __m256i is2 = _mm256_andnot_si256(is3, _mm256_cmpgt_epi16(b, _mm256_set1_epi16(0xBF)));
+    const __m256i two = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(b, _mm256_set1_epi16(0x1F)), 6), c1);
+    const __m256i three = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(b, 12), _mm256_slli_epi16(c1, 6)), c2);
+    const __m256i one = _mm256_andnot_si256(_mm256_or_si256(is2, is3), b);
+
+    return _mm256_or_si256(one, _mm256_or_si256(_mm256_and_si256(is2, two), _mm256_and_si256(is3, three)));
+}
+
+
+/** \brief Encode 8 code units in 32-bit lanes as UTF-8, see encodeSse2.
+ */
+AUTOCOM_TARGET_AVX2
+inline __m256i encodeAvx2(const __m256i x)
+{
+    const __m256i mask = _mm256_set1_epi32(0x3F);
+    const __m256i low = _mm256_and_si256(x, mask);
+    const __m256i middle = _mm256_and_si256(_mm256_srli_epi32(x, 6), mask);
+    const __m256i two = _mm256_or_si256(_mm256_or_si256(_mm256_srli_epi32(x, 6), _mm256_slli_epi32(low, 8)), _mm256_set1_epi32(0x80C0));
+    const __m256i three = _mm256_or_si256(_mm256_or_si256(_mm256_srli_epi32(x, 12), _mm256_slli_epi32(middle, 8)), _mm256_or_si256(_mm256_slli_epi32(low, 16), _mm256_set1_epi32(0x8080E0)));
+    const __m256i is2 = _mm256_cmpgt_epi32(x, _mm256_set1_epi32(0x7F));
+    const __m256i is3 = _mm256_cmpgt_epi32(x, _mm256_set1_epi32(0x7FF));
+    const __m256i one = _mm256_andnot_si256(is2, x);
+
+    return _mm256_or_si256(one, _mm256_or_si256(_mm256_and_si256(_mm256_andnot_si256(is3, is2), two), _mm256_and_si256(is3, three)));
+}
+
+
+/** \brief Store the kept lanes of 8 code units, and advance dst.
+ */
+AUTOCOM_TARGET_AVX2
+inline void packUnitsAvx2(const __m128i units,
+    const uint64_t keep,
+    uint16_t *&dst)
+{
+    const uint8_t mask = static_cast<uint8_t>(keep);
+    const __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(UNIT_SHUFFLES.shuffle[mask]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(units, shuffle));
+    dst += UNIT_SHUFFLES.count[mask];
+}
+
+
+/** \brief Store the UTF-8 bytes of 4 encoded code units, and advance dst.
+ *
+ *  `offset` is the position of the first code unit in the prefix.
+ */
+AUTOCOM_TARGET_AVX2
+inline void packBytesAvx2(const __m128i words,
+    const Utf16Prefix &prefix,
+    const unsigned offset,
+    uint8_t *&dst)
+{
+    const unsigned index = spread(prefix.valid >> offset) + spread(prefix.ge80 >> offset) + spread(prefix.ge800 >> offset);
+    const __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(BYTE_SHUFFLES.shuffle[index]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(words, shuffle));
+    dst += BYTE_SHUFFLES.count[index];
+}
+
+
+/** \brief Convert the leading 1 to 3-byte characters of 32 bytes to UTF-16.
+ */
+AUTOCOM_TARGET_AVX2
+inline size_t expandAvx2(const uint8_t *src,
+    uint16_t *&dst)
+{
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    const Utf8Prefix prefix = utf8Prefix(utf8MasksAvx2(v), 32);
+    if (!prefix.length) {
+        return 0;
+    }
+
+    // alignr shifts within 128-bit lanes, so carry in the upper lane
+    const __m256i upper = _mm256_permute2x128_si256(v, v, 0x81);
+    const __m256i n1 = _mm256_alignr_epi8(upper, v, 1);
+    const __m256i n2 = _mm256_alignr_epi8(upper, v, 2);
+    const __m256i lo = decodeAvx2(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(n1)), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(n2)));
+    const __m256i hi = decodeAvx2(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(n1, 1)), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(n2, 1)));
+
+    packUnitsAvx2(_mm256_castsi256_si128(lo), prefix.lead, dst);
+    packUnitsAvx2(_mm256_extracti128_si256(lo, 1), prefix.lead >> 8, dst);
+    packUnitsAvx2(_mm256_castsi256_si128(hi), prefix.lead >> 16, dst);
+    packUnitsAvx2(_mm256_extracti128_si256(hi, 1), prefix.lead >> 24, dst);
+
+    return prefix.length;
+}
+
+
+/** \brief Convert the leading non-surrogate code units of 32 to UTF-8.
+ */
+AUTOCOM_TARGET_AVX2
+inline size_t compressAvx2(const uint16_t *src,
+    uint8_t *&dst)
+{
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 16));
+    const Utf16Prefix prefix = utf16Prefix(utf16MasksAvx2(lo, hi), 32);
+    if (!prefix.length) {
+        return 0;
+    }
+
+    const __m128i quarters[] = {
+        _mm256_castsi256_si128(lo),
+        _mm256_extracti128_si256(lo, 1),
+        _mm256_castsi256_si128(hi),
+        _mm256_extracti128_si256(hi, 1),
+    };
+    for (unsigned i = 0; i < 4 && 8 * i < prefix.length; ++i) {
+        const __m256i words = encodeAvx2(_mm256_cvtepu16_epi32(quarters[i]));
+        packBytesAvx2(_mm256_castsi256_si128(words), prefix, 8 * i, dst);
+        packBytesAvx2(_mm256_extracti128_si256(words, 1), prefix, 8 * i + 4, dst);
+    }
+
+    return prefix.length;
+}
+
+
+/** \brief Count UTF-16 code units for the leading characters of 32 bytes.
+ */
+AUTOCOM_TARGET_AVX2
+inline size_t measureAvx2(const uint8_t *src,
+    size_t &length)
+{
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    const Utf8Prefix prefix = utf8Prefix(utf8MasksAvx2(v), 32);
+    length += popcount(prefix.lead);
+
+    return prefix.length;
+}
+
+
+/** \brief Count UTF-8 bytes for the leading code units of 32.
+ */
+AUTOCOM_TARGET_AVX2
+inline size_t measureAvx2(const uint16_t *src,
+    size_t &length)
+{
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 16));
+    const Utf16Prefix prefix = utf16Prefix(utf16MasksAvx2(lo, hi), 32);
+    length += prefix.length + popcount(prefix.ge80) + popcount(prefix.ge800);
+
+    return prefix.length;
+}
+
+
+AUTOCOM_UTF8_TO_UTF16_KERNEL(utf8To16Sse2, AUTOCOM_TARGET_SSE2, 16, widenSse2, expandSse2)
+AUTOCOM_UTF16_TO_UTF8_KERNEL(utf16To8Sse2, AUTOCOM_TARGET_SSE2, 16, narrowSse2, compressSse2)
+AUTOCOM_UTF8_TO_UTF16_KERNEL(utf8To16Avx2, AUTOCOM_TARGET_AVX2, 32, widenAvx2, expandAvx2)
+AUTOCOM_UTF16_TO_UTF8_KERNEL(utf16To8Avx2, AUTOCOM_TARGET_AVX2, 32, narrowAvx2, compressAvx2)
+AUTOCOM_LENGTH_KERNEL(utf8To16LengthSse2, AUTOCOM_TARGET_SSE2, uint8_t, 16, measureSse2, utf8To16CharLength)
+AUTOCOM_LENGTH_KERNEL(utf16To8LengthSse2, AUTOCOM_TARGET_SSE2, uint16_t, 16, measureSse2, utf16To8CharLength)
+AUTOCOM_LENGTH_KERNEL(utf8To16LengthAvx2, AUTOCOM_TARGET_AVX2, uint8_t, 32, measureAvx2, utf8To16CharLength)
+AUTOCOM_LENGTH_KERNEL(utf16To8LengthAvx2, AUTOCOM_TARGET_AVX2, uint16_t, 32, measureAvx2, utf16To8CharLength)
+AUTOCOM_ASCII_LENGTH_KERNEL(asciiLengthSse2, AUTOCOM_TARGET_SSE2, uint8_t, 16, asciiSse2)
+AUTOCOM_ASCII_LENGTH_KERNEL(asciiLengthSse2, AUTOCOM_TARGET_SSE2, uint16_t, 16, asciiSse2)
+AUTOCOM_ASCII_LENGTH_KERNEL(asciiLengthAvx2, AUTOCOM_TARGET_AVX2, uint8_t, 32, asciiAvx2)
+AUTOCOM_ASCII_LENGTH_KERNEL(asciiLengthAvx2, AUTOCOM_TARGET_AVX2, uint16_t, 32, asciiAvx2)
+AUTOCOM_ASCII_COPY_KERNEL(widenAsciiSse2, AUTOCOM_TARGET_SSE2, uint8_t, uint16_t, 16, widenSse2)
+AUTOCOM_ASCII_COPY_KERNEL(narrowAsciiSse2, AUTOCOM_TARGET_SSE2, uint16_t, uint8_t, 16, narrowSse2)
+AUTOCOM_ASCII_COPY_KERNEL(widenAsciiAvx2, AUTOCOM_TARGET_AVX2, uint8_t, uint16_t, 32, widenAvx2)
+AUTOCOM_ASCII_COPY_KERNEL(narrowAsciiAvx2, AUTOCOM_TARGET_AVX2, uint16_t, uint8_t, 32, narrowAvx2)
+AUTOCOM_MISMATCH_KERNEL(mismatchSse2, AUTOCOM_TARGET_SSE2, 16, equalSse2, sameChar)
+AUTOCOM_MISMATCH_KERNEL(mismatchNoCaseSse2, AUTOCOM_TARGET_SSE2, 16, equalNoCaseSse2, sameCharNoCase)
+AUTOCOM_MISMATCH_KERNEL(mismatchAvx2, AUTOCOM_TARGET_AVX2, 32, equalAvx2, sameChar)
+AUTOCOM_MISMATCH_KERNEL(mismatchNoCaseAvx2, AUTOCOM_TARGET_AVX2, 32, equalNoCaseAvx2, sameCharNoCase)
+AUTOCOM_UPPER_KERNEL(upperAsciiSse2, AUTOCOM_TARGET_SSE2, 16, upperSse2)
+AUTOCOM_UPPER_KERNEL(upperAsciiAvx2, AUTOCOM_TARGET_AVX2, 32, upperAvx2)
+
+#endif          // X86
+
+// NEON
+// ----
+
+#if defined(AUTOCOM_SIMD_NEON)
+
+
+/** \brief Check if 16 bytes are ASCII.
+ */
+inline bool asciiNeon(const uint8_t *src)
+{
+    return vmaxvq_u8(vld1q_u8(src)) < 0x80;
+}
+
+
+/** \brief Check if 16 code units are ASCII.
+ */
+inline bool asciiNeon(const uint16_t *src)
+{
+    return vmaxvq_u16(vorrq_u16(vld1q_u16(src), vld1q_u16(src + 8))) < 0x80;
+}
+
+
+/** \brief Widen 16 ASCII bytes to UTF-16.
+ */
+inline bool widenNeon(const uint8_t *src,
+    uint16_t *dst)
+{
+    const uint8x16_t v = vld1q_u8(src);
+    if (vmaxvq_u8(v) >= 0x80) {
+        return false;
+    }
+
+    vst1q_u16(dst, vmovl_u8(vget_low_u8(v)));
+    vst1q_u16(dst + 8, vmovl_u8(vget_high_u8(v)));
+
+    return true;
+}
+
+
+/** \brief Narrow 16 ASCII code units to UTF-8.
+ */
+inline bool narrowNeon(const uint16_t *src,
+    uint8_t *dst)
+{
+    const uint16x8_t lo = vld1q_u16(src);
+    const uint16x8_t hi = vld1q_u16(src + 8);
+    if (vmaxvq_u16(vorrq_u16(lo, hi)) >= 0x80) {
+        return false;
+    }
+
+    vst1q_u8(dst, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+
+    return true;
+}
+
+
+/** \brief Fold 8 code units to ASCII uppercase.
+ */
+inline uint16x8_t upperNeon(const uint16x8_t v)
+{
+    const uint16x8_t lower = vcltq_u16(vsubq_u16(v, vdupq_n_u16('a')), vdupq_n_u16(26));
+    return vsubq_u16(v, vandq_u16(lower, vdupq_n_u16(0x20)));
+}
+
+
+/** \brief Check if 16 code units are identical.
+ */
+inline bool equalNeon(const uint16_t *left,
+    const uint16_t *right)
+{
+    const uint16x8_t lo = vceqq_u16(vld1q_u16(left), vld1q_u16(right));
+    const uint16x8_t hi = vceqq_u16(vld1q_u16(left + 8), vld1q_u16(right + 8));
+    return vminvq_u16(vandq_u16(lo, hi)) == 0xFFFF;
+}
+
+
+/** \brief Check if 16 code units are identical, ignoring ASCII case.
+ */
+inline bool equalNoCaseNeon(const uint16_t *left,
+    const uint16_t *right)
+{
+    const uint16x8_t lo = vceqq_u16(upperNeon(vld1q_u16(left)), upperNeon(vld1q_u16(right)));
+    const uint16x8_t hi = vceqq_u16(upperNeon(vld1q_u16(left + 8)), upperNeon(vld1q_u16(right + 8)));
+    return vminvq_u16(vandq_u16(lo, hi)) == 0xFFFF;
+}
+
+
+/** \brief Fold 16 code units to ASCII uppercase.
+ */
+inline void upperNeon(const uint16_t *src,
+    uint16_t *dst)
+{
+    vst1q_u16(dst, upperNeon(vld1q_u16(src)));
+    vst1q_u16(dst + 8, upperNeon(vld1q_u16(src + 8)));
+}
+
+
+/** \brief Get a bitmask of 16 bytes from a comparison.
+ *
+ *  NEON has no movemask, so weight each byte by its bit and add
+ *  each half.
+ */
+inline uint64_t movemaskNeon(const uint8x16_t v)
+{
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits = vandq_u8(v, vld1q_u8(weights));
+    return vaddv_u8(vget_low_u8(bits)) | (static_cast<uint64_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+}
+
+
+/** \brief Get a bitmask of 16 code units from two 16-bit comparisons.
+ */
+inline uint64_t movemask16Neon(const uint16x8_t lo,
+    const uint16x8_t hi)
+{
+    return movemaskNeon(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+}
+
+
+/** \brief Classify 16 bytes of UTF-8.
+ */
+inline Utf8Masks utf8MasksNeon(const uint8x16_t v)
+{
+    return {
+        movemaskNeon(vcgeq_u8(v, vdupq_n_u8(0x80))),
+        movemaskNeon(vcgeq_u8(v, vdupq_n_u8(0xA0))),
+        movemaskNeon(vcgeq_u8(v, vdupq_n_u8(0xC0))),
+        movemaskNeon(vcgeq_u8(v, vdupq_n_u8(0xC2))),
+        movemaskNeon(vcgeq_u8(v, vdupq_n_u8(0xE0))),
+        movemaskNeon(vcgeq_u8(v, vdupq_n_u8(0xF0))),
+        movemaskNeon(vceqq_u8(v, vdupq_n_u8(0xE0))),
+        movemaskNeon(vceqq_u8(v, vdupq_n_u8(0xED))),
+    };
+}
+
+
+/** \brief Classify 16 code units of UTF-16.
+ */
+inline Utf16Masks utf16MasksNeon(const uint16x8_t lo,
+    const uint16x8_t hi)
+{
+    const uint16x8_t plane = vdupq_n_u16(0xF800);
+    const uint16x8_t surrogate = vdupq_n_u16(0xD800);
+
+    return {
+        movemask16Neon(vcgeq_u16(lo, vdupq_n_u16(0x80)), vcgeq_u16(hi, vdupq_n_u16(0x80))),
+        movemask16Neon(vcgeq_u16(lo, vdupq_n_u16(0x800)), vcgeq_u16(hi, vdupq_n_u16(0x800))),
+        movemask16Neon(vceqq_u16(vandq_u16(lo, plane), surrogate), vceqq_u16(vandq_u16(hi, plane), surrogate)),
+    };
+}
+
+
+/** \brief Decode 8 lead bytes to UTF-16, from the lead bytes and the
+ *  next two bytes in 16-bit lanes.
+ */
+inline uint16x8_t decodeNeon(const uint16x8_t b,
+    const uint16x8_t n1,
+    const uint16x8_t n2)
+{
+    const uint16x8_t mask = vdupq_n_u16(0x3F);
+    const uint16x8_t c1 = vandq_u16(n1, mask);
+    const uint16x8_t c2 = vandq_u16(n2, mask);
+    const uint16x8_t two = vorrq_u16(vshlq_n_u16(vandq_u16(b, vdupq_n_u16(0x1F)), 6), c1);
+    const uint16x8_t three = vorrq_u16(vorrq_u16(vshlq_n_u16(b, 12), vshlq_n_u16(c1, 6)), c2);
+    const uint16x8_t is2 = vcgtq_u16(b, vdupq_n_u16(0xBF));
+    const uint16x8_t is3 = vcgtq_u16(b, vdupq_n_u16(0xDF));
+
+    return vbslq_u16(is3, three, vbslq_u16(is2, two, b));
+}
+
+
+/** \brief Encode 4 code units in 32-bit lanes as UTF-8, lead byte first.
+ */
+inline uint32x4_t encodeNeon(const uint32x4_t x)
+{
+    const uint32x4_t mask = vdupq_n_u32(0x3F);
+    const uint32x4_t low = vandq_u32(x, mask);
+    const uint32x4_t middle = vandq_u32(vshrq_n_u32(x, 6), mask);
+    const uint32x4_t two = vorrq_u32(vorrq_u32(vshrq_n_u32(x, 6), vshlq_n_u32(low, 8)), vdupq_n_u32(0x80C0));
+    const uint32x4_t three = vorrq_u32(vorrq_u32(vshrq_n_u32(x, 12), vshlq_n_u32(middle, 8)), vorrq_u32(vshlq_n_u32(low, 16), vdupq_n_u32(0x8080E0)));
+    const uint32x4_t is2 = vcgtq_u32(x, vdupq_n_u32(0x7F));
+    const uint32x4_t is3 = vcgtq_u32(x, vdupq_n_u32(0x7FF));
+
+    return vbslq_u32(is3, three, vbslq_u32(is2, two, x));
+}
+
+
+/** \brief Store the kept lanes of 8 code units, and advance dst.
+ */
+inline void packUnitsNeon(const uint16x8_t units,
+    const uint64_t keep,
+    uint16_t *&dst)
+{
+    const uint8_t mask = static_cast<uint8_t>(keep);
+    const uint8x16_t packed = vqtbl1q_u8(vreinterpretq_u8_u16(units), vld1q_u8(UNIT_SHUFFLES.shuffle[mask]));
+    vst1q_u16(dst, vreinterpretq_u16_u8(packed));
+    dst += UNIT_SHUFFLES.count[mask];
+}
+
+
+/** \brief Store the UTF-8 bytes of 4 encoded code units, and advance dst.
+ *
+ *  `offset` is the position of the first code unit in the prefix.
+ */
+inline void packBytesNeon(const uint32x4_t words,
+    const Utf16Prefix &prefix,
+    const unsigned offset,
+    uint8_t *&dst)
+{
+    const unsigned index = spread(prefix.valid >> offset) + spread(prefix.ge80 >> offset) + spread(prefix.ge800 >> offset);
+    const uint8x16_t packed = vqtbl1q_u8(vreinterpretq_u8_u32(words), vld1q_u8(BYTE_SHUFFLES.shuffle[index]));
+    vst1q_u8(dst, packed);
+    dst += BYTE_SHUFFLES.count[index];
+}
+
+
+/** \brief Convert the leading 1 to 3-byte characters of 16 bytes to UTF-16.
+ */
+inline size_t expandNeon(const uint8_t *src,
+    uint16_t *&dst)
+{
+    const uint8x16_t v = vld1q_u8(src);
+    const Utf8Prefix prefix = utf8Prefix(utf8MasksNeon(v), 16);
+    if (!prefix.length) {
+        return 0;
+    }
+
+    const uint8x16_t zero = vdupq_n_u8(0);
+    const uint8x16_t n1 = vextq_u8(v, zero, 1);
+    const uint8x16_t n2 = vextq_u8(v, zero, 2);
+    const uint16x8_t lo = decodeNeon(vmovl_u8(vget_low_u8(v)), vmovl_u8(vget_low_u8(n1)), vmovl_u8(vget_low_u8(n2)));
+    const uint16x8_t hi = decodeNeon(vmovl_u8(vget_high_u8(v)), vmovl_u8(vget_high_u8(n1)), vmovl_u8(vget_high_u8(n2)));
+    packUnitsNeon(lo, prefix.lead, dst);
+    packUnitsNeon(hi, prefix.lead >> 8, dst);
+
+    return prefix.length;
+}
+
+
+/** \brief Convert the leading non-surrogate code units of 16 to UTF-8.
+ */
+inline size_t compressNeon(const uint16_t *src,
+    uint8_t *&dst)
+{
+    const uint16x8_t lo = vld1q_u16(src);
+    const uint16x8_t hi = vld1q_u16(src + 8);
+    const Utf16Prefix prefix = utf16Prefix(utf16MasksNeon(lo, hi), 16);
+    if (!prefix.length) {
+        return 0;
+    }
+
+    packBytesNeon(encodeNeon(vmovl_u16(vget_low_u16(lo))), prefix, 0, dst);
+    packBytesNeon(encodeNeon(vmovl_u16(vget_high_u16(lo))), prefix, 4, dst);
+    packBytesNeon(encodeNeon(vmovl_u16(vget_low_u16(hi))), prefix, 8, dst);
+    packBytesNeon(encodeNeon(vmovl_u16(vget_high_u16(hi))), prefix, 12, dst);
+
+    return prefix.length;
+}
+
+
+/** \brief Count UTF-16 code units for the leading characters of 16 bytes.
+ */
+inline size_t measureNeon(const uint8_t *src,
+    size_t &length)
+{
+    const Utf8Prefix prefix = utf8Prefix(utf8MasksNeon(vld1q_u8(src)), 16);
+    length += popcount(prefix.lead);
+
+    return prefix.length;
+}
+
+
+/** \brief Count UTF-8 bytes for the leading code units of 16.
+ */
+inline size_t measureNeon(const uint16_t *src,
+    size_t &length)
+{
+    const Utf16Prefix prefix = utf16Prefix(utf16MasksNeon(vld1q_u16(src), vld1q_u16(src + 8)), 16);
+    length += prefix.length + popcount(prefix.ge80) + popcount(prefix.ge800);
+
+    return prefix.length;
+}
+
+
+AUTOCOM_UTF8_TO_UTF16_KERNEL(utf8To16Neon, AUTOCOM_TARGET_NEON, 16, widenNeon, expandNeon)
+AUTOCOM_UTF16_TO_UTF8_KERNEL(utf16To8Neon, AUTOCOM_TARGET_NEON, 16, narrowNeon, compressNeon)
+AUTOCOM_LENGTH_KERNEL(utf8To16LengthNeon, AUTOCOM_TARGET_NEON, uint8_t, 16, measureNeon, utf8To16CharLength)
+AUTOCOM_LENGTH_KERNEL(utf16To8LengthNeon, AUTOCOM_TARGET_NEON, uint16_t, 16, measureNeon, utf16To8CharLength)
+AUTOCOM_ASCII_LENGTH_KERNEL(asciiLengthNeon, AUTOCOM_TARGET_NEON, uint8_t, 16, asciiNeon)
+AUTOCOM_ASCII_LENGTH_KERNEL(asciiLengthNeon, AUTOCOM_TARGET_NEON, uint16_t, 16, asciiNeon)
+AUTOCOM_ASCII_COPY_KERNEL(widenAsciiNeon, AUTOCOM_TARGET_NEON, uint8_t, uint16_t, 16, widenNeon)
+AUTOCOM_ASCII_COPY_KERNEL(narrowAsciiNeon, AUTOCOM_TARGET_NEON, uint16_t, uint8_t, 16, narrowNeon)
+AUTOCOM_MISMATCH_KERNEL(mismatchNeon, AUTOCOM_TARGET_NEON, 16, equalNeon, sameChar)
+AUTOCOM_MISMATCH_KERNEL(mismatchNoCaseNeon, AUTOCOM_TARGET_NEON, 16, equalNoCaseNeon, sameCharNoCase)
+AUTOCOM_UPPER_KERNEL(upperAsciiNeon, AUTOCOM_TARGET_NEON, 16, upperNeon)
+
+#endif          // NEON
+
+// FUNCTIONS
+// ---------
+
+
+/** \brief Check if the host CPU supports the instruction set.
+ */
+bool supported(const Isa isa)
+{
+    switch (isa) {
+        case Isa::SCALAR:
+            return true;
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::SSE2:
+            return cpuSse2();
+        case Isa::AVX2:
+            return cpuAvx2();
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+
+/** \brief Get the best instruction set supported by the host CPU.
+ */
+Isa detect()
+{
+    for (Isa isa: {Isa::AVX2, Isa::NEON, Isa::SSE2}) {
+        if (supported(isa)) {
+            return isa;
+        }
+    }
+
+    return Isa::SCALAR;
+}
+
+
+/** \brief Get the instruction set currently used by the kernels.
+ */
+Isa isa()
+{
+    int value = ACTIVE.load(std::memory_order_relaxed);
+    if (value < 0) {
+        value = static_cast<int>(detect());
+        ACTIVE.store(value, std::memory_order_relaxed);
+    }
+
+    return static_cast<Isa>(value);
+}
+
+
+/** \brief Override the instruction set used by the kernels.
+ */
+void setIsa(const Isa isa)
+{
+    if (!supported(isa)) {
+        throw std::invalid_argument("Instruction set is not supported by host.");
+    }
+    ACTIVE.store(static_cast<int>(isa), std::memory_order_relaxed);
+}
+
+
+/** \brief Get number of leading ASCII bytes in src.
+ */
+size_t asciiLength(const uint8_t *srcBegin,
+    const uint8_t *srcEnd)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return asciiLengthAvx2(srcBegin, srcEnd);
+        case Isa::SSE2:
+            return asciiLengthSse2(srcBegin, srcEnd);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return asciiLengthNeon(srcBegin, srcEnd);
+#endif
+        default:
+            return std::find_if(srcBegin, srcEnd, [](uint8_t c) {
+                return c >= 0x80;
+            }) - srcBegin;
+    }
+}
+
+
+/** \brief Get number of leading ASCII code units in src.
+ */
+size_t asciiLength(const uint16_t *srcBegin,
+    const uint16_t *srcEnd)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return asciiLengthAvx2(srcBegin, srcEnd);
+        case Isa::SSE2:
+            return asciiLengthSse2(srcBegin, srcEnd);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return asciiLengthNeon(srcBegin, srcEnd);
+#endif
+        default:
+            return std::find_if(srcBegin, srcEnd, [](uint16_t c) {
+                return c >= 0x80;
+            }) - srcBegin;
+    }
+}
+
+
+/** \brief Widen ASCII bytes to UTF-16.
+ */
+void widenAscii(const uint8_t *srcBegin,
+    const uint8_t *srcEnd,
+    uint16_t *dst)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return widenAsciiAvx2(srcBegin, srcEnd, dst);
+        case Isa::SSE2:
+            return widenAsciiSse2(srcBegin, srcEnd, dst);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return widenAsciiNeon(srcBegin, srcEnd, dst);
+#endif
+        default:
+            std::copy(srcBegin, srcEnd, dst);
+    }
+}
+
+
+/** \brief Narrow ASCII code units to UTF-8.
+ */
+void narrowAscii(const uint16_t *srcBegin,
+    const uint16_t *srcEnd,
+    uint8_t *dst)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return narrowAsciiAvx2(srcBegin, srcEnd, dst);
+        case Isa::SSE2:
+            return narrowAsciiSse2(srcBegin, srcEnd, dst);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return narrowAsciiNeon(srcBegin, srcEnd, dst);
+#endif
+        default:
+            std::transform(srcBegin, srcEnd, dst, [](uint16_t c) {
+                return static_cast<uint8_t>(c);
+            });
+    }
+}
+
+
+/** \brief Get number of leading code units which are identical.
+ */
+size_t mismatch(const uint16_t *left,
+    const uint16_t *right,
+    const size_t length)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return mismatchAvx2(left, right, length);
+        case Isa::SSE2:
+            return mismatchSse2(left, right, length);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return mismatchNeon(left, right, length);
+#endif
+        default:
+            return std::mismatch(left, left + length, right).first - left;
+    }
+}
+
+
+/** \brief Get number of leading code units which are identical,
+ *  ignoring ASCII case.
+ */
+size_t mismatchNoCase(const uint16_t *left,
+    const uint16_t *right,
+    const size_t length)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return mismatchNoCaseAvx2(left, right, length);
+        case Isa::SSE2:
+            return mismatchNoCaseSse2(left, right, length);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return mismatchNoCaseNeon(left, right, length);
+#endif
+        default:
+            return std::mismatch(left, left + length, right, sameCharNoCase).first - left;
+    }
+}
+
+
+/** \brief Fold ASCII lowercase letters to uppercase.
+ */
+void upperAscii(const uint16_t *srcBegin,
+    const uint16_t *srcEnd,
+    uint16_t *dst)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return upperAsciiAvx2(srcBegin, srcEnd, dst);
+        case Isa::SSE2:
+            return upperAsciiSse2(srcBegin, srcEnd, dst);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return upperAsciiNeon(srcBegin, srcEnd, dst);
+#endif
+        default:
+            std::transform(srcBegin, srcEnd, dst, upperAsciiChar);
+    }
+}
+
+
+/** \brief Get exact number of code units utf8To16 writes for src.
+ *
+ *  Counts 1 to 3-byte characters with the vectorized validator, and
+ *  decodes the remaining characters one at a time.
+ */
+size_t utf8To16Length(const uint8_t *srcBegin,
+    const uint8_t *srcEnd,
+    bool strict)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return utf8To16LengthAvx2(srcBegin, srcEnd, strict);
+        case Isa::SSE2:
+            return utf8To16LengthSse2(srcBegin, srcEnd, strict);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return utf8To16LengthNeon(srcBegin, srcEnd, strict);
+#endif
+        default:
+            return detail::utf8To16Length(srcBegin, srcEnd, strict);
+    }
+}
+
+
+/** \brief Get exact number of code units utf16To8 writes for src.
+ *
+ *  Counts code units up to the next surrogate with the vectorized
+ *  kernels, and decodes the remaining characters one at a time.
+ */
+size_t utf16To8Length(const uint16_t *srcBegin,
+    const uint16_t *srcEnd,
+    bool strict)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return utf16To8LengthAvx2(srcBegin, srcEnd, strict);
+        case Isa::SSE2:
+            return utf16To8LengthSse2(srcBegin, srcEnd, strict);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return utf16To8LengthNeon(srcBegin, srcEnd, strict);
+#endif
+        default:
+            return detail::utf16To8Length(srcBegin, srcEnd, strict);
+    }
+}
+
+
+/** \brief Convert UTF8 to UTF16.
+ */
+size_t utf8To16(const uint8_t *srcBegin,
+    const uint8_t *srcEnd,
+    uint16_t *dstBegin,
+    uint16_t *dstEnd,
+    bool strict)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return utf8To16Avx2(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+        case Isa::SSE2:
+            return utf8To16Sse2(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return utf8To16Neon(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+#endif
+        default:
+            return detail::utf8To16(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+    }
+}
+
+
+/** \brief Convert UTF16 to UTF8.
+ */
+size_t utf16To8(const uint16_t *srcBegin,
+    const uint16_t *srcEnd,
+    uint8_t *dstBegin,
+    uint8_t *dstEnd,
+    bool strict)
+{
+    switch (isa()) {
+#if defined(AUTOCOM_SIMD_X86)
+        case Isa::AVX2:
+            return utf16To8Avx2(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+        case Isa::SSE2:
+            return utf16To8Sse2(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+#elif defined(AUTOCOM_SIMD_NEON)
+        case Isa::NEON:
+            return utf16To8Neon(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+#endif
+        default:
+            return detail::utf16To8(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+    }
+}
+
+// CLEANUP
+// -------
+
+#undef AUTOCOM_UTF8_TO_UTF16_KERNEL
+#undef AUTOCOM_UTF16_TO_UTF8_KERNEL
+#undef AUTOCOM_LENGTH_KERNEL
+#undef AUTOCOM_ASCII_LENGTH_KERNEL
+#undef AUTOCOM_ASCII_COPY_KERNEL
+#undef AUTOCOM_MISMATCH_KERNEL
+#undef AUTOCOM_UPPER_KERNEL
+
+}   /* simd */
+}   /* utf */
+}   /* autocom */
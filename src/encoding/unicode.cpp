@@ -8,9 +8,6 @@
 
 #include "autocom/encoding/unicode.hpp"
 
-#include <cstdlib>
-#include <functional>
-
 
 namespace autocom
 {
@@ -34,21 +31,10 @@ const std::array<uint8_t, 256> UTF8_BYTES = {
 };
 const std::array<uint32_t, 6> UTF8_OFFSETS = {0x00000000UL, 0x00003080UL, 0x000E2080UL, 0x03C82080UL, 0xFA082080UL, 0x82082080UL};
 
-
-// HELPERS
-// -------
-
-
-/** \brief Replace illegal Unicode character if checkStrict is off.
+/** \brief Write implementation for constexpr.
  */
-uint32_t checkStrict(bool strict)
-{
-    constexpr uint32_t replacement = 0x0000FFFD;
-    if (strict) {
-        throw IllegalCharacterError();
-    }
-    return replacement;
-}
+constexpr std::array<uint8_t, 256> Utf8Dfa::CLASSES;
+constexpr std::array<uint8_t, 108> Utf8Dfa::TRANSITIONS;
 
 }   /* detail */
 
@@ -56,136 +42,35 @@ uint32_t checkStrict(bool strict)
 // ---------
 
 
-/** \brief STL wrapper for narrow to wide conversions.
- */
-template <typename C1, typename C2, typename Function>
-std::string toWide(const std::string &string,
-    Function function)
-{
-    // types
-    constexpr size_t size1 = sizeof(C1);
-    constexpr size_t size2 = sizeof(C2);
-
-    // arguments
-    const size_t srclen = string.size() / size1;
-    const size_t dstlen = srclen;
-    auto *src = reinterpret_cast<const C1*>(string.data());
-    auto *srcEnd = src + srclen;
-    auto *dst = reinterpret_cast<C2*>(malloc(dstlen * size2));
-    auto *dstEnd = dst + dstlen;
-
-    size_t out = function(src, srcEnd, dst, dstEnd, true);
-    std::string output(reinterpret_cast<const char*>(dst), out * size2);
-    free(dst);
-
-    return output;
-}
-
-
-/** \brief STL wrapper for wide to narrow conversions.
- */
-template <typename C1, typename C2, typename Function>
-std::string toNarrow(const std::string &string,
-    Function function)
-{
-    // types
-    constexpr size_t size1 = sizeof(C1);
-    constexpr size_t size2 = sizeof(C2);
-
-    // arguments
-    const size_t srclen = string.size() / size1;
-    const size_t dstlen = srclen * 4;
-    auto *src = reinterpret_cast<const C1*>(string.data());
-    auto *srcEnd = src + srclen;
-    auto *dst = reinterpret_cast<C2*>(malloc(dstlen * size2));
-    auto *dstEnd = dst + dstlen;
-
-    size_t out = function(src, srcEnd, dst, dstEnd, true);
-    std::string output(reinterpret_cast<const char*>(dst), out * size2);
-    free(dst);
-
-    return output;
-}
-
-
 /** \brief STL wrapper for utf8To16.
- *
- *  Use lambdas rather than decltype for MSVC compatibility.
  */
 std::string utf8To16(const std::string &string)
 {
-    // types
-    using C1 = uint8_t;
-    using C2 = uint16_t;
-    typedef std::function<size_t(const C1*, const C1*, C2*, C2*, bool)> Fun;
-
-    return toWide<C1, C2, Fun>(string, [](const C1 *srcBegin,
-        const C1 *srcEnd,
-        C2 *dstBegin,
-        C2 *dstEnd,
-        bool strict)
-    {
-        return detail::utf8To16(srcBegin, srcEnd, dstBegin, dstEnd, strict);
-    });
+    return convert<uint8_t, uint16_t>(string);
 }
 
+
 /** \brief STL wrapper for utf8To32.
  */
 std::string utf8To32(const std::string &string)
 {
-    // types
-    using C1 = uint8_t;
-    using C2 = uint32_t;
-    typedef std::function<size_t(const C1*, const C1*, C2*, C2*, bool)> Fun;
-
-    return toWide<C1, C2, Fun>(string, [](const C1 *srcBegin,
-        const C1 *srcEnd,
-        C2 *dstBegin,
-        C2 *dstEnd,
-        bool strict)
-    {
-        return detail::utf8To32(srcBegin, srcEnd, dstBegin, dstEnd, strict);
-    });
+    return convert<uint8_t, uint32_t>(string);
 }
 
 
-/** \brief STL wrapper for utf16To32.
+/** \brief STL wrapper for utf16To8.
  */
-std::string utf16To32(const std::string &string)
+std::string utf16To8(const std::string &string)
 {
-    // types
-    using C1 = uint16_t;
-    using C2 = uint32_t;
-    typedef std::function<size_t(const C1*, const C1*, C2*, C2*, bool)> Fun;
-
-    return toWide<C1, C2, Fun>(string, [](const C1 *srcBegin,
-        const C1 *srcEnd,
-        C2 *dstBegin,
-        C2 *dstEnd,
-        bool strict)
-    {
-        return detail::utf16To32(srcBegin, srcEnd, dstBegin, dstEnd, strict);
-    });
+    return convert<uint16_t, uint8_t>(string);
 }
 
 
-/** \brief STL wrapper for utf16To8.
+/** \brief STL wrapper for utf16To32.
  */
-std::string utf16To8(const std::string &string)
+std::string utf16To32(const std::string &string)
 {
-    // types
-    using C1 = uint16_t;
-    using C2 = uint8_t;
-    typedef std::function<size_t(const C1*, const C1*, C2*, C2*, bool)> Fun;
-
-    return toNarrow<C1, C2, Fun>(string, [](const C1 *srcBegin,
-        const C1 *srcEnd,
-        C2 *dstBegin,
-        C2 *dstEnd,
-        bool strict)
-    {
-        return detail::utf16To8(srcBegin, srcEnd, dstBegin, dstEnd, strict);
-    });
+    return convert<uint16_t, uint32_t>(string);
 }
 
 
@@ -193,19 +78,7 @@ std::string utf16To8(const std::string &string)
  */
 std::string utf32To8(const std::string &string)
 {
-    // types
-    using C1 = uint32_t;
-    using C2 = uint8_t;
-    typedef std::function<size_t(const C1*, const C1*, C2*, C2*, bool)> Fun;
-
-    return toNarrow<C1, C2, Fun>(string, [](const C1 *srcBegin,
-        const C1 *srcEnd,
-        C2 *dstBegin,
-        C2 *dstEnd,
-        bool strict)
-    {
-        return detail::utf32To8(srcBegin, srcEnd, dstBegin, dstEnd, strict);
-    });
+    return convert<uint32_t, uint8_t>(string);
 }
 
 
@@ -213,19 +86,7 @@ std::string utf32To8(const std::string &string)
  */
 std::string utf32To16(const std::string &string)
 {
-    // types
-    using C1 = uint32_t;
-    using C2 = uint16_t;
-    typedef std::function<size_t(const C1*, const C1*, C2*, C2*, bool)> Fun;
-
-    return toNarrow<C1, C2, Fun>(string, [](const C1 *srcBegin,
-        const C1 *srcEnd,
-        C2 *dstBegin,
-        C2 *dstEnd,
-        bool strict)
-    {
-        return detail::utf32To16(srcBegin, srcEnd, dstBegin, dstEnd, strict);
-    });
+    return convert<uint32_t, uint16_t>(string);
 }
 
 }   /* utf */
@@ -8,6 +8,8 @@
 #include "autocom/guid.hpp"
 #include "autocom/encoding/converters.hpp"
 
+#include <cwchar>
+
 
 namespace autocom
 {
@@ -55,13 +57,17 @@ auto TO_LPIID(GUID *guid)
 
 
 /** \brief Open GUID from wide-string identifier.
+ *
+ *  Terminated views are passed through directly, without a copy.
  */
-void Guid::open(const Bstr &string)
+void Guid::open(const BstrView &string)
 {
-    if (!string.empty() && string.front() == L'{') {
-        CLSIDFromString(string, TO_LPCLSID(&id));
+    if (!string.terminated()) {
+        open(string.wstr());
+    } else if (!string.empty() && string.front() == L'{') {
+        CLSIDFromString(string.data(), TO_LPCLSID(&id));
     } else {
-        CLSIDFromProgID(string, TO_LPCLSID(&id));
+        CLSIDFromProgID(string.data(), TO_LPCLSID(&id));
     }
 }
 
@@ -81,6 +87,14 @@ Guid::Guid(const Bstr &string)
 }
 
 
+/** \brief Initializer from non-owning view.
+ */
+Guid::Guid(const BstrView &string)
+{
+    open(string);
+}
+
+
 /** \brief Initializer from C-string.
  */
 Guid::Guid(const char *cstring)
@@ -102,7 +116,7 @@ Guid::Guid(const char *array,
  */
 Guid::Guid(const std::string &string)
 {
-    open(string);
+    open(Bstr(string));
 }
 
 
@@ -110,7 +124,7 @@ Guid::Guid(const std::string &string)
  */
 Guid::Guid(const wchar_t *cstring)
 {
-    open(Bstr(cstring));
+    open(cstring);
 }
 
 
@@ -119,7 +133,7 @@ Guid::Guid(const wchar_t *cstring)
 Guid::Guid(const wchar_t *array,
     const size_t length)
 {
-    open(Bstr(array, length));
+    open(BstrView(array, length));
 }
 
 
@@ -157,7 +171,7 @@ std::string Guid::toProgid()
         return "";
     }
 
-    std::string narrow = NARROW(progid);
+    std::string narrow = NARROW(progid, wcslen(progid));
     CoTaskMemFree(progid);
 
     return narrow;
@@ -190,7 +204,7 @@ std::string Guid::toClsid()
         return "";
     }
 
-    std::string narrow = NARROW(clsid);
+    std::string narrow = NARROW(clsid, wcslen(clsid));
     CoTaskMemFree(clsid);
 
     return narrow;
@@ -201,7 +215,7 @@ std::string Guid::toClsid()
  */
 Guid Guid::fromIid(const std::string &string)
 {
-    return fromIid(WIDE(string));
+    return fromIid(WIDE_SCRATCH(string));
 }
 
 
@@ -226,7 +240,7 @@ std::string Guid::toIid()
         return "";
     }
 
-    std::string narrow = NARROW(iid);
+    std::string narrow = NARROW(iid, wcslen(iid));
     CoTaskMemFree(iid);
 
     return narrow;
@@ -0,0 +1,117 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoCOM
+ *  \brief Interned BSTRs for method and property names.
+ */
+
+#include "autocom/intern.hpp"
+#include "autocom/encoding/converters.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <unordered_map>
+
+
+namespace autocom
+{
+// OBJECTS
+// -------
+
+
+/** \brief Table of interned BSTRs.
+ *
+ *  Keys view the interned strings themselves, so lookups from any
+ *  view need no copy. Lookups take a shared lock, and only inserting
+ *  a new name takes an exclusive lock.
+ */
+struct InternTable
+{
+    std::shared_timed_mutex mutex;
+    std::unordered_map<BstrView, BSTR> strings;
+};
+
+
+/** \brief Get the process-wide table.
+ *
+ *  The table is intentionally leaked, so interned strings stay valid
+ *  during static destruction.
+ */
+InternTable & internTable()
+{
+    static InternTable *table = new InternTable;
+    return *table;
+}
+
+// FUNCTIONS
+// ---------
+
+
+/** \brief Get interned BSTR for a wide name.
+ */
+BSTR INTERN_BSTR(const BstrView &name)
+{
+    InternTable &table = internTable();
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(table.mutex);
+        auto it = table.strings.find(name);
+        if (it != table.strings.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock(table.mutex);
+    auto it = table.strings.find(name);
+    if (it != table.strings.end()) {
+        return it->second;
+    }
+
+    // bypass the BSTR pool, these strings are never freed
+    BSTR bstr = SysAllocStringLen(name.data(), name.size());
+    if (!bstr) {
+        throw std::bad_alloc();
+    }
+    table.strings.emplace(BstrView(bstr), bstr);
+
+    return bstr;
+}
+
+
+/** \brief Get interned BSTR for a UTF-8 name.
+ */
+BSTR INTERN_BSTR(const char *name,
+    const size_t length)
+{
+    const std::wstring &wide = WIDE_SCRATCH(name, length);
+    return INTERN_BSTR(BstrView(wide.data(), wide.size()));
+}
+
+
+/** \brief Get interned BSTR for a UTF-8 C-string.
+ */
+BSTR INTERN_BSTR(const char *name)
+{
+    return INTERN_BSTR(name, strlen(name));
+}
+
+
+/** \brief Get interned BSTR for a UTF-8 string.
+ */
+BSTR INTERN_BSTR(const std::string &name)
+{
+    return INTERN_BSTR(name.data(), name.size());
+}
+
+
+/** \brief Get number of interned BSTRs.
+ */
+size_t internedBstrs()
+{
+    InternTable &table = internTable();
+    std::shared_lock<std::shared_timed_mutex> lock(table.mutex);
+    return table.strings.size();
+}
+
+}   /* autocom */
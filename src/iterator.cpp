@@ -16,7 +16,7 @@ namespace autocom
 
 /** \brief Initializer list constructor.
  */
-Iterator::Iterator(itl::weak_ptr<IEnumVARIANT> ppv):
+Iterator::Iterator(const ComPtr<IEnumVARIANT> &ppv):
     ppv(ppv)
 {}
 
@@ -54,13 +54,14 @@ const DispatchBase * Iterator::operator->() const
 
 
 /** \brief Pre-increment operator.
+ *
+ *  Next returns S_FALSE, which is a success code, past the last item.
  */
 Iterator & Iterator::operator++()
 {
     VARIANT result;
-    ULONG fetched;
-    auto ev = ppv.lock();
-    if (ev && SUCCEEDED(ev->Next(1, &result, &fetched))) {
+    ULONG fetched = 0;
+    if (ppv && ppv->Next(1, &result, &fetched) == S_OK && fetched == 1) {
         dispatch.open(result.pdispVal);
     } else {
         dispatch.open(nullptr);
@@ -85,7 +86,7 @@ Iterator Iterator::operator++(int)
  */
 bool Iterator::operator==(const Iterator& other) const
 {
-    return (ppv.lock() == other.ppv.lock()) && (dispatch == other.dispatch);
+    return (ppv == other.ppv) && (dispatch == other.dispatch);
 }
 
 
@@ -0,0 +1,362 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoCOM
+ *  \brief Pooled BSTR allocation.
+ */
+
+#include "autocom/pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+namespace autocom
+{
+// CONSTANTS
+// ---------
+
+/** Number of size classes, for lengths below 16, 32, 64, 128 and 256.
+ */
+constexpr size_t POOL_CLASSES = 5;
+
+/** Maximum number of cached strings per size class and thread.
+ */
+constexpr size_t POOL_DEPTH = 32;
+
+/** Longest string length which is pooled.
+ */
+constexpr size_t POOL_MAXIMUM = (16 << (POOL_CLASSES - 1)) - 1;
+
+std::atomic<bool> POOL_ENABLED(false);
+
+// HELPERS
+// -------
+
+
+/** \brief Get size class for string length.
+ */
+size_t poolClass(const size_t length)
+{
+    size_t index = 0;
+    for (size_t bound = 16; length >= bound; bound <<= 1) {
+        ++index;
+    }
+
+    return index;
+}
+
+// OBJECTS
+// -------
+
+
+/** \brief Per-thread freelists of cached BSTRs, by size class.
+ *
+ *  A cached string can hold any length up to its length prefix, so
+ *  lookups take the first string in the class which is long enough.
+ */
+struct PoolCache
+{
+    BSTR strings[POOL_CLASSES][POOL_DEPTH];
+    size_t sizes[POOL_CLASSES] = {};
+
+    // only the owning thread writes the counters, so increments
+    // need no read-modify-write
+    std::atomic<size_t> hits;
+    std::atomic<size_t> misses;
+
+    PoolCache();
+    ~PoolCache();
+
+    void hit();
+    void miss();
+
+    BSTR pop(const size_t length);
+    bool push(BSTR bstr);
+    void trim();
+};
+
+
+/** \brief Counters of all live caches, and of threads which exited.
+ *
+ *  The registry is intentionally leaked, like the DISPID registry, so
+ *  threads may exit during static destruction.
+ */
+struct PoolRegistry
+{
+    std::mutex mutex;
+    std::vector<const PoolCache*> caches;
+    BstrPoolCounters exited;
+    BstrPoolCounters reset;
+};
+
+
+/** \brief Get the process-wide registry.
+ */
+PoolRegistry & poolRegistry()
+{
+    static PoolRegistry *registry = new PoolRegistry;
+    return *registry;
+}
+
+
+/** \brief Set once the calling thread's cache is destroyed.
+ *
+ *  Trivially destructible, so it stays readable while later thread
+ *  locals free strings during thread exit.
+ */
+thread_local bool POOL_DESTROYED = false;
+
+
+/** \brief Register cache counters.
+ */
+PoolCache::PoolCache():
+    hits(0),
+    misses(0)
+{
+    PoolRegistry &registry = poolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.caches.push_back(this);
+}
+
+
+/** \brief Free cached strings and keep counters when the thread exits.
+ */
+PoolCache::~PoolCache()
+{
+    trim();
+    POOL_DESTROYED = true;
+
+    PoolRegistry &registry = poolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto &caches = registry.caches;
+    caches.erase(std::find(caches.begin(), caches.end(), this));
+    registry.exited.hits += hits.load(std::memory_order_relaxed);
+    registry.exited.misses += misses.load(std::memory_order_relaxed);
+}
+
+
+/** \brief Count allocation from the cache.
+ */
+void PoolCache::hit()
+{
+    hits.store(hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+/** \brief Count allocation which missed the cache.
+ */
+void PoolCache::miss()
+{
+    misses.store(misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+/** \brief Take a cached string which holds at least `length` characters.
+ *
+ *  \return     Cached string, or null if none fit.
+ */
+BSTR PoolCache::pop(const size_t length)
+{
+    const size_t index = poolClass(length);
+    BSTR *list = strings[index];
+    size_t &size = sizes[index];
+    for (size_t i = 0; i < size; ++i) {
+        if (SysStringLen(list[i]) >= length) {
+            BSTR bstr = list[i];
+            list[i] = list[--size];
+            return bstr;
+        }
+    }
+
+    return nullptr;
+}
+
+
+/** \brief Cache string, evicting the shortest string if the class is full.
+ *
+ *  \return     Whether the pool took ownership of bstr.
+ */
+bool PoolCache::push(BSTR bstr)
+{
+    const size_t length = SysStringLen(bstr);
+    if (length > POOL_MAXIMUM) {
+        return false;
+    }
+
+    const size_t index = poolClass(length);
+    BSTR *list = strings[index];
+    size_t &size = sizes[index];
+    if (size < POOL_DEPTH) {
+        list[size++] = bstr;
+        return true;
+    }
+
+    auto shortest = std::min_element(list, list + size, [](BSTR left, BSTR right) {
+        return SysStringLen(left) < SysStringLen(right);
+    });
+    if (SysStringLen(*shortest) >= length) {
+        return false;
+    }
+    SysFreeString(*shortest);
+    *shortest = bstr;
+
+    return true;
+}
+
+
+/** \brief Free all cached strings.
+ */
+void PoolCache::trim()
+{
+    for (size_t i = 0; i < POOL_CLASSES; ++i) {
+        for (size_t j = 0; j < sizes[i]; ++j) {
+            SysFreeString(strings[i][j]);
+        }
+        sizes[i] = 0;
+    }
+}
+
+
+thread_local PoolCache POOL_CACHE;
+
+
+/** \brief Get the calling thread's cache, if the pool is enabled.
+ *
+ *  \return     Cache, or null if disabled or destroyed during thread exit.
+ */
+PoolCache * poolCache()
+{
+    if (!bstrPool() || POOL_DESTROYED) {
+        return nullptr;
+    }
+    return &POOL_CACHE;
+}
+
+
+/** \brief Sum counters over all threads, since the last reset.
+ *
+ *  \warning    Requires the registry lock.
+ */
+BstrPoolCounters sumPoolCounters(const PoolRegistry &registry)
+{
+    BstrPoolCounters counters = registry.exited;
+    for (const PoolCache *cache: registry.caches) {
+        counters.hits += cache->hits.load(std::memory_order_relaxed);
+        counters.misses += cache->misses.load(std::memory_order_relaxed);
+    }
+
+    return counters;
+}
+
+// FUNCTIONS
+// ---------
+
+
+/** \brief Check if the BSTR pool is enabled.
+ */
+bool bstrPool()
+{
+    return POOL_ENABLED.load(std::memory_order_relaxed);
+}
+
+
+/** \brief Enable or disable the BSTR pool, process-wide.
+ */
+void setBstrPool(const bool enabled)
+{
+    POOL_ENABLED.store(enabled, std::memory_order_relaxed);
+    if (!enabled) {
+        trimBstrPool();
+    }
+}
+
+
+/** \brief Get pool counters, summed over all threads.
+ */
+BstrPoolCounters bstrPoolCounters()
+{
+    PoolRegistry &registry = poolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    BstrPoolCounters counters = sumPoolCounters(registry);
+    counters.hits -= registry.reset.hits;
+    counters.misses -= registry.reset.misses;
+
+    return counters;
+}
+
+
+/** \brief Reset pool counters to zero.
+ *
+ *  Other threads own their counters, so this records the current sums
+ *  and later reads subtract them.
+ */
+void resetBstrPoolCounters()
+{
+    PoolRegistry &registry = poolRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.reset = sumPoolCounters(registry);
+}
+
+
+/** \brief Free all strings cached by the calling thread.
+ */
+void trimBstrPool()
+{
+    if (!POOL_DESTROYED) {
+        POOL_CACHE.trim();
+    }
+}
+
+
+/** \brief Allocate BSTR, from the pool if enabled.
+ */
+BSTR ALLOC_BSTR(const wchar_t *string,
+    const size_t length)
+{
+    PoolCache *cache = length <= POOL_MAXIMUM ? poolCache() : nullptr;
+    if (cache) {
+        if (BSTR bstr = cache->pop(length)) {
+            cache->hit();
+            if (string) {
+                std::copy(string, string + length, bstr);
+            }
+            TRUNCATE_BSTR(bstr, length);
+            return bstr;
+        }
+        cache->miss();
+    }
+
+    return SysAllocStringLen(string, static_cast<UINT>(length));
+}
+
+
+/** \brief Shorten BSTR in place, by rewriting its length prefix.
+ */
+void TRUNCATE_BSTR(BSTR bstr,
+    const size_t length)
+{
+    reinterpret_cast<uint32_t*>(bstr)[-1] = static_cast<uint32_t>(length * sizeof(OLECHAR));
+    bstr[length] = L'\0';
+}
+
+
+/** \brief Free BSTR, caching it in the pool if enabled.
+ */
+void FREE_BSTR(BSTR bstr)
+{
+    if (!bstr) {
+        return;
+    }
+    PoolCache *cache = poolCache();
+    if (cache && cache->push(bstr)) {
+        return;
+    }
+
+    SysFreeString(bstr);
+}
+
+}   /* autocom */
@@ -98,6 +98,50 @@ ULONG & SafeArrayBound::upper()
     return cElements;
 }
 
+
+/** \brief Cache shape of array, or clear it for a null array.
+ */
+void SafeArrayLayout::reset(const SAFEARRAY *array)
+{
+    base = nullptr;
+    count = 0;
+    rank = 0;
+    if (!array) {
+        return;
+    }
+
+    base = array->pvData;
+    count = 1;
+    for (USHORT i = 0; i < array->cDims; ++i) {
+        count *= array->rgsabound[i].cElements;
+    }
+
+    if (array->cDims <= MAX_RANK) {
+        rank = array->cDims;
+        size_t size = 1;
+        for (USHORT i = 0; i < rank; ++i) {
+            const auto &bound = array->rgsabound[rank - 1 - i];
+            lower[i] = bound.lLbound;
+            extent[i] = bound.cElements;
+            stride[i] = size;
+            size *= bound.cElements;
+        }
+    }
+}
+
+
+/** \brief Check if per-dimension shape is cached.
+ */
+bool SafeArrayLayout::cached() const
+{
+    return rank != 0;
+}
+
+
+/** \brief Write implementation for constexpr.
+ */
+constexpr USHORT SafeArrayLayout::MAX_RANK;
+
 }   /* autocom */
 
 #ifdef _MSC_VER
@@ -0,0 +1,40 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/**
+ *  \addtogroup AutoCOM
+ *  \brief Chunked multi-threading for large inputs.
+ */
+
+#include "autocom/util/parallel.hpp"
+
+#include <algorithm>
+
+
+namespace autocom
+{
+// CONSTANTS
+// ---------
+
+/** Smallest chunk worth handing to a thread, in elements.
+ */
+constexpr size_t MINIMUM_CHUNK = 1 << 16;
+
+// OBJECTS
+// -------
+
+
+/** \brief Get number of chunks to split length elements into.
+ */
+size_t Parallel::workers(const size_t length) const
+{
+    if (length < threshold) {
+        return 1;
+    }
+
+    size_t count = threads ? threads : std::thread::hardware_concurrency();
+    count = std::min(count, length / MINIMUM_CHUNK);
+
+    return std::max<size_t>(count, 1);
+}
+
+}   /* autocom */
@@ -5,10 +5,13 @@
  *  \brief Variant object and collection definitions.
  */
 
+#include "autocom/pool.hpp"
 #include "autocom/safearray.hpp"
 #include "autocom/variant.hpp"
 #include "autocom/encoding/converters.hpp"
 
+#include <cstring>
+
 #ifdef _MSC_VER
 #   pragma warning(push)
 #   pragma warning(disable:4267)
@@ -29,6 +32,33 @@ bool changeVariantType(VARIANT &variant,
     return VariantChangeType(&variant, &variant, 0, vt) == S_OK;
 }
 
+
+/** \brief Check if VARTYPE holds a plain integer or floating-point value.
+ *
+ *  VT_BOOL, VT_DATE, VT_ERROR and VT_CY are excluded, since their
+ *  coercions are not plain numeric casts.
+ */
+bool isNumericVartype(const VARTYPE vt)
+{
+    switch (vt) {
+        case VT_I1:
+        case VT_UI1:
+        case VT_I2:
+        case VT_UI2:
+        case VT_I4:
+        case VT_UI4:
+        case VT_INT:
+        case VT_UINT:
+        case VT_I8:
+        case VT_UI8:
+        case VT_R4:
+        case VT_R8:
+            return true;
+        default:
+            return false;
+    }
+}
+
 // MACROS
 // ------
 
@@ -187,8 +217,7 @@ void set(VARIANT &variant,
     const char *value)
 {
     variant.vt = VT_BSTR;
-    auto wide = WIDE(std::string(value));
-    variant.bstrVal = SysAllocStringLen(wide.data(), wide.size());
+    variant.bstrVal = WIDE_BSTR(value, strlen(value));
 }
 
 /** \brief Overload from character literals.
@@ -197,7 +226,7 @@ void set(VARIANT &variant,
     const wchar_t *value)
 {
     variant.vt = VT_BSTR;
-    variant.bstrVal = SysAllocStringLen(value, wcslen(value));
+    variant.bstrVal = ALLOC_BSTR(value, wcslen(value));
 }
 
 
@@ -264,6 +293,27 @@ void set(VARIANT &variant,
 }
 
 
+/** \brief Set a BSTR value copied from a view.
+ *
+ *  The VARIANT owns its BSTR, so this is the only copy made.
+ */
+void set(VARIANT &variant,
+    const BstrView &value)
+{
+    variant.vt = VT_BSTR;
+    variant.bstrVal = ALLOC_BSTR(value.data(), value.size());
+}
+
+
+/** \brief Set a BSTR value copied from a wide string.
+ */
+void set(VARIANT &variant,
+    const std::wstring &value)
+{
+    set(variant, BstrView(value));
+}
+
+
 /** \brief Set a BSTR value from wrapper.
  */
 void set(VARIANT &variant,
@@ -453,6 +503,15 @@ AUTOCOM_SAFE_POINTER_SETTER(Decimal, decVal)
         }                                                               \
     }
 
+/** \brief Widen numeric value in place of VariantChangeType, if lossless.
+ */
+#define AUTOCOM_WIDEN_TYPE(variant, vartype, value)                     \
+    if (TO_VARTYPE(variant.vt) != TO_VARTYPE(vartype)                   \
+        && isNumericVartype(vartype)                                    \
+        && widenVariant(variant, value)) {                              \
+        return;                                                         \
+    }
+
 // GENERIC
 
 /** \brief Get value from variant.
@@ -462,6 +521,7 @@ AUTOCOM_SAFE_POINTER_SETTER(Decimal, decVal)
     void get(VARIANT &variant,                                          \
         type &value)                                                    \
     {                                                                   \
+        AUTOCOM_WIDEN_TYPE(variant, VariantType<type>::vt, value)       \
         AUTOCOM_CONVERT_TYPE(variant, VariantType<type>::vt)            \
         value = variant.field;                                          \
     }
@@ -498,6 +558,7 @@ AUTOCOM_SAFE_POINTER_SETTER(Decimal, decVal)
         safe value)                                                     \
     {                                                                   \
         auto &ref = typename safe::type(value);                         \
+        AUTOCOM_WIDEN_TYPE(variant, VariantType<safe>::vt, ref)         \
         AUTOCOM_CONVERT_TYPE(variant, VariantType<safe>::vt)            \
         ref = variant.field;                                            \
     }
@@ -760,6 +821,7 @@ AUTOCOM_SAFE_POINTER_GETTER(Decimal, decVal)
 // ------------------
 
 #undef AUTOCOM_CONVERT_TYPE
+#undef AUTOCOM_WIDEN_TYPE
 #undef AUTOCOM_GET
 #undef AUTOCOM_SAFE_GET
 #undef AUTOCOM_VALUE_GETTER
@@ -793,6 +855,7 @@ Variant::~Variant()
  */
 Variant::Variant(const Variant &other)
 {
+    VariantInit(this);
     VariantCopy(this, const_cast<Variant*>(&other));
 }
 
@@ -819,6 +882,10 @@ Variant::Variant(Variant &&other):
  */
 Variant & Variant::operator=(Variant &&other)
 {
+    if (this == &other) {
+        return *this;
+    }
+    clear();
     VARIANT::operator=(static_cast<VARIANT&&>(other));
     other.vt = VT_EMPTY;
     return *this;
@@ -834,10 +901,19 @@ void Variant::init()
 
 
 /** \brief Clear variant.
+ *
+ *  Owned BSTRs are released through the BSTR pool, empty variants
+ *  are skipped, and all other types go through VariantClear.
  */
 void Variant::clear()
 {
-    VariantClear(this);
+    if (vt == VT_BSTR) {
+        FREE_BSTR(bstrVal);
+        bstrVal = nullptr;
+        vt = VT_EMPTY;
+    } else if (vt != VT_EMPTY) {
+        VariantClear(this);
+    }
 }
 
 
@@ -0,0 +1,22 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComBenchmarks
+ *  \brief Heap allocation counter for benchmarks.
+ *
+ *  The benchmark runner replaces the global operator new, so every
+ *  allocation through it is counted. Allocations made directly by the
+ *  system, such as SysAllocString, are not counted.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+
+// FUNCTIONS
+// ---------
+
+/** \brief Get number of calls to operator new since startup.
+ */
+size_t allocations();
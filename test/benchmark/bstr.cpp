@@ -0,0 +1,180 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComBenchmarks
+ *  \brief Bstr hashing and comparison against std::wstring round-trips.
+ *
+ *  The round-trip benchmarks copy each Bstr into a std::wstring, as
+ *  result caches did before Bstr was hashable and ordered.
+ */
+
+#include "autocom/bstr.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cwctype>
+#include <string>
+#include <unordered_map>
+
+namespace com = autocom;
+
+
+// HELPERS
+// -------
+
+
+/** \brief Get a mixed-case name of `state.range(0)` characters.
+ */
+std::wstring name(const benchmark::State &state)
+{
+    const std::wstring sample = L"GetIDsOfNames.ActiveSheet.";
+    std::wstring name;
+    while (name.size() < static_cast<size_t>(state.range(0))) {
+        name += sample;
+    }
+    name.resize(static_cast<size_t>(state.range(0)));
+
+    return name;
+}
+
+
+/** \brief Uppercase a wide string.
+ */
+std::wstring upper(std::wstring wide)
+{
+    std::transform(wide.begin(), wide.end(), wide.begin(), [](wchar_t c) {
+        return static_cast<wchar_t>(std::towupper(c));
+    });
+
+    return wide;
+}
+
+// BENCHMARKS
+// ----------
+
+
+static void BstrHash(benchmark::State &state)
+{
+    com::Bstr bstr(name(state));
+    std::hash<com::Bstr> hash;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(hash(bstr));
+    }
+    state.SetBytesProcessed(state.iterations() * bstr.size() * sizeof(wchar_t));
+}
+
+
+static void WstringHash(benchmark::State &state)
+{
+    com::Bstr bstr(name(state));
+    std::hash<std::wstring> hash;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(hash(std::wstring(bstr.begin(), bstr.end())));
+    }
+    state.SetBytesProcessed(state.iterations() * bstr.size() * sizeof(wchar_t));
+}
+
+
+static void BstrHashNoCase(benchmark::State &state)
+{
+    com::Bstr bstr(name(state));
+    com::BstrHashNoCase hash;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(hash(bstr));
+    }
+    state.SetBytesProcessed(state.iterations() * bstr.size() * sizeof(wchar_t));
+}
+
+
+static void WstringHashNoCase(benchmark::State &state)
+{
+    com::Bstr bstr(name(state));
+    std::hash<std::wstring> hash;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(hash(upper(std::wstring(bstr.begin(), bstr.end()))));
+    }
+    state.SetBytesProcessed(state.iterations() * bstr.size() * sizeof(wchar_t));
+}
+
+
+static void BstrCompare(benchmark::State &state)
+{
+    com::Bstr left(name(state));
+    com::Bstr right(left);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(left.compare(right));
+    }
+    state.SetBytesProcessed(state.iterations() * left.size() * sizeof(wchar_t));
+}
+
+
+static void WstringCompare(benchmark::State &state)
+{
+    com::Bstr left(name(state));
+    com::Bstr right(left);
+    for (auto _: state) {
+        std::wstring l(left.begin(), left.end());
+        std::wstring r(right.begin(), right.end());
+        benchmark::DoNotOptimize(l.compare(r));
+    }
+    state.SetBytesProcessed(state.iterations() * left.size() * sizeof(wchar_t));
+}
+
+
+static void BstrCompareNoCase(benchmark::State &state)
+{
+    com::Bstr left(name(state));
+    com::Bstr right(upper(name(state)));
+    for (auto _: state) {
+        benchmark::DoNotOptimize(left.compareNoCase(right));
+    }
+    state.SetBytesProcessed(state.iterations() * left.size() * sizeof(wchar_t));
+}
+
+
+static void WstringCompareNoCase(benchmark::State &state)
+{
+    com::Bstr left(name(state));
+    com::Bstr right(upper(name(state)));
+    for (auto _: state) {
+        auto l = upper(std::wstring(left.begin(), left.end()));
+        auto r = upper(std::wstring(right.begin(), right.end()));
+        benchmark::DoNotOptimize(l.compare(r));
+    }
+    state.SetBytesProcessed(state.iterations() * left.size() * sizeof(wchar_t));
+}
+
+
+static void BstrLookup(benchmark::State &state)
+{
+    com::Bstr key(name(state));
+    std::unordered_map<com::Bstr, int> cache;
+    cache[key] = 1;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(cache.find(key));
+    }
+}
+
+
+static void WstringLookup(benchmark::State &state)
+{
+    com::Bstr key(name(state));
+    std::unordered_map<std::wstring, int> cache;
+    cache[std::wstring(key.begin(), key.end())] = 1;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(cache.find(std::wstring(key.begin(), key.end())));
+    }
+}
+
+
+BENCHMARK(BstrHash)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(WstringHash)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BstrHashNoCase)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(WstringHashNoCase)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BstrCompare)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(WstringCompare)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BstrCompareNoCase)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(WstringCompareNoCase)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BstrLookup)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(WstringLookup)->RangeMultiplier(8)->Range(8, 4096);
@@ -0,0 +1,240 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComBenchmarks
+ *  \brief Per-call overhead of DispatchBase::invoke.
+ *
+ *  Calls go to an in-process IDispatch which does no work, so the
+ *  timings and allocation counts measure argument packing alone.
+ */
+
+#include "allocation.hpp"
+#include "autocom.hpp"
+#include "fake.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace com = autocom;
+
+
+// OBJECTS
+// -------
+
+
+/** \brief IDispatch which accepts any call and returns the argument count.
+ */
+class ArgumentCountDispatch: public FakeDispatch
+{
+public:
+    HRESULT STDMETHODCALLTYPE GetIDsOfNames(REFIID,
+        LPOLESTR *,
+        UINT count,
+        LCID,
+        DISPID *ids) override
+    {
+        for (UINT i = 0; i < count; ++i) {
+            ids[i] = 1;
+        }
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Invoke(DISPID,
+        REFIID,
+        LCID,
+        WORD,
+        DISPPARAMS *params,
+        VARIANT *result,
+        EXCEPINFO *,
+        UINT *) override
+    {
+        if (result) {
+            result->vt = VT_I4;
+            result->lVal = static_cast<LONG>(params->cArgs);
+        }
+        return S_OK;
+    }
+};
+
+
+ArgumentCountDispatch FAKE;
+
+
+/** \brief IEnumVARIANT which yields FAKE a fixed number of times.
+ */
+class FakeEnum: public IEnumVARIANT
+{
+public:
+    ULONG size = 0;
+    ULONG position = 0;
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid,
+        void **object) override
+    {
+        if (riid == IID_IUnknown || riid == IID_IEnumVARIANT) {
+            *object = this;
+            return S_OK;
+        }
+        *object = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override
+    {
+        return 1;
+    }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        return 1;
+    }
+
+    HRESULT STDMETHODCALLTYPE Next(ULONG count,
+        VARIANT *items,
+        ULONG *fetched) override
+    {
+        ULONG i = 0;
+        for (; i < count && position < size; ++i, ++position) {
+            items[i].vt = VT_DISPATCH;
+            items[i].pdispVal = FAKE.acquire();
+        }
+        *fetched = i;
+        return i == count ? S_OK : S_FALSE;
+    }
+
+    HRESULT STDMETHODCALLTYPE Skip(ULONG count) override
+    {
+        position += count;
+        return position <= size ? S_OK : S_FALSE;
+    }
+
+    HRESULT STDMETHODCALLTYPE Reset() override
+    {
+        position = 0;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Clone(IEnumVARIANT **clone) override
+    {
+        *clone = nullptr;
+        return E_NOTIMPL;
+    }
+};
+
+// HELPERS
+// -------
+
+
+/** \brief Measure `function`, counting allocations per call.
+ */
+template <typename Function>
+void measure(benchmark::State &state,
+    Function function)
+{
+    const size_t before = allocations();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(function());
+    }
+    const size_t count = allocations() - before;
+
+    state.counters["allocations"] = benchmark::Counter(static_cast<double>(count), benchmark::Counter::kAvgIterations);
+}
+
+// BENCHMARKS
+// ----------
+
+
+static void PackDispParams(benchmark::State &state)
+{
+    measure(state, []() {
+        com::DispParams dp;
+        dp.setArgs(1, 2.0, true, 4);
+        return dp.params()->cArgs;
+    });
+}
+
+
+static void PackDispParamsN(benchmark::State &state)
+{
+    measure(state, []() {
+        com::DispParamsN<4> dp;
+        dp.setArgs(1, 2.0, true, 4);
+        return dp.params()->cArgs;
+    });
+}
+
+
+static void InvokeNoArgs(benchmark::State &state)
+{
+    com::DispatchBase dispatch(FAKE.acquire());
+    LONG count;
+    measure(state, [&]() {
+        return dispatch.get(L"Count", count);
+    });
+}
+
+
+static void InvokeFourArgs(benchmark::State &state)
+{
+    com::DispatchBase dispatch(FAKE.acquire());
+    measure(state, [&]() {
+        return dispatch.method(L"Add", 1, 2.0, true, 4);
+    });
+}
+
+
+static void InvokeEightArgs(benchmark::State &state)
+{
+    com::DispatchBase dispatch(FAKE.acquire());
+    measure(state, [&]() {
+        return dispatch.method(L"Add", 1, 2, 3, 4, 5.0, 6.0, true, false);
+    });
+}
+
+
+static void InvokeBoundFourArgs(benchmark::State &state)
+{
+    com::DispatchBase dispatch(FAKE.acquire());
+    com::BoundMethod add = dispatch.bind(L"Add");
+    com::Variant result;
+    measure(state, [&]() {
+        return add.call(result, 1, 2.0, true, 4);
+    });
+}
+
+
+static void CopyDispatch(benchmark::State &state)
+{
+    com::Dispatch dispatch;
+    dispatch.DispatchBase::open(FAKE.acquire());
+    measure(state, [&]() {
+        com::Dispatch copy(dispatch);
+        return bool(copy);
+    });
+}
+
+
+static void IterateEnumVariant(benchmark::State &state)
+{
+    FakeEnum items;
+    items.size = static_cast<ULONG>(state.range(0));
+    com::EnumVariant enumerator(&items);
+    measure(state, [&]() {
+        items.Reset();
+        size_t count = 0;
+        for (auto &item: enumerator) {
+            count += bool(item);
+        }
+        return count;
+    });
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+BENCHMARK(PackDispParams);
+BENCHMARK(PackDispParamsN);
+BENCHMARK(InvokeNoArgs);
+BENCHMARK(InvokeFourArgs);
+BENCHMARK(InvokeEightArgs);
+BENCHMARK(InvokeBoundFourArgs);
+BENCHMARK(CopyDispatch);
+BENCHMARK(IterateEnumVariant)->Arg(1024);
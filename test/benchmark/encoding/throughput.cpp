@@ -0,0 +1,181 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComBenchmarks
+ *  \brief Unicode conversion throughput over realistic corpora.
+ *
+ *  Every benchmark runs over inputs from 8 bytes to 64 MB, for pure
+ *  ASCII, Latin-1-heavy, CJK and emoji-heavy text, and reports bytes
+ *  of UTF-8 processed per second and heap allocations per call.
+ */
+
+#include "allocation.hpp"
+#include "autocom/encoding.hpp"
+#if defined(_WIN32)
+#   include "autocom/bstr.hpp"
+#endif
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace com = autocom;
+namespace utf = com::utf;
+
+
+// CORPORA
+// -------
+
+
+/** \brief Corpus name and sample text, repeated to the input size.
+ */
+struct Corpus
+{
+    const char *name;
+    const char *sample;
+};
+
+
+const Corpus CORPORA[] = {
+    {"ascii", "The quick brown fox jumps over the lazy dog. "},
+    {"latin1", "Gr\xc3\xb6\xc3\x9f" "enwahn, caf\xc3\xa9, na\xc3\xafve fa\xc3\xa7" "ade, d\xc3\xa9j\xc3\xa0 vu, \xc3\x86r\xc3\xb8sk\xc3\xb8" "bing. "},
+    {"cjk", "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe6\x96\x87\xe7\xab\xa0\xe3\x80\x81\xe4\xb8\xad\xe6\x96\x87\xe6\x96\x87\xe6\x9c\xac\xe5\x92\x8c\xed\x95\x9c\xea\xb5\xad\xec\x96\xb4 \xed\x85\x8d\xec\x8a\xa4\xed\x8a\xb8\xe3\x80\x82"},
+    {"emoji", "Launch \xf0\x9f\x9a\x80 party \xf0\x9f\x8e\x89 smile \xf0\x9f\x98\x80 thumbs \xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd "},
+};
+
+const int64_t MINIMUM_SIZE = 8;
+const int64_t MAXIMUM_SIZE = 64 << 20;
+
+// HELPERS
+// -------
+
+
+/** \brief Register every input size for every corpus.
+ */
+void corpora(benchmark::internal::Benchmark *benchmark)
+{
+    for (int64_t corpus = 0; corpus < static_cast<int64_t>(sizeof(CORPORA) / sizeof(Corpus)); ++corpus) {
+        for (int64_t size = MINIMUM_SIZE; size <= MAXIMUM_SIZE; size *= 8) {
+            benchmark->Args({size, corpus});
+        }
+        benchmark->Args({MAXIMUM_SIZE, corpus});
+    }
+}
+
+
+/** \brief Repeat the corpus sample to at most `size` bytes of UTF-8,
+ *  ending on a character boundary.
+ */
+std::string utf8Corpus(const benchmark::State &state)
+{
+    const size_t size = static_cast<size_t>(state.range(0));
+    const std::string sample = CORPORA[state.range(1)].sample;
+    std::string corpus;
+    corpus.reserve(size + sample.size());
+    while (corpus.size() < size) {
+        corpus += sample;
+    }
+
+    auto *data = reinterpret_cast<const uint8_t*>(corpus.data());
+    corpus.resize(utf::detail::boundary(data, data + size));
+
+    return corpus;
+}
+
+
+/** \brief Measure `function` over the UTF-8 corpus converted by
+ *  `prepare`, counting bytes of UTF-8 and allocations per call.
+ */
+template <typename Prepare, typename Function>
+void measure(benchmark::State &state,
+    Prepare prepare,
+    Function function)
+{
+    const std::string narrow = utf8Corpus(state);
+    const auto input = prepare(narrow);
+
+    const size_t before = allocations();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(function(input));
+    }
+    const size_t count = allocations() - before;
+
+    state.SetLabel(CORPORA[state.range(1)].name);
+    state.SetBytesProcessed(state.iterations() * narrow.size());
+    state.counters["allocations"] = benchmark::Counter(static_cast<double>(count), benchmark::Counter::kAvgIterations);
+}
+
+
+/** \brief Use the UTF-8 corpus as is.
+ */
+const std::string & identity(const std::string &narrow)
+{
+    return narrow;
+}
+
+// BENCHMARKS
+// ----------
+
+
+static void Utf8To16(benchmark::State &state)
+{
+    measure(state, identity, [](const std::string &input) {
+        return utf::utf8To16(input);
+    });
+}
+
+
+static void Utf16To8(benchmark::State &state)
+{
+    measure(state, [](const std::string &narrow) {
+        return utf::utf8To16(narrow);
+    }, [](const std::string &input) {
+        return utf::utf16To8(input);
+    });
+}
+
+
+static void Utf8To32(benchmark::State &state)
+{
+    measure(state, identity, [](const std::string &input) {
+        return utf::utf8To32(input);
+    });
+}
+
+
+static void Wide(benchmark::State &state)
+{
+    measure(state, identity, [](const std::string &input) {
+        return com::WIDE(input);
+    });
+}
+
+
+static void Narrow(benchmark::State &state)
+{
+    measure(state, [](const std::string &narrow) {
+        return com::WIDE(narrow);
+    }, [](const std::wstring &input) {
+        return com::NARROW(input);
+    });
+}
+
+
+BENCHMARK(Utf8To16)->Apply(corpora);
+BENCHMARK(Utf16To8)->Apply(corpora);
+BENCHMARK(Utf8To32)->Apply(corpora);
+BENCHMARK(Wide)->Apply(corpora);
+BENCHMARK(Narrow)->Apply(corpora);
+
+#if defined(_WIN32)
+
+static void BstrFromString(benchmark::State &state)
+{
+    measure(state, identity, [](const std::string &input) {
+        return com::Bstr(input);
+    });
+}
+
+BENCHMARK(BstrFromString)->Apply(corpora);
+
+#endif
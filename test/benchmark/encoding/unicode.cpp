@@ -0,0 +1,138 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComBenchmarks
+ *  \brief Per-call overhead of the STL Unicode wrappers.
+ */
+
+#include "autocom/encoding.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace com = autocom;
+namespace utf = com::utf;
+
+
+// HELPERS
+// -------
+
+
+/** \brief Identifier-sized names, the dominant input for WIDE/NARROW.
+ */
+const std::vector<std::string> NAMES = {
+    "Add",
+    "Item",
+    "Count",
+    "Visible",
+    "Workbooks",
+    "ActiveSheet",
+    "GetIDsOfNames",
+    "ScriptControl.Language",
+};
+
+
+/** \brief Encode the identifiers as UTF-16 byte strings.
+ */
+std::vector<std::string> wideNames()
+{
+    std::vector<std::string> names;
+    for (const auto &name: NAMES) {
+        names.emplace_back(com::UTF8_TO_UTF16(name));
+    }
+
+    return names;
+}
+
+
+/** \brief Previous wrapper: type-erased kernel and an intermediate buffer.
+ */
+template <typename C1, typename C2>
+std::string legacy(const std::string &string,
+    const size_t ratio,
+    std::function<size_t(const C1*, const C1*, C2*, C2*, bool)> function)
+{
+    const size_t srclen = string.size() / sizeof(C1);
+    const size_t dstlen = srclen * ratio;
+    auto *src = reinterpret_cast<const C1*>(string.data());
+    auto *dst = reinterpret_cast<C2*>(malloc(dstlen * sizeof(C2)));
+
+    size_t out = function(src, src + srclen, dst, dst + dstlen, true);
+    std::string output(reinterpret_cast<const char*>(dst), out * sizeof(C2));
+    free(dst);
+
+    return output;
+}
+
+// BENCHMARKS
+// ----------
+
+
+static void Utf8To16Function(benchmark::State &state)
+{
+    for (auto _: state) {
+        for (const auto &name: NAMES) {
+            benchmark::DoNotOptimize(legacy<uint8_t, uint16_t>(name, 1, [](const uint8_t *srcBegin,
+                const uint8_t *srcEnd,
+                uint16_t *dstBegin,
+                uint16_t *dstEnd,
+                bool strict)
+            {
+                return utf::simd::utf8To16(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+            }));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NAMES.size());
+}
+
+
+static void Utf8To16Template(benchmark::State &state)
+{
+    for (auto _: state) {
+        for (const auto &name: NAMES) {
+            benchmark::DoNotOptimize(com::UTF8_TO_UTF16(name));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NAMES.size());
+}
+
+
+static void Utf16To8Function(benchmark::State &state)
+{
+    auto names = wideNames();
+    for (auto _: state) {
+        for (const auto &name: names) {
+            benchmark::DoNotOptimize(legacy<uint16_t, uint8_t>(name, 4, [](const uint16_t *srcBegin,
+                const uint16_t *srcEnd,
+                uint8_t *dstBegin,
+                uint8_t *dstEnd,
+                bool strict)
+            {
+                return utf::simd::utf16To8(srcBegin, srcEnd, dstBegin, dstEnd, strict);
+            }));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * names.size());
+}
+
+
+static void Utf16To8Template(benchmark::State &state)
+{
+    auto names = wideNames();
+    for (auto _: state) {
+        for (const auto &name: names) {
+            benchmark::DoNotOptimize(com::UTF16_TO_UTF8(name));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * names.size());
+}
+
+
+BENCHMARK(Utf8To16Function);
+BENCHMARK(Utf8To16Template);
+BENCHMARK(Utf16To8Function);
+BENCHMARK(Utf16To8Template);
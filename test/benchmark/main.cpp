@@ -0,0 +1,69 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComBenchmarks
+ *  \brief AutoCom benchmark runner.
+ */
+
+#include "allocation.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// ALLOCATIONS
+// -----------
+
+std::atomic<size_t> ALLOCATIONS(0);
+
+
+/** \brief Count and forward allocations to malloc.
+ */
+void * operator new(size_t size)
+{
+    ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+
+void operator delete(void *pointer,
+    size_t) noexcept
+{
+    std::free(pointer);
+}
+
+
+/** \brief Get number of calls to operator new since startup.
+ */
+size_t allocations()
+{
+    return ALLOCATIONS.load(std::memory_order_relaxed);
+}
+
+
+// SUITE
+// -----
+
+
+/** \brief Execute benchmark suite.
+ */
+int main(int argc, char *argv[])
+{
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    ::benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,173 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComBenchmarks
+ *  \brief Multidimensional SafeArray access against raw pointers.
+ *
+ *  The access benchmarks sum a square 2-D array of doubles, visiting
+ *  elements in memory order, so only the cost of indexing differs.
+ *  The copy benchmarks convert the array to a row-major buffer.
+ */
+
+#include "autocom/safearray.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace com = autocom;
+
+
+// HELPERS
+// -------
+
+
+/** \brief Create a `size` x `size` array of doubles, 1-based like VBA.
+ */
+static com::SafeArray<DOUBLE> newMatrix(const LONG size)
+{
+    SAFEARRAYBOUND bounds[2] = {
+        {static_cast<ULONG>(size), 1},
+        {static_cast<ULONG>(size), 1},
+    };
+    com::SafeArray<DOUBLE> array(SafeArrayCreate(VT_R8, 2, bounds));
+    for (size_t i = 0; i < array.size(); ++i) {
+        array[i] = static_cast<DOUBLE>(i % 7);
+    }
+
+    return array;
+}
+
+// BENCHMARKS
+// ----------
+
+
+static void MatrixRawPointer(benchmark::State &state)
+{
+    const LONG size = static_cast<LONG>(state.range(0));
+    com::SafeArray<DOUBLE> array = newMatrix(size);
+    const DOUBLE *data = array.data();
+    for (auto _: state) {
+        DOUBLE sum = 0;
+        for (LONG j = 0; j < size; ++j) {
+            for (LONG i = 0; i < size; ++i) {
+                sum += data[i + j * size];
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+
+static void MatrixIndex(benchmark::State &state)
+{
+    const LONG size = static_cast<LONG>(state.range(0));
+    com::SafeArray<DOUBLE> array = newMatrix(size);
+    for (auto _: state) {
+        DOUBLE sum = 0;
+        LONG indices[2];
+        for (indices[1] = 1; indices[1] <= size; ++indices[1]) {
+            for (indices[0] = 1; indices[0] <= size; ++indices[0]) {
+                sum += array[indices];
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+
+static void MatrixCall(benchmark::State &state)
+{
+    const LONG size = static_cast<LONG>(state.range(0));
+    com::SafeArray<DOUBLE> array = newMatrix(size);
+    for (auto _: state) {
+        DOUBLE sum = 0;
+        for (LONG j = 1; j <= size; ++j) {
+            for (LONG i = 1; i <= size; ++i) {
+                sum += array(i, j);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+
+static void MatrixPtrOfIndex(benchmark::State &state)
+{
+    const LONG size = static_cast<LONG>(state.range(0));
+    com::SafeArray<DOUBLE> array = newMatrix(size);
+    for (auto _: state) {
+        DOUBLE sum = 0;
+        LONG indices[2];
+        for (indices[1] = 1; indices[1] <= size; ++indices[1]) {
+            for (indices[0] = 1; indices[0] <= size; ++indices[0]) {
+                DOUBLE *value;
+                SafeArrayPtrOfIndex(array, indices, (void**) &value);
+                sum += *value;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+
+static void MatrixView(benchmark::State &state)
+{
+    const LONG size = static_cast<LONG>(state.range(0));
+    com::SafeArray<DOUBLE> array = newMatrix(size);
+    auto view = array.view<2>();
+    for (auto _: state) {
+        DOUBLE sum = 0;
+        for (LONG j = 1; j <= size; ++j) {
+            for (LONG i = 1; i <= size; ++i) {
+                sum += view(i, j);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+
+static void MatrixCopyRowMajor(benchmark::State &state)
+{
+    const LONG size = static_cast<LONG>(state.range(0));
+    com::SafeArray<DOUBLE> array = newMatrix(size);
+    std::vector<DOUBLE> buffer(size * size);
+    for (auto _: state) {
+        array.view<2>().copyRowMajor(buffer.data());
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+
+static void MatrixCopyRowMajorByIndex(benchmark::State &state)
+{
+    const LONG size = static_cast<LONG>(state.range(0));
+    com::SafeArray<DOUBLE> array = newMatrix(size);
+    std::vector<DOUBLE> buffer(size * size);
+    for (auto _: state) {
+        DOUBLE *out = buffer.data();
+        for (LONG i = 1; i <= size; ++i) {
+            for (LONG j = 1; j <= size; ++j) {
+                *out++ = array(i, j);
+            }
+        }
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+
+BENCHMARK(MatrixRawPointer)->Arg(512);
+BENCHMARK(MatrixIndex)->Arg(512);
+BENCHMARK(MatrixCall)->Arg(512);
+BENCHMARK(MatrixPtrOfIndex)->Arg(512);
+BENCHMARK(MatrixView)->Arg(512);
+BENCHMARK(MatrixCopyRowMajor)->Arg(2048);
+BENCHMARK(MatrixCopyRowMajorByIndex)->Arg(2048);
@@ -0,0 +1,132 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief Bound member test suite.
+ */
+
+#include "autocom.hpp"
+#include "fake.hpp"
+
+#include <gtest/gtest.h>
+
+namespace com = autocom;
+
+
+// OBJECTS
+// -------
+
+
+/** \brief IDispatch which records the last call.
+ */
+class RecordingDispatch: public FakeDispatch
+{
+public:
+    UINT lookups = 0;
+    DISPID id = DISPID_UNKNOWN;
+    WORD flags = 0;
+    UINT args = 0;
+    UINT namedArgs = 0;
+    LONG value = 0;
+
+    HRESULT STDMETHODCALLTYPE GetIDsOfNames(REFIID,
+        LPOLESTR *,
+        UINT count,
+        LCID,
+        DISPID *ids) override
+    {
+        ++lookups;
+        for (UINT i = 0; i < count; ++i) {
+            ids[i] = 5;
+        }
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Invoke(DISPID member,
+        REFIID,
+        LCID,
+        WORD wFlags,
+        DISPPARAMS *params,
+        VARIANT *result,
+        EXCEPINFO *,
+        UINT *) override
+    {
+        id = member;
+        flags = wFlags;
+        args = params->cArgs;
+        namedArgs = params->cNamedArgs;
+        if (wFlags & (DISPATCH_PROPERTYPUT | DISPATCH_PROPERTYPUTREF)) {
+            value = params->rgvarg[0].lVal;
+        } else if (result) {
+            result->vt = VT_I4;
+            result->lVal = value + static_cast<LONG>(params->cArgs);
+        }
+        return S_OK;
+    }
+};
+
+// TESTS
+// -----
+
+
+TEST(BoundMethod, Call)
+{
+    RecordingDispatch object;
+    {
+        com::DispatchBase dispatch(object.acquire());
+
+        com::BoundMethod method = dispatch.bind(L"Add");
+        EXPECT_TRUE(bool(method));
+        EXPECT_EQ(method.function(), 5);
+        EXPECT_EQ(object.lookups, 1);
+
+        for (LONG i = 0; i < 3; ++i) {
+            com::Variant result = method(i, 2.0, L"three");
+            EXPECT_EQ(result.vt, VT_I4);
+            EXPECT_EQ(result.lVal, 3);
+        }
+        EXPECT_EQ(object.lookups, 1);
+        EXPECT_EQ(object.flags, DISPATCH_METHOD);
+        EXPECT_EQ(object.namedArgs, 0);
+
+        // argument count may change between calls
+        com::Variant result;
+        EXPECT_TRUE(method.call(result));
+        EXPECT_EQ(object.args, 0);
+        EXPECT_EQ(result.lVal, 0);
+
+        com::BoundMethod setter = dispatch.bind(7, com::PUT);
+        EXPECT_TRUE(setter.call(result, 4));
+        EXPECT_EQ(object.id, 7);
+        EXPECT_EQ(object.namedArgs, 1);
+        EXPECT_EQ(object.value, 4);
+    }
+    EXPECT_EQ(object.references(), 1);
+}
+
+
+TEST(BoundProperty, GetPut)
+{
+    RecordingDispatch object;
+    {
+        com::DispatchBase dispatch(object.acquire());
+
+        com::BoundProperty property = dispatch.bindProperty(L"Value");
+        EXPECT_TRUE(property.put(12));
+        EXPECT_EQ(object.flags, DISPATCH_PROPERTYPUT);
+        EXPECT_EQ(object.namedArgs, 1);
+
+        LONG value = 0;
+        EXPECT_TRUE(property.get(value));
+        EXPECT_EQ(value, 12);
+        EXPECT_EQ(object.namedArgs, 0);
+        EXPECT_EQ(property.getV(1).lVal, 13);
+
+        com::BoundProperty reference = dispatch.bindProperty(L"Value", com::PUTREF);
+        EXPECT_TRUE(reference.put(3));
+        EXPECT_EQ(object.flags, DISPATCH_PROPERTYPUTREF);
+        EXPECT_THROW(dispatch.bindProperty(L"Value", com::METHOD), std::invalid_argument);
+        EXPECT_EQ(object.lookups, 1);
+    }
+    EXPECT_EQ(object.references(), 1);
+}
@@ -9,6 +9,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <clocale>
+#include <map>
+#include <unordered_map>
+
 namespace com = autocom;
 
 
@@ -78,3 +83,264 @@ TEST(Bstr, OPERATORS)
     EXPECT_NE(empty, bstr);
     EXPECT_EQ(bstr, copy);
 }
+
+
+TEST(Bstr, Narrow)
+{
+    com::Bstr wide(L"Workbooks");
+    EXPECT_EQ(com::Bstr("Workbooks"), wide);
+    EXPECT_EQ(com::Bstr(std::string("Workbooks")), wide);
+    EXPECT_EQ(com::Bstr("Workbooks.Add", 9), wide);
+    EXPECT_EQ(std::string(wide), "Workbooks");
+
+    BSTR bstr = com::WIDE_BSTR("Workbooks");
+    EXPECT_EQ(SysStringLen(bstr), 9);
+    EXPECT_EQ(com::Bstr(std::move(bstr)), wide);
+}
+
+
+TEST(Bstr, Ownership)
+{
+    com::Bstr bstr(L"Workbooks");
+    BSTR released = bstr.release();
+    EXPECT_EQ(bstr.data(), nullptr);
+    EXPECT_EQ(SysStringLen(released), 9);
+
+    // transcoding reuses the storage when it is long enough
+    bstr.reset(released);
+    bstr.fromUtf8Into("caf\xc3\xa9");
+    EXPECT_EQ(bstr.data(), released);
+    EXPECT_EQ(bstr, com::Bstr(L"caf\u00e9"));
+    bstr.fromUtf8Into(std::string("Workbooks.Add"));
+    EXPECT_EQ(bstr, com::Bstr(L"Workbooks.Add"));
+    EXPECT_THROW(bstr.fromUtf8Into("\xff", 1), std::exception);
+}
+
+
+TEST(Bstr, Shadow)
+{
+    com::ShadowBstr shadow(com::Bstr(L"caf\u00e9"));
+    EXPECT_FALSE(shadow.shadowed());
+    const std::string &narrow = shadow.str();
+    EXPECT_EQ(narrow, "caf\xc3\xa9");
+    EXPECT_TRUE(shadow.shadowed());
+    EXPECT_EQ(&shadow.str(), &narrow);
+
+    // long enough to be heap-allocated, so the buffer moves
+    std::string adopted("Workbooks.ActiveSheet.Name");
+    const char *buffer = adopted.data();
+    shadow.reset(std::move(adopted));
+    EXPECT_TRUE(shadow.shadowed());
+    EXPECT_EQ(shadow.str().data(), buffer);
+    EXPECT_EQ(shadow.bstr(), com::Bstr(L"Workbooks.ActiveSheet.Name"));
+    EXPECT_EQ(shadow.size(), 26);
+    EXPECT_EQ(com::BstrView(shadow), com::BstrView(L"Workbooks.ActiveSheet.Name"));
+
+    BSTR released = shadow.release();
+    EXPECT_TRUE(shadow.empty());
+    EXPECT_FALSE(shadow.shadowed());
+    SysFreeString(released);
+}
+
+
+TEST(Bstr, Compare)
+{
+    com::Bstr apple(L"Apple");
+    com::Bstr banana(L"banana");
+    EXPECT_LT(apple, banana);
+    EXPECT_LE(apple, apple);
+    EXPECT_GT(banana, apple);
+    EXPECT_GE(banana, banana);
+    EXPECT_LT(com::Bstr(L"Work"), com::Bstr(L"Workbooks"));
+    EXPECT_EQ(apple.compare(L"Apple"), 0);
+    EXPECT_LT(apple.compare(L"apple"), 0);
+
+    // case-insensitive, including long strings and their tails
+    EXPECT_EQ(apple.compareNoCase(L"aPPLE"), 0);
+    EXPECT_LT(apple.compareNoCase(L"APPLES"), 0);
+    EXPECT_GT(banana.compareNoCase(L"APPLE"), 0);
+    std::wstring lower(100, L'x');
+    std::wstring upper(100, L'X');
+    EXPECT_EQ(com::Bstr(lower).compareNoCase(upper), 0);
+    upper[70] = L'Y';
+    EXPECT_LT(com::Bstr(lower).compareNoCase(upper), 0);
+    EXPECT_LT(com::Bstr(upper).compare(lower), 0);
+
+    std::map<com::Bstr, int> ordered = {{L"b", 2}, {L"a", 1}};
+    EXPECT_EQ(ordered.begin()->second, 1);
+    std::map<com::Bstr, int, com::BstrLessNoCase> names = {{L"Value", 1}};
+    EXPECT_EQ(names.count(L"VALUE"), 1);
+}
+
+
+TEST(Bstr, Hash)
+{
+    std::hash<com::Bstr> hash;
+    EXPECT_EQ(hash(com::Bstr(L"Value")), hash(com::Bstr("Value")));
+    EXPECT_NE(hash(com::Bstr(L"Value")), hash(com::Bstr(L"value")));
+    EXPECT_EQ(hash(com::Bstr(L"Value")), std::hash<com::BstrView>()(L"Value"));
+
+    std::unordered_map<com::Bstr, int> cache;
+    cache[L"Value"] = 1;
+    EXPECT_EQ(cache.count(L"Value"), 1);
+    EXPECT_EQ(cache.count(L"value"), 0);
+
+    // case-insensitive, across the folding blocks
+    com::BstrHashNoCase nocase;
+    std::wstring lower(200, L'a');
+    std::wstring upper(200, L'A');
+    EXPECT_EQ(nocase(lower), nocase(upper));
+    EXPECT_NE(nocase(lower), nocase(lower.substr(1)));
+
+    std::unordered_map<com::Bstr, int, com::BstrHashNoCase, com::BstrEqualNoCase> names;
+    names[L"Value"] = 1;
+    EXPECT_EQ(names.count(L"VALUE"), 1);
+    EXPECT_EQ(names.count(L"Values"), 0);
+}
+
+
+TEST(Bstr, FoldCase)
+{
+    // Latin-1, Latin Extended-A, Greek and Cyrillic
+    const std::wstring lower(L"\u00E9t\u00E9 \u00FF \u0101 \u03C3\u03C2 \u0436");
+    const std::wstring upper(L"\u00C9T\u00C9 \u0178 \u0100 \u03A3\u03A3 \u0416");
+    com::BstrHashNoCase hash;
+    com::BstrEqualNoCase equal;
+    EXPECT_TRUE(equal(lower, upper));
+    EXPECT_EQ(hash(lower), hash(upper));
+    EXPECT_FALSE(equal(std::wstring(L"\u00E9"), std::wstring(L"E")));
+
+    // the fold does not depend on the C locale
+    std::unordered_map<com::Bstr, int, com::BstrHashNoCase, com::BstrEqualNoCase> names;
+    names[upper] = 1;
+    const size_t before = hash(lower);
+    std::setlocale(LC_ALL, "");
+    EXPECT_EQ(hash(lower), before);
+    EXPECT_EQ(names.count(lower), 1);
+    std::setlocale(LC_ALL, "C");
+    EXPECT_EQ(hash(lower), before);
+    EXPECT_EQ(names.count(lower), 1);
+}
+
+
+TEST(BstrBuilder, Append)
+{
+    com::BstrBuilder builder;
+    EXPECT_TRUE(builder.empty());
+
+    builder.append(L"SELECT ");
+    builder.append(std::string("* FROM"));
+    builder += L' ';
+    for (wchar_t c: std::wstring(L"Table")) {
+        builder.push_back(c);
+    }
+    EXPECT_EQ(builder.size(), 19);
+    EXPECT_GE(builder.capacity(), builder.size());
+
+    com::Bstr statement = builder.str();
+    EXPECT_EQ(statement, com::Bstr(L"SELECT * FROM Table"));
+    EXPECT_EQ(SysStringLen(statement), 19);
+    EXPECT_EQ(statement.data()[19], L'\0');
+    EXPECT_TRUE(builder.empty());
+}
+
+
+TEST(BstrBuilder, Reserve)
+{
+    com::BstrBuilder builder(64);
+    EXPECT_EQ(builder.capacity(), 64);
+
+    builder.append("Workbooks");
+    auto *data = builder.data();
+    builder.reserve(32);
+    EXPECT_EQ(builder.capacity(), 64);
+    EXPECT_EQ(builder.data(), data);
+
+    size_t reallocations = 0;
+    size_t capacity = builder.capacity();
+    for (size_t i = 0; i < 10000; ++i) {
+        builder.push_back(L'x');
+        if (builder.capacity() != capacity) {
+            capacity = builder.capacity();
+            ++reallocations;
+        }
+    }
+    EXPECT_LT(reallocations, 16);
+    EXPECT_EQ(std::wstring(builder.data(), 9), L"Workbooks");
+    EXPECT_EQ(std::count(builder.data() + 9, builder.data() + builder.size(), L'x'), 10000);
+
+    BSTR bstr = builder.release();
+    EXPECT_EQ(SysStringLen(bstr), 10009);
+    EXPECT_EQ(bstr[10009], L'\0');
+    SysFreeString(bstr);
+}
+
+
+TEST(BstrBuilder, Pooled)
+{
+    // growth reuses pooled strings, which hold stale characters
+    com::setBstrPool(true);
+    for (size_t i = 0; i < 4; ++i) {
+        com::FREE_BSTR(com::ALLOC_BSTR(std::wstring(200, L'?').data(), 200));
+    }
+
+    com::BstrBuilder builder;
+    std::wstring expected;
+    for (size_t i = 0; i < 150; ++i) {
+        const wchar_t c = static_cast<wchar_t>(L'a' + i % 26);
+        builder.push_back(c);
+        expected.push_back(c);
+    }
+    com::Bstr string = builder.str();
+    EXPECT_EQ(std::wstring(string.data(), string.size()), expected);
+
+    com::trimBstrPool();
+    com::setBstrPool(false);
+}
+
+
+TEST(BstrView, Access)
+{
+    com::Bstr bstr(L"Workbooks");
+    com::BstrView view(bstr);
+    EXPECT_EQ(view.data(), bstr.data());
+    EXPECT_EQ(view.size(), 9);
+    EXPECT_TRUE(view.terminated());
+    EXPECT_EQ(view.front(), L'W');
+    EXPECT_EQ(view.back(), L's');
+    EXPECT_EQ(*view.rbegin(), L's');
+    EXPECT_EQ(std::string(view), "Workbooks");
+
+    com::Bstr null;
+    com::BstrView empty(null);
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.data()[0], L'\0');
+
+    VARIANT variant;
+    variant.vt = VT_BSTR;
+    variant.bstrVal = bstr;
+    EXPECT_EQ(com::BstrView(variant).data(), bstr.data());
+
+    static_assert(std::is_trivially_copyable<com::BstrView>::value, "BstrView must be trivially copyable");
+}
+
+
+TEST(BstrView, Operations)
+{
+    com::BstrView view(L"Workbooks.Add");
+    EXPECT_EQ(view.find(L'.'), 9);
+    EXPECT_EQ(view.find(L"Add"), 10);
+    EXPECT_EQ(view.find(L'x'), com::BstrView::npos);
+
+    auto head = view.substr(0, 9);
+    auto tail = view.substr(10);
+    EXPECT_FALSE(head.terminated());
+    EXPECT_TRUE(tail.terminated());
+    EXPECT_EQ(head, com::BstrView(L"Workbooks"));
+    EXPECT_EQ(tail, com::Bstr(L"Add"));
+
+    EXPECT_LT(tail, head);
+    EXPECT_GT(view, head);
+    EXPECT_EQ(head.compare(L"Workbooks"), 0);
+    EXPECT_EQ(std::hash<com::BstrView>()(head), std::hash<com::BstrView>()(L"Workbooks"));
+}
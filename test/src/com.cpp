@@ -0,0 +1,208 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief DispatchBase test suite.
+ */
+
+#include "autocom.hpp"
+#include "fake.hpp"
+
+#include <gtest/gtest.h>
+
+#include <objbase.h>
+
+namespace com = autocom;
+
+
+// OBJECTS
+// -------
+
+
+/** \brief IDispatch which returns a new, large SAFEARRAY per call.
+ */
+class ArrayDispatch: public FakeDispatch
+{
+public:
+    static constexpr ULONG size = 1 << 16;
+
+    SAFEARRAY *last = nullptr;
+
+    HRESULT STDMETHODCALLTYPE GetIDsOfNames(REFIID,
+        LPOLESTR *,
+        UINT count,
+        LCID,
+        DISPID *ids) override
+    {
+        for (UINT i = 0; i < count; ++i) {
+            ids[i] = 1;
+        }
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Invoke(DISPID,
+        REFIID,
+        LCID,
+        WORD,
+        DISPPARAMS *,
+        VARIANT *result,
+        EXCEPINFO *,
+        UINT *) override
+    {
+        if (!result) {
+            return S_OK;
+        }
+
+        SAFEARRAYBOUND bound = {size, 0};
+        last = SafeArrayCreate(VT_R8, 1, &bound);
+        result->vt = VT_ARRAY | VT_R8;
+        result->parray = last;
+        return S_OK;
+    }
+};
+
+
+/** \brief Malloc spy which counts task allocations of at least `minimum`
+ *  bytes, such as the data of large SAFEARRAYs.
+ */
+class LargeAllocationSpy: public IMallocSpy
+{
+public:
+    SIZE_T minimum;
+    UINT allocations = 0;
+
+    LargeAllocationSpy(const SIZE_T minimum):
+        minimum(minimum)
+    {}
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid,
+        void **object) override
+    {
+        if (riid == IID_IUnknown || riid == IID_IMallocSpy) {
+            *object = this;
+            return S_OK;
+        }
+        *object = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override
+    {
+        return 1;
+    }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        return 1;
+    }
+
+    SIZE_T STDMETHODCALLTYPE PreAlloc(SIZE_T request) override
+    {
+        if (request >= minimum) {
+            ++allocations;
+        }
+        return request;
+    }
+
+    void * STDMETHODCALLTYPE PostAlloc(void *actual) override
+    {
+        return actual;
+    }
+
+    void * STDMETHODCALLTYPE PreFree(void *request,
+        BOOL) override
+    {
+        return request;
+    }
+
+    void STDMETHODCALLTYPE PostFree(BOOL) override
+    {}
+
+    SIZE_T STDMETHODCALLTYPE PreRealloc(void *request,
+        SIZE_T size,
+        void **next,
+        BOOL) override
+    {
+        if (size >= minimum) {
+            ++allocations;
+        }
+        *next = request;
+        return size;
+    }
+
+    void * STDMETHODCALLTYPE PostRealloc(void *actual,
+        BOOL) override
+    {
+        return actual;
+    }
+
+    void * STDMETHODCALLTYPE PreGetSize(void *request,
+        BOOL) override
+    {
+        return request;
+    }
+
+    SIZE_T STDMETHODCALLTYPE PostGetSize(SIZE_T actual,
+        BOOL) override
+    {
+        return actual;
+    }
+
+    void * STDMETHODCALLTYPE PreDidAlloc(void *request,
+        BOOL) override
+    {
+        return request;
+    }
+
+    int STDMETHODCALLTYPE PostDidAlloc(void *,
+        BOOL,
+        int actual) override
+    {
+        return actual;
+    }
+
+    void STDMETHODCALLTYPE PreHeapMinimize() override
+    {}
+
+    void STDMETHODCALLTYPE PostHeapMinimize() override
+    {}
+};
+
+// TESTS
+// -----
+
+
+TEST(DispatchBase, ResultArray)
+{
+    ArrayDispatch object;
+    {
+        com::DispatchBase dispatch(object.acquire());
+        LargeAllocationSpy spy(ArrayDispatch::size * sizeof(DOUBLE));
+        ASSERT_EQ(CoRegisterMallocSpy(&spy), S_OK);
+
+        {
+            // the server allocates the array data once, any copy is another
+            com::Variant result = dispatch.methodV(L"Spectrum");
+            EXPECT_EQ(spy.allocations, 1);
+            EXPECT_EQ(result.vt, VT_ARRAY | VT_R8);
+            EXPECT_EQ(result.parray, object.last);
+            EXPECT_EQ(result.parray->rgsabound[0].cElements, ArrayDispatch::size);
+
+            // move assignment releases the previous array
+            result = dispatch.methodV(L"Spectrum");
+            EXPECT_EQ(spy.allocations, 2);
+            EXPECT_EQ(result.parray, object.last);
+
+            EXPECT_TRUE(dispatch.method(L"Spectrum"));
+            EXPECT_EQ(spy.allocations, 3);
+
+            // sanity check: a copy is counted
+            com::Variant copy(result);
+            EXPECT_EQ(spy.allocations, 4);
+        }
+
+        // spied arrays must be freed before revoking the spy
+        EXPECT_EQ(CoRevokeMallocSpy(), S_OK);
+    }
+    EXPECT_EQ(object.references(), 1);
+}
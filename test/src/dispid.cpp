@@ -0,0 +1,145 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief DISPID cache test suite.
+ */
+
+#include "autocom.hpp"
+#include "fake.hpp"
+
+#include <gtest/gtest.h>
+
+namespace com = autocom;
+
+
+// OBJECTS
+// -------
+
+
+/** \brief IDispatch which counts calls to GetIDsOfNames.
+ */
+class CountingDispatch: public FakeDispatch
+{
+public:
+    UINT lookups = 0;
+
+    HRESULT STDMETHODCALLTYPE GetIDsOfNames(REFIID,
+        LPOLESTR *names,
+        UINT count,
+        LCID,
+        DISPID *ids) override
+    {
+        ++lookups;
+        for (UINT i = 0; i < count; ++i) {
+            ids[i] = static_cast<DISPID>(towlower(names[i][0]));
+        }
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Invoke(DISPID id,
+        REFIID,
+        LCID,
+        WORD,
+        DISPPARAMS *,
+        VARIANT *result,
+        EXCEPINFO *,
+        UINT *) override
+    {
+        if (result) {
+            result->vt = VT_I4;
+            result->lVal = static_cast<LONG>(id);
+        }
+        return S_OK;
+    }
+};
+
+// TESTS
+// -----
+
+
+TEST(DispidCache, Find)
+{
+    com::DispidCache cache;
+    DISPID id = 0;
+    EXPECT_FALSE(cache.find(com::BstrView(L"Count"), id));
+
+    cache.insert(com::BstrView(L"Count"), 7);
+    EXPECT_TRUE(cache.find(com::BstrView(L"Count"), id));
+    EXPECT_EQ(id, 7);
+    EXPECT_TRUE(cache.find(com::BstrView(L"COUNT"), id));
+    EXPECT_EQ(cache.size(), 1);
+
+    cache.clear();
+    EXPECT_FALSE(cache.find(com::BstrView(L"count"), id));
+    EXPECT_EQ(cache.size(), 0);
+
+    // the cache owns its names, so temporary names stay valid
+    {
+        std::wstring name(L"Expando1");
+        cache.insert(com::BstrView(name.data(), name.size()), 3);
+        cache.insert(com::BstrView(name.data(), name.size()), 4);
+        name.assign(name.size(), L'?');
+    }
+    EXPECT_TRUE(cache.find(com::BstrView(L"EXPANDO1"), id));
+    EXPECT_EQ(id, 3);
+    EXPECT_EQ(cache.size(), 1);
+}
+
+
+TEST(DispidCache, Dispatch)
+{
+    CountingDispatch object;
+    {
+        com::DispatchBase dispatch(object.acquire());
+        LONG value;
+
+        dispatch.get(L"Count", value);
+        dispatch.get(L"Count", value);
+        dispatch.get(L"count", value);
+        EXPECT_EQ(value, static_cast<LONG>(L'c'));
+        EXPECT_EQ(object.lookups, 1);
+
+        // copies share the cache
+        com::DispatchBase copy(dispatch);
+        copy.get(L"COUNT", value);
+        EXPECT_EQ(object.lookups, 1);
+
+        dispatch.invalidate();
+        copy.get(L"Count", value);
+        EXPECT_EQ(object.lookups, 2);
+
+        dispatch.get(L"Item", value);
+        EXPECT_EQ(value, static_cast<LONG>(L'i'));
+        EXPECT_EQ(object.lookups, 3);
+    }
+    EXPECT_EQ(object.references(), 1);
+}
+
+
+TEST(DispidCache, CopyBeforeLookup)
+{
+    CountingDispatch object;
+    {
+        com::DispatchBase dispatch(object.acquire());
+        com::DispatchBase copy(dispatch);
+        com::DispatchBase assigned;
+        assigned = dispatch;
+        LONG value;
+
+        copy.get(L"Count", value);
+        dispatch.get(L"Count", value);
+        assigned.get(L"Count", value);
+        EXPECT_EQ(object.lookups, 1);
+    }
+    EXPECT_EQ(object.references(), 1);
+}
+
+
+TEST(DispidCache, NullDispatch)
+{
+    com::DispatchBase dispatch;
+    LONG value;
+    EXPECT_THROW(dispatch.get(L"Count", value), std::runtime_error);
+    dispatch.invalidate();
+}
@@ -72,3 +72,34 @@ TEST(DispParams, SetString)
     dp.setArgs(com::PutBstr());
     EXPECT_EQ(dp.params()->rgvarg[0].vt, 8);
 }
+
+
+TEST(DispParamsN, SetArgs)
+{
+    com::DispParamsN<0> none;
+    none.setArgs();
+    EXPECT_EQ(none.params()->cArgs, 0);
+    EXPECT_TRUE(none.params()->rgvarg == nullptr);
+
+    // arguments are stored in reverse order, in place
+    BOOL boolean = FALSE;
+    INT integer;
+    com::DispParamsN<2> dp;
+    dp.setArgs(com::PutBool(boolean), com::PutInt(integer));
+    EXPECT_EQ(dp.size(), 2);
+    EXPECT_EQ(dp.params()->cArgs, 2);
+    EXPECT_EQ(dp.params()->rgvarg, dp.args());
+    EXPECT_EQ(dp.params()->rgvarg[0].vt, 22);
+    EXPECT_EQ(dp.params()->rgvarg[1].vt, 11);
+
+    EXPECT_EQ(dp.params()->cNamedArgs, 0);
+    dp.setFlags(com::PUT);
+    EXPECT_EQ(dp.params()->cNamedArgs, 1);
+    EXPECT_EQ(dp.params()->rgdispidNamedArgs[0], DISPID_PROPERTYPUT);
+
+    com::DispParamsN<1> string;
+    string.setArgs(L"wide");
+    EXPECT_EQ(string.params()->rgvarg[0].vt, 8);
+    string.setArgs("narrow");
+    EXPECT_EQ(string.params()->rgvarg[0].vt, 8);
+}
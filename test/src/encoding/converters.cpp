@@ -5,10 +5,12 @@
  *  \brief Encoding converter unittests.
  */
 
-#include "autocom.hpp"
+#include "autocom/encoding.hpp"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 namespace com = autocom;
 
 // TESTS
@@ -24,3 +26,82 @@ TEST(EncodingConverters, Wide)
     EXPECT_EQ(wide[1], 44397);
     EXPECT_EQ(wide[2], 50612);
 }
+
+
+TEST(EncodingConverters, Narrow)
+{
+    std::wstring wide = {54620, 44397, 50612};
+    auto utf8 = com::NARROW(wide);
+    EXPECT_EQ(utf8, std::string({-19, -107, -100, -22, -75, -83, -20, -106, -76}));
+}
+
+
+TEST(EncodingConverters, Ascii)
+{
+    std::string narrow = "Excel.Application.Workbooks.Add";
+    auto wide = com::WIDE(narrow);
+    EXPECT_EQ(wide, L"Excel.Application.Workbooks.Add");
+    EXPECT_EQ(com::NARROW(wide), narrow);
+}
+
+
+TEST(EncodingConverters, Mixed)
+{
+    // ASCII prefix followed by multi-byte characters
+    std::string narrow = "Workbook \xed\x95\x9c\xea\xb5\xad\xec\x96\xb4 Sheet1";
+    auto wide = com::WIDE(narrow);
+    EXPECT_EQ(wide.size(), 19);
+    EXPECT_EQ(wide[9], 54620);
+    EXPECT_EQ(com::NARROW(wide), narrow);
+}
+
+
+TEST(EncodingConverters, Buffer)
+{
+    std::string narrow = "Workbook \xed\x95\x9c";
+    wchar_t wide[16];
+    EXPECT_EQ(com::WIDE_LENGTH(narrow.data(), narrow.size()), 10);
+    EXPECT_EQ(com::WIDE(narrow.data(), narrow.size(), wide, 10), 10);
+    EXPECT_EQ(wide[9], 54620);
+    EXPECT_THROW(com::WIDE(narrow.data(), narrow.size(), wide, 9), com::utf::detail::BufferRangeError);
+
+    char utf8[16];
+    EXPECT_EQ(com::NARROW_LENGTH(wide, 10), narrow.size());
+    EXPECT_EQ(com::NARROW(wide, 10, utf8, 12), narrow.size());
+    EXPECT_EQ(std::string(utf8, narrow.size()), narrow);
+    EXPECT_THROW(com::NARROW(wide, 10, utf8, 11), com::utf::detail::BufferRangeError);
+
+    // exact sizes skip the check, but stay within the buffer
+    std::fill(wide, wide + 16, L'\0');
+    EXPECT_EQ(com::WIDE_EXACT(narrow.data(), narrow.size(), wide, 10), 10);
+    EXPECT_EQ(wide[9], 54620);
+    EXPECT_EQ(com::WIDE_EXACT(narrow.data(), narrow.size(), wide, 4), 4);
+    EXPECT_EQ(com::NARROW_EXACT(wide, 10, utf8, narrow.size()), narrow.size());
+    EXPECT_EQ(std::string(utf8, narrow.size()), narrow);
+    EXPECT_EQ(com::NARROW_EXACT(wide, 10, utf8, 4), 4);
+}
+
+
+TEST(EncodingConverters, Scratch)
+{
+    const std::wstring &first = com::WIDE_SCRATCH("Workbooks");
+    EXPECT_EQ(first.size(), 9);
+    EXPECT_EQ(first[0], L'W');
+
+    // reuses the same thread-local buffer
+    const std::wstring &second = com::WIDE_SCRATCH("Add");
+    EXPECT_EQ(&first, &second);
+    EXPECT_EQ(second.size(), 3);
+
+    const std::string &narrow = com::NARROW_SCRATCH(std::wstring(L"Sheets"));
+    EXPECT_EQ(narrow, "Sheets");
+}
+
+
+TEST(EncodingConverters, Allocator)
+{
+    std::string narrow = "ActiveSheet";
+    auto wide = com::WIDE(narrow, std::allocator<wchar_t>());
+    EXPECT_EQ(wide.size(), narrow.size());
+    EXPECT_EQ(com::NARROW(wide, std::allocator<char>()), narrow);
+}
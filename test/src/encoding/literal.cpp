@@ -0,0 +1,54 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief Compile-time wide literal unittests.
+ */
+
+#include "autocom/encoding.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace com = autocom;
+namespace utf = com::utf;
+
+// CONSTANTS
+// ---------
+
+constexpr auto ASCII = utf::wideLiteral("GetVersionNumber");
+static_assert(ASCII.size() == 16, "Literal must be transcoded at compile time");
+static_assert(ASCII.data()[0] == L'G' && ASCII.data()[15] == L'r', "Unexpected code units");
+static_assert(ASCII.data()[16] == 0, "Literal must be null-terminated");
+
+constexpr auto BMP = utf::wideLiteral("\xed\x95\x9c\xea\xb8\x80");
+static_assert(BMP.size() == 2, "Unexpected BMP length");
+static_assert(BMP.data()[0] == 0xD55C && BMP.data()[1] == 0xAE00, "Unexpected BMP code units");
+
+constexpr auto ASTRAL = utf::wideLiteral("\xf0\x9f\x98\x80");
+static_assert(ASTRAL.size() == (sizeof(wchar_t) == 2 ? 2 : 1), "Unexpected astral length");
+
+
+// TESTS
+// -----
+
+
+TEST(WideLiteral, Ascii)
+{
+    auto &literal = AUTOCOM_WIDE("GetVersionNumber");
+    EXPECT_EQ(std::wstring(literal.data(), literal.size()), L"GetVersionNumber");
+    EXPECT_EQ(literal.c_str()[literal.size()], 0);
+}
+
+
+TEST(WideLiteral, Unicode)
+{
+    auto &literal = AUTOCOM_WIDE("A\xed\x95\x9c\xf0\x9f\x98\x80Z");
+    std::vector<uint32_t> expected = {0x41, 0xD55C, 0xD83D, 0xDE00, 0x5A};
+    if (sizeof(wchar_t) == 4) {
+        expected = {0x41, 0xD55C, 0x1F600, 0x5A};
+    }
+    EXPECT_EQ(std::vector<uint32_t>(literal.data(), literal.data() + literal.size()), expected);
+}
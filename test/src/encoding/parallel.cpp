@@ -0,0 +1,84 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief Parallel transcoding unittests.
+ */
+
+#include "autocom/encoding.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+namespace com = autocom;
+namespace utf = com::utf;
+
+
+// HELPERS
+// -------
+
+
+/** \brief Generate UTF-8 text mixing ASCII, CJK and emoji.
+ */
+std::string randomUtf8(const size_t length)
+{
+    const char *characters[] = {"a", "Z", " ", "\xc3\xa9", "\xed\x95\x9c", "\xf0\x9f\x98\x80"};
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<size_t> index(0, 5);
+
+    std::string text;
+    while (text.size() < length) {
+        text += characters[index(generator)];
+    }
+
+    return text;
+}
+
+// TESTS
+// -----
+
+
+TEST(UnicodeParallel, Workers)
+{
+    EXPECT_EQ(utf::SERIAL.workers(1 << 30), 1);
+    EXPECT_EQ(utf::Parallel(1 << 20, 4).workers(1000), 1);
+    EXPECT_EQ(utf::Parallel(0, 4).workers(1 << 20), 4);
+    EXPECT_EQ(utf::Parallel(0, 64).workers(1 << 17), 2);
+}
+
+
+TEST(UnicodeParallel, Convert)
+{
+    const utf::Parallel parallel(0, 7);
+    auto utf8 = randomUtf8(1 << 20);
+    auto utf16 = utf::utf8To16(utf8);
+
+    EXPECT_EQ(utf::utf8To16(utf8, parallel), utf16);
+    EXPECT_EQ(utf::utf16To8(utf16, parallel), utf8);
+
+    // below the threshold
+    EXPECT_EQ(utf::utf8To16(utf8, utf::Parallel(1 << 30, 7)), utf16);
+}
+
+
+TEST(UnicodeParallel, Invalid)
+{
+    const utf::Parallel parallel(0, 4);
+    auto utf8 = randomUtf8(1 << 19);
+    utf8[utf8.size() - 100] = '\xff';
+    EXPECT_THROW(utf::utf8To16(utf8, parallel), utf::detail::IllegalCharacterError);
+}
+
+
+TEST(UnicodeParallel, Default)
+{
+    auto previous = utf::parallel();
+    EXPECT_EQ(previous.threshold, utf::SERIAL.threshold);
+
+    utf::setParallel(utf::Parallel(1024, 3));
+    EXPECT_EQ(utf::parallel().threshold, 1024);
+    EXPECT_EQ(utf::parallel().threads, 3);
+    utf::setParallel(previous);
+}
@@ -0,0 +1,482 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief Vectorized Unicode kernel unittests.
+ */
+
+#include "autocom/encoding.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace com = autocom;
+namespace utf = com::utf;
+
+
+// HELPERS
+// -------
+
+typedef std::vector<uint8_t> Utf8;
+typedef std::vector<uint16_t> Utf16;
+typedef std::vector<uint32_t> Utf32;
+typedef std::pair<bool, size_t> Status;
+
+
+/** \brief Generate random text from ASCII, Latin, CJK and emoji.
+ */
+Utf32 randomText(std::mt19937 &generator,
+    const size_t length,
+    const double ascii)
+{
+    std::uniform_real_distribution<double> coin(0, 1);
+    std::uniform_int_distribution<uint32_t> plane(0, 2);
+    std::uniform_int_distribution<uint32_t> ranges[] = {
+        std::uniform_int_distribution<uint32_t>(0x00, 0x7F),
+        std::uniform_int_distribution<uint32_t>(0x80, 0x7FF),
+        std::uniform_int_distribution<uint32_t>(0x4E00, 0x9FFF),
+        std::uniform_int_distribution<uint32_t>(0x1F300, 0x1F6FF),
+    };
+
+    Utf32 text;
+    for (size_t i = 0; i < length; ++i) {
+        if (coin(generator) < ascii) {
+            text.push_back(ranges[0](generator));
+        } else {
+            text.push_back(ranges[1 + plane(generator)](generator));
+        }
+    }
+
+    return text;
+}
+
+
+/** \brief Generate text mostly from the code points in [first, last].
+ *
+ *  Sprinkles in ASCII spaces, and emoji at the given rate, so blocks
+ *  mix 1-byte, multi-byte and 4-byte characters.
+ */
+Utf32 scriptText(std::mt19937 &generator,
+    const size_t length,
+    const uint32_t first,
+    const uint32_t last,
+    const double emoji)
+{
+    std::uniform_real_distribution<double> coin(0, 1);
+    std::uniform_int_distribution<uint32_t> script(first, last);
+    std::uniform_int_distribution<uint32_t> pictograph(0x1F300, 0x1F6FF);
+
+    Utf32 text;
+    for (size_t i = 0; i < length; ++i) {
+        const double value = coin(generator);
+        if (value < emoji) {
+            text.push_back(pictograph(generator));
+        } else if (value < emoji + 0.1) {
+            text.push_back(' ');
+        } else {
+            uint32_t c = script(generator);
+            text.push_back(c >= 0xD800 && c <= 0xDFFF ? 0xFFFD : c);
+        }
+    }
+
+    return text;
+}
+
+
+/** \brief Scripts for mostly non-ASCII corpora.
+ */
+const std::pair<uint32_t, uint32_t> SCRIPTS[] = {
+    {0x0410, 0x044F},       // Cyrillic
+    {0x0391, 0x03C9},       // Greek
+    {0x4E00, 0x9FFF},       // CJK
+    {0x0080, 0xFFFF},       // 2 and 3-byte boundaries
+};
+
+
+/** \brief Encode UTF-32 text as UTF-8.
+ */
+Utf8 toUtf8(const Utf32 &text)
+{
+    Utf8 output(text.size() * 4);
+    auto size = utf::detail::utf32To8(text.data(), text.data() + text.size(), output.data(), output.data() + output.size());
+    output.resize(size);
+
+    return output;
+}
+
+
+/** \brief Encode UTF-32 text as UTF-16.
+ */
+Utf16 toUtf16(const Utf32 &text)
+{
+    Utf16 output(text.size() * 2);
+    auto size = utf::detail::utf32To16(text.data(), text.data() + text.size(), output.data(), output.data() + output.size());
+    output.resize(size);
+
+    return output;
+}
+
+
+/** \brief Run a kernel, capturing any conversion error.
+ */
+template <
+    typename C1,
+    typename C2,
+    typename Function
+>
+Status run(Function function,
+    const std::vector<C1> &src,
+    std::vector<C2> &dst,
+    const bool strict)
+{
+    try {
+        auto size = function(src.data(), src.data() + src.size(), dst.data(), dst.data() + dst.size(), strict);
+        return Status(true, size);
+    } catch (std::exception&) {
+        return Status(false, 0);
+    }
+}
+
+
+/** \brief Check the vectorized and scalar UTF-8 to UTF-16 kernels agree.
+ */
+void checkUtf8To16(const Utf8 &src,
+    const size_t capacity,
+    const bool strict)
+{
+    Utf16 expected(capacity);
+    Utf16 actual(capacity);
+    auto scalar = run(utf::detail::utf8To16<const uint8_t*, uint16_t*>, src, expected, strict);
+    auto vector = run(utf::simd::utf8To16, src, actual, strict);
+
+    ASSERT_EQ(scalar, vector);
+    if (scalar.first) {
+        expected.resize(scalar.second);
+        actual.resize(vector.second);
+        ASSERT_EQ(expected, actual);
+    }
+}
+
+
+/** \brief Check the vectorized and scalar UTF-16 to UTF-8 kernels agree.
+ */
+void checkUtf16To8(const Utf16 &src,
+    const size_t capacity,
+    const bool strict)
+{
+    Utf8 expected(capacity);
+    Utf8 actual(capacity);
+    auto scalar = run(utf::detail::utf16To8<const uint16_t*, uint8_t*>, src, expected, strict);
+    auto vector = run(utf::simd::utf16To8, src, actual, strict);
+
+    ASSERT_EQ(scalar, vector);
+    if (scalar.first) {
+        expected.resize(scalar.second);
+        actual.resize(vector.second);
+        ASSERT_EQ(expected, actual);
+    }
+}
+
+
+/** \brief Count a transcoded length, capturing any conversion error.
+ */
+template <
+    typename Char,
+    typename Function
+>
+Status measure(Function function,
+    const std::vector<Char> &src,
+    const bool strict)
+{
+    try {
+        return Status(true, function(src.data(), src.data() + src.size(), strict));
+    } catch (std::exception&) {
+        return Status(false, 0);
+    }
+}
+
+
+/** \brief Check the vectorized and scalar UTF-8 length counters agree.
+ */
+void checkLength(const Utf8 &src,
+    const bool strict)
+{
+    auto scalar = measure(utf::detail::utf8To16Length<const uint8_t*>, src, strict);
+    auto vector = measure(utf::simd::utf8To16Length, src, strict);
+    ASSERT_EQ(scalar, vector);
+}
+
+
+/** \brief Check the vectorized and scalar UTF-16 length counters agree.
+ */
+void checkLength(const Utf16 &src,
+    const bool strict)
+{
+    auto scalar = measure(utf::detail::utf16To8Length<const uint16_t*>, src, strict);
+    auto vector = measure(utf::simd::utf16To8Length, src, strict);
+    ASSERT_EQ(scalar, vector);
+}
+
+
+/** \brief Run a test for every instruction set the host supports.
+ */
+template <typename Function>
+void forEachIsa(Function function)
+{
+    auto active = utf::simd::isa();
+    for (auto isa: {utf::simd::Isa::SCALAR, utf::simd::Isa::SSE2, utf::simd::Isa::AVX2, utf::simd::Isa::NEON}) {
+        if (utf::simd::supported(isa)) {
+            utf::simd::setIsa(isa);
+            function();
+        }
+    }
+    utf::simd::setIsa(active);
+}
+
+
+// TESTS
+// -----
+
+
+TEST(UnicodeSimd, Detect)
+{
+    EXPECT_TRUE(utf::simd::supported(utf::simd::Isa::SCALAR));
+    EXPECT_TRUE(utf::simd::supported(utf::simd::detect()));
+    EXPECT_TRUE(utf::simd::supported(utf::simd::isa()));
+}
+
+
+TEST(UnicodeSimd, Valid)
+{
+    forEachIsa([]() {
+        std::mt19937 generator(0);
+        for (double ascii: {1.0, 0.99, 0.9, 0.5, 0.0}) {
+            for (size_t length = 0; length < 300; length += 7) {
+                auto text = randomText(generator, length, ascii);
+                auto utf8 = toUtf8(text);
+                auto utf16 = toUtf16(text);
+
+                checkUtf8To16(utf8, utf16.size(), true);
+                checkUtf16To8(utf16, utf8.size(), true);
+
+                // truncated destination buffers
+                checkUtf8To16(utf8, utf16.size() / 2, true);
+                checkUtf16To8(utf16, utf8.size() / 2, true);
+            }
+        }
+    });
+}
+
+
+TEST(UnicodeSimd, Invalid)
+{
+    forEachIsa([]() {
+        std::mt19937 generator(1);
+        std::uniform_int_distribution<size_t> position(0, 255);
+        for (bool strict: {true, false}) {
+            for (size_t i = 0; i < 50; ++i) {
+                auto text = randomText(generator, 256, 0.95);
+                auto utf8 = toUtf8(text);
+                auto utf16 = toUtf16(text);
+                utf8[position(generator) % utf8.size()] = 0xFF;
+                utf16[position(generator) % utf16.size()] = 0xDC00;
+
+                checkUtf8To16(utf8, utf8.size() * 2, strict);
+                checkUtf16To8(utf16, utf16.size() * 4, strict);
+            }
+        }
+    });
+}
+
+
+TEST(UnicodeSimd, Ascii)
+{
+    forEachIsa([]() {
+        std::mt19937 generator(2);
+        for (size_t length = 0; length < 100; length += 3) {
+            auto text = randomText(generator, length, 1.0);
+            auto utf8 = toUtf8(text);
+            auto utf16 = toUtf16(text);
+
+            EXPECT_EQ(utf::simd::asciiLength(utf8.data(), utf8.data() + utf8.size()), length);
+            EXPECT_EQ(utf::simd::asciiLength(utf16.data(), utf16.data() + utf16.size()), length);
+
+            Utf16 wide(length);
+            Utf8 narrow(length);
+            utf::simd::widenAscii(utf8.data(), utf8.data() + utf8.size(), wide.data());
+            utf::simd::narrowAscii(utf16.data(), utf16.data() + utf16.size(), narrow.data());
+            EXPECT_EQ(wide, utf16);
+            EXPECT_EQ(narrow, utf8);
+
+            // stop at the first non-ASCII character
+            for (size_t i = 0; i < length; i += 5) {
+                auto copy8 = utf8;
+                auto copy16 = utf16;
+                copy8[i] = 0x80;
+                copy16[i] = 0x100;
+                EXPECT_EQ(utf::simd::asciiLength(copy8.data(), copy8.data() + copy8.size()), i);
+                EXPECT_EQ(utf::simd::asciiLength(copy16.data(), copy16.data() + copy16.size()), i);
+            }
+        }
+    });
+}
+
+
+TEST(UnicodeSimd, Length)
+{
+    forEachIsa([]() {
+        std::mt19937 generator(3);
+        for (double ascii: {1.0, 0.9, 0.5, 0.0}) {
+            for (size_t length = 0; length < 200; length += 11) {
+                auto text = randomText(generator, length, ascii);
+                auto utf8 = toUtf8(text);
+                auto utf16 = toUtf16(text);
+
+                EXPECT_EQ(utf::simd::utf8To16Length(utf8.data(), utf8.data() + utf8.size()), utf16.size());
+                EXPECT_EQ(utf::simd::utf16To8Length(utf16.data(), utf16.data() + utf16.size()), utf8.size());
+            }
+        }
+
+        // replacement characters in non-strict mode
+        for (size_t i = 0; i < 20; ++i) {
+            auto text = randomText(generator, 64, 0.5);
+            auto utf8 = toUtf8(text);
+            auto utf16 = toUtf16(text);
+            utf8[i % utf8.size()] = 0xFF;
+            utf16[i % utf16.size()] = 0xDC00;
+
+            Utf16 wide(utf8.size() * 2);
+            Utf8 narrow(utf16.size() * 4);
+            auto size16 = utf::simd::utf8To16(utf8.data(), utf8.data() + utf8.size(), wide.data(), wide.data() + wide.size(), false);
+            auto size8 = utf::simd::utf16To8(utf16.data(), utf16.data() + utf16.size(), narrow.data(), narrow.data() + narrow.size(), false);
+            EXPECT_EQ(utf::simd::utf8To16Length(utf8.data(), utf8.data() + utf8.size(), false), size16);
+            EXPECT_EQ(utf::simd::utf16To8Length(utf16.data(), utf16.data() + utf16.size(), false), size8);
+        }
+    });
+}
+
+
+TEST(UnicodeSimd, Compare)
+{
+    forEachIsa([]() {
+        std::mt19937 generator(4);
+        for (size_t length = 0; length < 200; length += 13) {
+            auto text = toUtf16(randomText(generator, length, 0.9));
+            Utf16 upper(text);
+            for (auto &c: upper) {
+                c = (c >= 'a' && c <= 'z') ? c - 0x20 : c;
+            }
+
+            Utf16 folded(text.size());
+            utf::simd::upperAscii(text.data(), text.data() + text.size(), folded.data());
+            EXPECT_EQ(folded, upper);
+            EXPECT_EQ(utf::simd::mismatch(text.data(), text.data(), length), length);
+            EXPECT_EQ(utf::simd::mismatchNoCase(text.data(), upper.data(), length), length);
+
+            // change one code unit beyond the letters
+            for (size_t i = 0; i < length; i += 5) {
+                Utf16 copy(text);
+                copy[i] = copy[i] == 0x7E ? 0x7D : 0x7E;
+                EXPECT_EQ(utf::simd::mismatch(text.data(), copy.data(), length), i);
+                EXPECT_EQ(utf::simd::mismatchNoCase(upper.data(), copy.data(), length), i);
+            }
+        }
+
+        // letters differ by 0x20, so do some punctuation
+        const uint16_t at[] = {'@', '[', '`', '{', 'a', 'z'};
+        const uint16_t grave[] = {'`', '{', '@', '[', 'A', 'Z'};
+        EXPECT_EQ(utf::simd::mismatchNoCase(at, grave, 6), 0);
+        EXPECT_EQ(utf::simd::mismatchNoCase(at + 4, grave + 4, 2), 2);
+    });
+}
+
+
+TEST(UnicodeSimd, Scripts)
+{
+    forEachIsa([]() {
+        std::mt19937 generator(5);
+        for (const auto &script: SCRIPTS) {
+            for (double emoji: {0.0, 0.01, 0.2}) {
+                for (size_t length = 0; length < 400; length += 17) {
+                    auto text = scriptText(generator, length, script.first, script.second, emoji);
+                    auto utf8 = toUtf8(text);
+                    auto utf16 = toUtf16(text);
+
+                    checkUtf8To16(utf8, utf16.size(), true);
+                    checkUtf16To8(utf16, utf8.size(), true);
+                    EXPECT_EQ(utf::simd::utf8To16Length(utf8.data(), utf8.data() + utf8.size()), utf16.size());
+                    EXPECT_EQ(utf::simd::utf16To8Length(utf16.data(), utf16.data() + utf16.size()), utf8.size());
+
+                    // truncated destination buffers
+                    checkUtf8To16(utf8, utf16.size() * 2 / 3, true);
+                    checkUtf16To8(utf16, utf8.size() * 2 / 3, true);
+                }
+            }
+        }
+
+        // code points around the 2 and 3-byte limits and surrogates
+        const uint32_t edges[] = {0x7F, 0x80, 0x7FF, 0x800, 0xFFF, 0x1000, 0xD7FF, 0xE000, 0xFFFD, 0xFFFF};
+        std::uniform_int_distribution<size_t> edge(0, 9);
+        for (size_t i = 0; i < 50; ++i) {
+            Utf32 text;
+            for (size_t j = 0; j < 100; ++j) {
+                text.push_back(edges[edge(generator)]);
+            }
+            auto utf8 = toUtf8(text);
+            auto utf16 = toUtf16(text);
+            checkUtf8To16(utf8, utf16.size(), true);
+            checkUtf16To8(utf16, utf8.size(), true);
+        }
+    });
+}
+
+
+TEST(UnicodeSimd, ScriptsInvalid)
+{
+    const Utf8 sequences[] = {
+        {0xC0, 0x80},               // overlong
+        {0xC1, 0xBF},
+        {0xE0, 0x80, 0x80},
+        {0xE0, 0x9F, 0xBF},
+        {0xED, 0xA0, 0x80},         // surrogates
+        {0xED, 0xBF, 0xBF},
+        {0x80},                     // stray continuation
+        {0xBF, 0xBF},
+        {0xD0},                     // truncated
+        {0xE4, 0xB8},
+        {0xF5, 0x80, 0x80, 0x80},   // invalid leads
+        {0xFF},
+    };
+    const Utf16 units[] = {
+        {0xD800},
+        {0xDC00},
+        {0xDC00, 0xD800},
+        {0xDBFF, 0x0041},
+    };
+
+    forEachIsa([&]() {
+        std::mt19937 generator(6);
+        std::uniform_int_distribution<size_t> position(0, 1023);
+        for (bool strict: {true, false}) {
+            for (const auto &script: SCRIPTS) {
+                for (size_t i = 0; i < 30; ++i) {
+                    auto text = scriptText(generator, 200, script.first, script.second, 0.0);
+                    auto utf8 = toUtf8(text);
+                    auto utf16 = toUtf16(text);
+                    const auto &sequence = sequences[i % 12];
+                    const auto &unit = units[i % 4];
+                    utf8.insert(utf8.begin() + position(generator) % utf8.size(), sequence.begin(), sequence.end());
+                    utf16.insert(utf16.begin() + position(generator) % utf16.size(), unit.begin(), unit.end());
+
+                    checkUtf8To16(utf8, utf8.size(), strict);
+                    checkUtf16To8(utf16, utf16.size() * 3, strict);
+                    checkLength(utf8, strict);
+                    checkLength(utf16, strict);
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,209 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief Incremental transcoder unittests.
+ */
+
+#include "autocom/encoding.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace com = autocom;
+namespace utf = com::utf;
+
+
+// HELPERS
+// -------
+
+
+/** \brief Transcode src in random chunks into a small output buffer.
+ */
+template <typename From, typename To>
+std::vector<To> chunked(const std::vector<From> &src,
+    std::mt19937 &generator,
+    const bool strict)
+{
+    typedef utf::Transcoder<From, To> Transcoder;
+    std::uniform_int_distribution<size_t> chunk(0, 9);
+    std::uniform_int_distribution<size_t> capacity(Transcoder::RATIO * 4, Transcoder::RATIO * 4 + 20);
+
+    Transcoder transcoder(strict);
+    std::vector<To> output;
+    std::vector<To> buffer(capacity.b());
+    auto *first = src.data();
+    auto *last = first + src.size();
+    while (first < last) {
+        auto *end = std::min(first + chunk(generator), last);
+        while (first < end) {
+            auto size = capacity(generator);
+            auto result = transcoder(first, end, buffer.data(), buffer.data() + size);
+            output.insert(output.end(), buffer.data(), buffer.data() + result.written);
+            first += result.read;
+        }
+    }
+    auto size = transcoder.flush(buffer.data(), buffer.data() + buffer.size());
+    output.insert(output.end(), buffer.data(), buffer.data() + size);
+
+    return output;
+}
+
+
+/** \brief Transcode src at once.
+ */
+template <typename From, typename To>
+std::vector<To> whole(const std::vector<From> &src,
+    const bool strict)
+{
+    typedef utf::Converter<From, To> Converter;
+    std::vector<To> output(src.size() * Converter::RATIO);
+    auto size = Converter::convert(src.data(), src.data() + src.size(), output.data(), output.data() + output.size(), strict);
+    output.resize(size);
+
+    return output;
+}
+
+
+/** \brief Transcode src split at `split`, with room for the whole output.
+ */
+template <typename From, typename To>
+std::vector<To> split(const std::vector<From> &src,
+    const size_t split,
+    const bool strict)
+{
+    typedef utf::Transcoder<From, To> Transcoder;
+
+    Transcoder transcoder(strict);
+    std::vector<To> output(src.size() * Transcoder::RATIO);
+    auto *dst = output.data();
+    auto *end = dst + output.size();
+    auto result = transcoder(src.data(), src.data() + split, dst, end);
+    EXPECT_EQ(result.read, split);
+    dst += result.written;
+    result = transcoder(src.data() + split, src.data() + src.size(), dst, end);
+    EXPECT_EQ(result.read, src.size() - split);
+    dst += result.written;
+    dst += transcoder.flush(dst, end);
+    output.resize(dst - output.data());
+
+    return output;
+}
+
+
+/** \brief Check chunked and whole conversions agree.
+ */
+template <typename From, typename To>
+void check(const std::vector<From> &src,
+    std::mt19937 &generator,
+    const bool strict)
+{
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ((whole<From, To>(src, strict)), (chunked<From, To>(src, generator, strict)));
+    }
+}
+
+// TESTS
+// -----
+
+
+TEST(Transcoder, Valid)
+{
+    std::mt19937 generator(0);
+    const std::vector<uint32_t> utf32 = {
+        0x41, 0x7FF, 0x42, 0xD55C, 0xAD6D, 0x1F600, 0x43, 0x10FFFF, 0x20, 0x800, 0x1F300, 0x44,
+    };
+    std::vector<uint16_t> utf16(utf32.size() * 2);
+    std::vector<uint8_t> utf8(utf32.size() * 4);
+    utf16.resize(utf::detail::utf32To16(utf32.data(), utf32.data() + utf32.size(), utf16.data(), utf16.data() + utf16.size()));
+    utf8.resize(utf::detail::utf32To8(utf32.data(), utf32.data() + utf32.size(), utf8.data(), utf8.data() + utf8.size()));
+
+    check<uint8_t, uint16_t>(utf8, generator, true);
+    check<uint8_t, uint32_t>(utf8, generator, true);
+    check<uint16_t, uint8_t>(utf16, generator, true);
+    check<uint16_t, uint32_t>(utf16, generator, true);
+    check<uint32_t, uint8_t>(utf32, generator, true);
+    check<uint32_t, uint16_t>(utf32, generator, true);
+}
+
+
+TEST(Transcoder, Invalid)
+{
+    std::mt19937 generator(1);
+    const std::vector<uint8_t> utf8 = {
+        0x41, 0xE4, 0xB8, 0x41, 0xE0, 0x80, 0xF0, 0x9F, 0x98, 0x80, 0xFF, 0xC3,
+        0xE4, 0xB8, 0xF0, 0x9F, 0x98, 0x80, 0x80, 0x80, 0x80, 0x80, 0xC3,
+    };
+    const std::vector<uint16_t> utf16 = {
+        0x41, 0xD800, 0x41, 0xDC00, 0xD83D, 0xDE00, 0xD800,
+        0xD800, 0xD800, 0xD800, 0xD800, 0xD800, 0xDC00, 0xDC00, 0xD800,
+    };
+
+    check<uint8_t, uint16_t>(utf8, generator, false);
+    check<uint8_t, uint32_t>(utf8, generator, false);
+    check<uint16_t, uint8_t>(utf16, generator, false);
+    check<uint16_t, uint32_t>(utf16, generator, false);
+
+    EXPECT_THROW((chunked<uint8_t, uint16_t>(utf8, generator, true)), utf::detail::IllegalCharacterError);
+    EXPECT_THROW((chunked<uint16_t, uint8_t>(utf16, generator, true)), utf::detail::IllegalCharacterError);
+}
+
+
+TEST(Transcoder, Pending)
+{
+    const uint8_t utf8[] = {0xF0, 0x9F, 0x98, 0x80};
+    uint16_t utf16[8];
+
+    utf::Transcoder<uint8_t, uint16_t> transcoder;
+    auto result = transcoder(utf8, utf8 + 2, utf16, utf16 + 8);
+    EXPECT_EQ(result.read, 2);
+    EXPECT_EQ(result.written, 0);
+    EXPECT_EQ(transcoder.pending(), 2);
+
+    result = transcoder(utf8 + 2, utf8 + 4, utf16, utf16 + 8);
+    EXPECT_EQ(result.read, 2);
+    EXPECT_EQ(result.written, 2);
+    EXPECT_EQ(transcoder.pending(), 0);
+    EXPECT_EQ(utf16[0], 0xD83D);
+    EXPECT_EQ(utf16[1], 0xDE00);
+
+    // truncated input at the end of the stream
+    transcoder(utf8, utf8 + 3, utf16, utf16 + 8);
+    EXPECT_THROW(transcoder.flush(utf16, utf16 + 8), utf::detail::IllegalCharacterError);
+    transcoder.reset();
+    EXPECT_EQ(transcoder.pending(), 0);
+    EXPECT_EQ(transcoder.flush(utf16, utf16 + 8), 0);
+}
+
+
+TEST(Transcoder, InvalidAcrossChunks)
+{
+    // truncated sequence followed by a new lead unit in the next chunk
+    const std::vector<uint8_t> utf8 = {0x41, 0xE4, 0xB8, 0xF0, 0x9F, 0x98, 0x80, 0x41};
+    const std::vector<uint16_t> utf16 = {0x41, 0xD800, 0xD800, 0xD800, 0xD800, 0xD800, 0xD800, 0x41};
+    // stray continuation units after a complete carried sequence
+    const std::vector<uint8_t> trailing = {0x41, 0xF0, 0x9F, 0x98, 0x80, 0x80, 0x80, 0x80, 0x80, 0x41};
+
+    for (size_t i = 0; i <= utf8.size(); ++i) {
+        EXPECT_EQ((whole<uint8_t, uint16_t>(utf8, false)), (split<uint8_t, uint16_t>(utf8, i, false)));
+        EXPECT_EQ((whole<uint8_t, uint32_t>(utf8, false)), (split<uint8_t, uint32_t>(utf8, i, false)));
+    }
+    for (size_t i = 0; i <= utf16.size(); ++i) {
+        EXPECT_EQ((whole<uint16_t, uint8_t>(utf16, false)), (split<uint16_t, uint8_t>(utf16, i, false)));
+        EXPECT_EQ((whole<uint16_t, uint32_t>(utf16, false)), (split<uint16_t, uint32_t>(utf16, i, false)));
+    }
+    for (size_t i = 0; i <= trailing.size(); ++i) {
+        EXPECT_EQ((whole<uint8_t, uint16_t>(trailing, false)), (split<uint8_t, uint16_t>(trailing, i, false)));
+    }
+
+    // strict mode reports the truncated sequence once the next chunk arrives
+    utf::Transcoder<uint8_t, uint16_t> transcoder;
+    uint16_t out[16];
+    auto result = transcoder(utf8.data(), utf8.data() + 3, out, out + 16);
+    EXPECT_EQ(result.read, 3);
+    EXPECT_EQ(transcoder.pending(), 2);
+    EXPECT_THROW(transcoder(utf8.data() + 3, utf8.data() + utf8.size(), out, out + 16), utf::detail::IllegalCharacterError);
+    EXPECT_EQ(transcoder.pending(), 0);
+}
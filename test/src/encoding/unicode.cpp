@@ -5,10 +5,12 @@
  *  \brief Unicode conversion unittests.
  */
 
-#include "autocom.hpp"
+#include "autocom/encoding.hpp"
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 namespace com = autocom;
 
 
@@ -34,3 +36,62 @@ TEST(Unicode, TestUtf)
     EXPECT_EQ(utf8, com::UTF32_TO_UTF8(utf32));
     EXPECT_EQ(utf16, com::UTF32_TO_UTF16(utf32));
 }
+
+
+TEST(Unicode, Invalid)
+{
+    namespace detail = com::utf::detail;
+    typedef std::vector<uint8_t> Utf8;
+    typedef std::vector<uint16_t> Utf16;
+
+    auto toUtf16 = [](const Utf8 &src, bool strict) {
+        Utf16 dst(src.size() * 2);
+        auto size = detail::utf8To16(src.data(), src.data() + src.size(), dst.data(), dst.data() + dst.size(), strict);
+        dst.resize(size);
+        return dst;
+    };
+    auto toUtf8 = [](const Utf16 &src, bool strict) {
+        Utf8 dst(src.size() * 4);
+        auto size = detail::utf16To8(src.data(), src.data() + src.size(), dst.data(), dst.data() + dst.size(), strict);
+        dst.resize(size);
+        return dst;
+    };
+
+    // overlong, encoded surrogate, above U+10FFFF, truncated, stray continuation
+    for (Utf8 utf8: {Utf8{0xC0, 0xAF}, Utf8{0xED, 0xA0, 0x80}, Utf8{0xF4, 0x90, 0x80, 0x80}, Utf8{0x41, 0xE4, 0xB8}, Utf8{0x80}}) {
+        EXPECT_THROW(toUtf16(utf8, true), detail::IllegalCharacterError);
+    }
+
+    // maximal subparts are replaced, and the invalid byte starts the next character
+    EXPECT_EQ(toUtf16({0x41, 0xE4, 0xB8, 0x41}, false), Utf16({0x41, 0xFFFD, 0x41}));
+    EXPECT_EQ(toUtf16({0xC0, 0xAF}, false), Utf16({0xFFFD, 0xFFFD}));
+    EXPECT_EQ(toUtf16({0xF0, 0x9F, 0x98, 0x80}, false), Utf16({0xD83D, 0xDE00}));
+
+    // unpaired surrogates, including a trailing high surrogate
+    for (Utf16 utf16: {Utf16{0xDC00}, Utf16{0xD800, 0x41}, Utf16{0x41, 0xD800}}) {
+        EXPECT_THROW(toUtf8(utf16, true), detail::IllegalCharacterError);
+    }
+    EXPECT_EQ(toUtf8({0xD800, 0x41}, false), Utf8({0xEF, 0xBF, 0xBD, 0x41}));
+    EXPECT_EQ(toUtf8({0x41, 0xD800}, false), Utf8({0x41, 0xEF, 0xBF, 0xBD}));
+    EXPECT_EQ(toUtf8({0xD83D, 0xDE00}, false), Utf8({0xF0, 0x9F, 0x98, 0x80}));
+}
+
+
+TEST(Unicode, Long)
+{
+    // exceed the stack buffer used for short strings
+    std::string utf8;
+    for (size_t i = 0; i < 40; ++i) {
+        utf8 += "Sheet\xed\x95\x9c\xf0\x9f\x98\x80";
+    }
+
+    auto utf16 = com::UTF8_TO_UTF16(utf8);
+    auto utf32 = com::UTF8_TO_UTF32(utf8);
+    EXPECT_EQ(utf16.size(), 40 * 8 * 2);
+    EXPECT_EQ(utf32.size(), 40 * 7 * 4);
+
+    EXPECT_EQ(utf8, com::UTF16_TO_UTF8(utf16));
+    EXPECT_EQ(utf8, com::UTF32_TO_UTF8(utf32));
+    EXPECT_EQ(utf16, com::UTF32_TO_UTF16(utf32));
+    EXPECT_EQ(utf32, com::UTF16_TO_UTF32(utf16));
+}
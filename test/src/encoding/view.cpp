@@ -0,0 +1,63 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief Lazy transcoding view unittests.
+ */
+
+#include "autocom/encoding.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace com = autocom;
+namespace utf = com::utf;
+
+
+// TESTS
+// -----
+
+
+TEST(UnicodeView, CodePoints)
+{
+    const std::string utf8 = "A\xed\x95\x9c\xf0\x9f\x98\x80Z";
+    const std::u16string utf16 = {0x41, 0xD55C, 0xD83D, 0xDE00, 0x5A};
+    const std::vector<char32_t> expected = {0x41, 0xD55C, 0x1F600, 0x5A};
+
+    auto view8 = utf::view<char32_t>(utf8);
+    auto view16 = utf::as_utf32(utf16);
+    EXPECT_EQ(std::vector<char32_t>(view8.begin(), view8.end()), expected);
+    EXPECT_EQ(std::vector<char32_t>(view16.begin(), view16.end()), expected);
+    EXPECT_TRUE(utf::view<char32_t>(std::string()).empty());
+}
+
+
+TEST(UnicodeView, Encode)
+{
+    const std::string utf8 = "A\xed\x95\x9c\xf0\x9f\x98\x80Z";
+    const std::u16string utf16 = {0x41, 0xD55C, 0xD83D, 0xDE00, 0x5A};
+
+    auto narrow = utf::as_utf8(utf16);
+    auto wide = utf::as_utf16(utf8);
+    EXPECT_EQ(std::string(narrow.begin(), narrow.end()), utf8);
+    EXPECT_EQ(std::u16string(wide.begin(), wide.end()), utf16);
+
+    // search without materializing a copy
+    auto found = std::find(wide.begin(), wide.end(), char16_t(0xDE00));
+    EXPECT_NE(found, wide.end());
+    EXPECT_EQ(std::count(narrow.begin(), narrow.end(), 'Z'), 1);
+}
+
+
+TEST(UnicodeView, Invalid)
+{
+    const std::string utf8 = "A\xff" "B";
+    auto strict = utf::as_utf16(utf8);
+    EXPECT_THROW(std::u16string(strict.begin(), strict.end()), utf::detail::IllegalCharacterError);
+
+    auto replaced = utf::as_utf16(utf8, false);
+    EXPECT_EQ(std::u16string(replaced.begin(), replaced.end()), std::u16string({0x41, 0xFFFD, 0x42}));
+}
@@ -0,0 +1,108 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief In-process IDispatch for tests and benchmarks.
+ */
+
+#pragma once
+
+#include <oaidl.h>
+
+
+// OBJECTS
+// -------
+
+
+/** \brief IDispatch with a real reference count and no type info.
+ *
+ *  Objects live on the stack and start with the single reference held
+ *  by their owner. Wrappers adopt references, so pass `acquire()` to
+ *  them, and check `references()` is 1 again once they are gone.
+ *  Derived fakes override GetIDsOfNames and Invoke.
+ */
+class FakeDispatch: public IDispatch
+{
+protected:
+    ULONG count = 1;
+
+public:
+    FakeDispatch() = default;
+    FakeDispatch(const FakeDispatch&) = delete;
+    FakeDispatch & operator=(const FakeDispatch&) = delete;
+    virtual ~FakeDispatch() = default;
+
+    /** \brief Add a reference, for a wrapper to adopt.
+     */
+    IDispatch * acquire()
+    {
+        AddRef();
+        return this;
+    }
+
+    /** \brief Get number of outstanding references.
+     */
+    ULONG references() const
+    {
+        return count;
+    }
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid,
+        void **object) override
+    {
+        if (riid == IID_IUnknown || riid == IID_IDispatch) {
+            *object = acquire();
+            return S_OK;
+        }
+        *object = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override
+    {
+        return ++count;
+    }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        return --count;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetTypeInfoCount(UINT *count) override
+    {
+        *count = 0;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetTypeInfo(UINT,
+        LCID,
+        ITypeInfo **info) override
+    {
+        *info = nullptr;
+        return E_NOTIMPL;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetIDsOfNames(REFIID,
+        LPOLESTR *,
+        UINT count,
+        LCID,
+        DISPID *ids) override
+    {
+        for (UINT i = 0; i < count; ++i) {
+            ids[i] = DISPID_UNKNOWN;
+        }
+        return DISP_E_UNKNOWNNAME;
+    }
+
+    HRESULT STDMETHODCALLTYPE Invoke(DISPID,
+        REFIID,
+        LCID,
+        WORD,
+        DISPPARAMS *,
+        VARIANT *,
+        EXCEPINFO *,
+        UINT *) override
+    {
+        return DISP_E_MEMBERNOTFOUND;
+    }
+};
@@ -28,3 +28,13 @@ TEST(GuidTest, Constructor)
     guid = autocom::Guid::fromIid(iid);
     EXPECT_EQ(iid, guid.toIid());
 }
+
+
+TEST(GuidTest, View)
+{
+    std::wstring clsid = L"{1D23188D-53FE-4C25-B032-DC70ACDBDC02}";
+    std::wstring padded = clsid + L"}}";
+    autocom::Guid guid(clsid);
+    EXPECT_EQ(autocom::Guid(autocom::BstrView(clsid)), guid);
+    EXPECT_EQ(autocom::Guid(autocom::BstrView(padded).substr(0, clsid.size())), guid);
+}
@@ -0,0 +1,38 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief BSTR interning test suite.
+ */
+
+#include "autocom.hpp"
+
+#include <gtest/gtest.h>
+
+namespace com = autocom;
+
+
+// TESTS
+// -----
+
+
+TEST(InternBstr, Shared)
+{
+    BSTR value = com::INTERN_BSTR(L"Value");
+    EXPECT_EQ(SysStringLen(value), 5);
+    EXPECT_EQ(std::wstring(value), L"Value");
+    const size_t count = com::internedBstrs();
+
+    // every spelling of the name shares one string
+    EXPECT_EQ(com::INTERN_BSTR(L"Value"), value);
+    EXPECT_EQ(com::INTERN_BSTR("Value"), value);
+    EXPECT_EQ(com::INTERN_BSTR(std::string("Value")), value);
+    EXPECT_EQ(com::INTERN_BSTR(std::wstring(L"Value")), value);
+    EXPECT_EQ(com::INTERN_BSTR(com::BstrView(L"Values", 5)), value);
+    EXPECT_EQ(com::internedBstrs(), count);
+
+    BSTR execute = com::INTERN_BSTR("Execute");
+    EXPECT_NE(execute, value);
+    EXPECT_EQ(std::wstring(execute), L"Execute");
+    EXPECT_EQ(com::internedBstrs(), count + 1);
+}
@@ -0,0 +1,120 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief BSTR pool test suite.
+ */
+
+#include "autocom.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace com = autocom;
+
+
+// OBJECTS
+// -------
+
+
+/** \brief Thread local which frees a string during thread exit.
+ */
+struct ExitString
+{
+    BSTR bstr = nullptr;
+
+    ~ExitString()
+    {
+        com::FREE_BSTR(bstr);
+    }
+};
+
+
+thread_local ExitString EXIT_STRING;
+
+
+// TESTS
+// -----
+
+
+TEST(BstrPool, Disabled)
+{
+    com::setBstrPool(false);
+    com::resetBstrPoolCounters();
+
+    BSTR bstr = com::ALLOC_BSTR(L"Hello", 5);
+    EXPECT_EQ(SysStringLen(bstr), 5);
+    com::FREE_BSTR(bstr);
+
+    auto counters = com::bstrPoolCounters();
+    EXPECT_EQ(counters.hits, 0);
+    EXPECT_EQ(counters.misses, 0);
+}
+
+
+TEST(BstrPool, Reuse)
+{
+    com::setBstrPool(true);
+    com::resetBstrPoolCounters();
+
+    BSTR first = com::ALLOC_BSTR(L"Hello World", 11);
+    com::FREE_BSTR(first);
+    BSTR second = com::ALLOC_BSTR(L"Hello", 5);
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(SysStringLen(second), 5);
+    EXPECT_EQ(std::wstring(second), L"Hello");
+
+    auto counters = com::bstrPoolCounters();
+    EXPECT_EQ(counters.hits, 1);
+    EXPECT_EQ(counters.misses, 1);
+
+    // pooled strings are plain BSTRs, which COM may free
+    SysFreeString(second);
+    {
+        com::Bstr bstr("Pooled");
+        com::Bstr copy(bstr);
+        EXPECT_EQ(copy.size(), 6);
+        EXPECT_EQ(std::string(copy), "Pooled");
+    }
+    com::Bstr bstr(L"Pool");
+    EXPECT_EQ(bstr.size(), 4);
+    EXPECT_EQ(com::bstrPoolCounters().hits, 2);
+    EXPECT_EQ(com::bstrPoolCounters().misses, 3);
+    bstr.clear();
+
+    com::setBstrPool(false);
+}
+
+
+TEST(BstrPool, Threads)
+{
+    com::setBstrPool(true);
+    com::resetBstrPoolCounters();
+
+    std::thread thread([]() {
+        // constructed before the pool cache, so destroyed after it
+        EXIT_STRING.bstr = nullptr;
+        BSTR bstr = com::ALLOC_BSTR(L"Hello", 5);
+        com::FREE_BSTR(bstr);
+        EXIT_STRING.bstr = com::ALLOC_BSTR(L"World", 5);
+        EXPECT_EQ(EXIT_STRING.bstr, bstr);
+    });
+    thread.join();
+
+    // counters of exited threads are kept
+    auto counters = com::bstrPoolCounters();
+    EXPECT_EQ(counters.hits, 1);
+    EXPECT_EQ(counters.misses, 1);
+
+    BSTR bstr = com::ALLOC_BSTR(L"Hello", 5);
+    com::FREE_BSTR(bstr);
+    counters = com::bstrPoolCounters();
+    EXPECT_EQ(counters.hits + counters.misses, 3);
+
+    com::resetBstrPoolCounters();
+    EXPECT_EQ(com::bstrPoolCounters().hits, 0);
+    EXPECT_EQ(com::bstrPoolCounters().misses, 0);
+
+    com::setBstrPool(false);
+}
@@ -6,15 +6,39 @@
  */
 
 #include "autocom.hpp"
+#include "fake.hpp"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <functional>
+#include <thread>
+
 namespace com = autocom;
 
 
 struct X { int y; };
 
 
+// OBJECTS
+// -------
+
+
+/** \brief IDispatch which records the thread of its last AddRef.
+ */
+class ThreadDispatch: public FakeDispatch
+{
+public:
+    std::thread::id thread;
+
+    ULONG STDMETHODCALLTYPE AddRef() override
+    {
+        thread = std::this_thread::get_id();
+        return FakeDispatch::AddRef();
+    }
+};
+
+
 // TESTS
 // -----
 
@@ -54,3 +78,251 @@ TEST(SafeArray, Type)
      EXPECT_EQ(com::SafeArray<X>::vt, VT_RECORD);
      EXPECT_EQ(com::SafeArray<INT>::vt, VT_INT);
 }
+
+
+TEST(SafeArray, Columns)
+{
+    // array(row, column), with 3 rows and 2 columns
+    com::SafeArrayBound bounds[2] = {3, 2};
+    SAFEARRAY *safearray = SafeArrayCreate(VT_VARIANT, 2, bounds);
+    com::SafeArray<VARIANT> array(std::move(safearray));
+
+    // the first index varies fastest
+    VARIANT *data = array.begin();
+    data[0].vt = VT_R8;
+    data[0].dblVal = 1.5;
+    data[1].vt = VT_R4;
+    data[1].fltVal = 2.5f;
+    data[2].vt = VT_I4;
+    data[2].lVal = 3;
+    data[3].vt = VT_I4;
+    data[3].lVal = 4;
+    data[4].vt = VT_I2;
+    data[4].iVal = 5;
+    data[5].vt = VT_BSTR;
+    data[5].bstrVal = SysAllocString(L"6");
+
+    auto columns = com::toColumns<DOUBLE, LONG>(array);
+    EXPECT_EQ(std::get<0>(columns), std::vector<DOUBLE>({1.5, 2.5, 3.0}));
+    EXPECT_EQ(std::get<1>(columns), std::vector<LONG>({4, 5, 6}));
+
+    // array(column, row), with 3 columns and 2 rows
+    auto rows = com::toColumns<DOUBLE, DOUBLE, com::Bstr>(array, com::ColumnIndex::FIRST);
+    EXPECT_EQ(std::get<0>(rows), std::vector<DOUBLE>({1.5, 4.0}));
+    EXPECT_EQ(std::get<1>(rows), std::vector<DOUBLE>({2.5, 5.0}));
+    EXPECT_EQ(std::string(std::get<2>(rows)[0]), "3");
+    EXPECT_EQ(std::string(std::get<2>(rows)[1]), "6");
+
+    EXPECT_THROW(com::toColumns<DOUBLE>(array), std::invalid_argument);
+}
+
+
+TEST(SafeArray, ColumnsParallel)
+{
+    // records of 2 columns, enough rows for 4 threads
+    const ULONG rows = 1 << 17;
+    com::SafeArrayBound bounds[1] = {2 * rows};
+    SAFEARRAY *safearray = SafeArrayCreate(VT_VARIANT, 1, bounds);
+    com::SafeArray<VARIANT> array(std::move(safearray));
+    VARIANT *data = array.begin();
+    for (ULONG i = 0; i < 2 * rows; ++i) {
+        data[i].vt = VT_R8;
+        data[i].dblVal = static_cast<DOUBLE>(i);
+    }
+
+    // objects are only touched by the calling thread
+    ThreadDispatch object;
+    const ULONG last = 2 * rows - 1;
+    data[last].vt = VT_DISPATCH;
+    data[last].pdispVal = object.acquire();
+    const com::Parallel parallel(0, 4);
+    EXPECT_ANY_THROW((com::toColumns<DOUBLE, DOUBLE>(array, com::ColumnIndex::LAST, parallel)));
+    EXPECT_EQ(object.thread, std::this_thread::get_id());
+
+    VariantClear(&data[last]);
+    EXPECT_EQ(object.references(), 1);
+    data[last].vt = VT_I2;
+    data[last].iVal = 7;
+    auto columns = com::toColumns<DOUBLE, DOUBLE>(array, com::ColumnIndex::LAST, parallel);
+    const auto &first = std::get<0>(columns);
+    const auto &second = std::get<1>(columns);
+    ASSERT_EQ(second.size(), rows);
+    for (ULONG i = 0; i < rows; ++i) {
+        EXPECT_EQ(first[i], 2.0 * i);
+        if (i + 1 < rows) {
+            EXPECT_EQ(second[i], 2.0 * i + 1);
+        }
+    }
+    EXPECT_EQ(second.back(), 7.0);
+}
+
+
+TEST(SafeArray, Layout)
+{
+    // array(1 to 3, 0 to 1, -1 to 2), as from VBA
+    SAFEARRAYBOUND bounds[3] = {{3, 1}, {2, 0}, {4, -1}};
+    com::SafeArray<DOUBLE> array(SafeArrayCreate(VT_R8, 3, bounds));
+    EXPECT_EQ(array.size(), 24);
+    EXPECT_EQ(array.dimensions(), 3);
+    EXPECT_EQ(array.extent(0), 3);
+    EXPECT_EQ(array.lower(0), 1);
+    EXPECT_EQ(array.stride(0), 1);
+    EXPECT_EQ(array.extent(1), 2);
+    EXPECT_EQ(array.stride(1), 3);
+    EXPECT_EQ(array.extent(2), 4);
+    EXPECT_EQ(array.lower(2), -1);
+    EXPECT_EQ(array.stride(2), 6);
+
+    for (size_t i = 0; i < array.size(); ++i) {
+        array[i] = static_cast<DOUBLE>(i);
+    }
+
+    LONG indices[3];
+    for (indices[2] = -1; indices[2] <= 2; ++indices[2]) {
+        for (indices[1] = 0; indices[1] <= 1; ++indices[1]) {
+            for (indices[0] = 1; indices[0] <= 3; ++indices[0]) {
+                DOUBLE *expected;
+                SafeArrayPtrOfIndex(array, indices, (void**) &expected);
+                EXPECT_EQ(&array[indices], expected);
+                EXPECT_EQ(array.at(indices), *expected);
+                EXPECT_EQ(&array(indices[0], indices[1], indices[2]), expected);
+            }
+        }
+    }
+
+    indices[0] = 0;
+    EXPECT_THROW(array.at(indices), std::out_of_range);
+    EXPECT_THROW(array.extent(3), std::out_of_range);
+    EXPECT_THROW(array(1, 0), std::invalid_argument);
+
+    const com::SafeArray<DOUBLE> &view = array;
+    LONG last[3] = {3, 1, 2};
+    EXPECT_EQ(view.at(last), 23.0);
+    EXPECT_EQ(view(3, 1, 2), 23.0);
+    EXPECT_EQ(view.back(), 23.0);
+}
+
+
+TEST(SafeArray, View)
+{
+    // array(1 to 3, 0 to 1), as rows and columns from Excel
+    SAFEARRAYBOUND bounds[2] = {{3, 1}, {2, 0}};
+    com::SafeArray<DOUBLE> array(SafeArrayCreate(VT_R8, 2, bounds));
+    for (size_t i = 0; i < array.size(); ++i) {
+        array[i] = static_cast<DOUBLE>(i);
+    }
+
+    auto view = array.view<2>();
+    EXPECT_EQ(view.rank(), 2);
+    EXPECT_EQ(view.size(), 6);
+    EXPECT_TRUE(view.contiguous());
+    EXPECT_EQ(view.extent(0), 3);
+    EXPECT_EQ(view.lower(0), 1);
+    EXPECT_EQ(view.stride(1), 3);
+    EXPECT_EQ(view.data(), array.data());
+    for (LONG i = 1; i <= 3; ++i) {
+        for (LONG j = 0; j <= 1; ++j) {
+            LONG indices[2] = {i, j};
+            EXPECT_EQ(&view(i, j), &array[indices]);
+        }
+    }
+    EXPECT_THROW(view.at(0, 0), std::out_of_range);
+    EXPECT_THROW(view.extent(2), std::out_of_range);
+    EXPECT_THROW(array.view<1>(), std::invalid_argument);
+
+    // columns are contiguous, rows are strided
+    auto column = view.column(1);
+    EXPECT_TRUE(column.contiguous());
+    EXPECT_EQ(column.lower(0), 1);
+    EXPECT_EQ(std::vector<DOUBLE>(column.begin(), column.end()), std::vector<DOUBLE>({3, 4, 5}));
+    auto row = view.row(2);
+    EXPECT_FALSE(row.contiguous());
+    EXPECT_EQ(row.lower(0), 0);
+    EXPECT_EQ(std::vector<DOUBLE>(row.begin(), row.end()), std::vector<DOUBLE>({1, 4}));
+    EXPECT_EQ(row.end() - row.begin(), 2);
+    EXPECT_EQ(*(1 + row.begin()), 4);
+    EXPECT_TRUE(row.begin() < row.end());
+    EXPECT_TRUE(row.end() > row.begin());
+    EXPECT_TRUE(row.begin() <= row.begin());
+    EXPECT_TRUE(row.end() >= row.begin());
+    EXPECT_FALSE(row.begin() >= row.end());
+    EXPECT_THROW(view.row(4), std::out_of_range);
+
+    // slicing keeps the original indexes
+    auto rows = view.subview(0, 2, 2);
+    EXPECT_EQ(rows.size(), 4);
+    EXPECT_EQ(rows.lower(0), 2);
+    EXPECT_EQ(&rows(2, 0), &view(2, 0));
+    EXPECT_FALSE(rows.contiguous());
+    EXPECT_THROW(view.subview(0, 2, 3), std::out_of_range);
+
+    auto transposed = view.transpose();
+    EXPECT_EQ(transposed.extent(0), 2);
+    EXPECT_EQ(&transposed(1, 3), &view(3, 1));
+
+    DOUBLE buffer[6];
+    view.copyRowMajor(buffer);
+    EXPECT_EQ(std::vector<DOUBLE>(buffer, buffer + 6), std::vector<DOUBLE>({0, 3, 1, 4, 2, 5}));
+    rows.copyRowMajor(buffer);
+    EXPECT_EQ(std::vector<DOUBLE>(buffer, buffer + 4), std::vector<DOUBLE>({1, 4, 2, 5}));
+    transposed.copyRowMajor(buffer);
+    EXPECT_EQ(std::vector<DOUBLE>(buffer, buffer + 6), std::vector<DOUBLE>({0, 1, 2, 3, 4, 5}));
+
+    // strided iterators work with random-access algorithms
+    auto first = view.row(1);
+    std::sort(first.begin(), first.end(), std::greater<DOUBLE>());
+    EXPECT_EQ(std::vector<DOUBLE>(first.begin(), first.end()), std::vector<DOUBLE>({3, 0}));
+    std::reverse(first.begin(), first.end());
+    EXPECT_EQ(view(1, 0), 0.0);
+
+    const com::SafeArray<DOUBLE> &constant = array;
+    com::SafeArrayView<const DOUBLE, 2> readonly = constant.view<2>();
+    EXPECT_EQ(readonly(3, 1), 5.0);
+    com::SafeArrayView<const DOUBLE, 2> converted(view);
+    EXPECT_EQ(converted(1, 1), 3.0);
+}
+
+
+TEST(SafeArray, ViewCopyRowMajor)
+{
+    // larger than one tile, across three planes
+    const ULONG rows = 70;
+    const ULONG columns = 45;
+    SAFEARRAYBOUND bounds[3] = {{3, 0}, {rows, 1}, {columns, 1}};
+    com::SafeArray<DOUBLE> array(SafeArrayCreate(VT_R8, 3, bounds));
+    for (size_t i = 0; i < array.size(); ++i) {
+        array[i] = static_cast<DOUBLE>(i);
+    }
+
+    auto view = array.view<3>();
+    std::vector<DOUBLE> buffer(view.size());
+    view.copyRowMajor(buffer.data());
+
+    size_t index = 0;
+    for (LONG k = 0; k < 3; ++k) {
+        for (LONG i = 1; i <= static_cast<LONG>(rows); ++i) {
+            for (LONG j = 1; j <= static_cast<LONG>(columns); ++j) {
+                ASSERT_EQ(buffer[index++], view(k, i, j));
+            }
+        }
+    }
+}
+
+
+TEST(SafeArray, LayoutUncached)
+{
+    // more dimensions than the layout caches
+    SAFEARRAYBOUND bounds[5] = {{2, 0}, {2, 1}, {3, 0}, {2, -1}, {2, 0}};
+    com::SafeArray<DOUBLE> array(SafeArrayCreate(VT_R8, 5, bounds));
+    for (size_t i = 0; i < array.size(); ++i) {
+        array[i] = static_cast<DOUBLE>(i);
+    }
+
+    LONG indices[5] = {1, 2, 1, 0, 1};
+    DOUBLE *expected;
+    SafeArrayPtrOfIndex(array, indices, (void**) &expected);
+    EXPECT_EQ(&array(1, 2, 1, 0, 1), expected);
+    EXPECT_EQ(&array[indices], expected);
+    EXPECT_THROW(array(1, 2, 1, 0, 2), std::out_of_range);
+    EXPECT_THROW(array(1, 2), std::invalid_argument);
+}
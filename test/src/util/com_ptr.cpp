@@ -0,0 +1,137 @@
+//  :copyright: (c) 2016 The Regents of the University of California.
+//  :license: MIT, see LICENSE.md for more details.
+/*
+ *  \addtogroup AutoComTests
+ *  \brief Intrusive COM pointer test suite.
+ */
+
+#include "autocom.hpp"
+
+#include <gtest/gtest.h>
+
+namespace com = autocom;
+
+
+// OBJECTS
+// -------
+
+
+/** \brief IEnumVARIANT which counts its references and enumerates nothing.
+ */
+class CountingEnum: public IEnumVARIANT
+{
+public:
+    ULONG references = 1;
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid,
+        void **object) override
+    {
+        if (riid == IID_IUnknown || riid == IID_IEnumVARIANT) {
+            *object = this;
+            AddRef();
+            return S_OK;
+        }
+        *object = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override
+    {
+        return ++references;
+    }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        return --references;
+    }
+
+    HRESULT STDMETHODCALLTYPE Next(ULONG,
+        VARIANT *,
+        ULONG *fetched) override
+    {
+        *fetched = 0;
+        return S_FALSE;
+    }
+
+    HRESULT STDMETHODCALLTYPE Skip(ULONG) override
+    {
+        return S_FALSE;
+    }
+
+    HRESULT STDMETHODCALLTYPE Reset() override
+    {
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE Clone(IEnumVARIANT **clone) override
+    {
+        *clone = nullptr;
+        return E_NOTIMPL;
+    }
+};
+
+// TESTS
+// -----
+
+
+TEST(ComPtr, Size)
+{
+    static_assert(sizeof(com::ComPtr<IDispatch>) == sizeof(IDispatch*), "ComPtr must be a single pointer");
+    com::ComPtr<IDispatch> ptr;
+    EXPECT_FALSE(bool(ptr));
+    EXPECT_TRUE(ptr == nullptr);
+}
+
+
+TEST(ComPtr, References)
+{
+    CountingEnum object;
+    {
+        com::ComPtr<IEnumVARIANT> ptr(&object);
+        EXPECT_EQ(object.references, 1);
+
+        com::ComPtr<IEnumVARIANT> copy(ptr);
+        EXPECT_EQ(object.references, 2);
+        EXPECT_TRUE(copy == ptr);
+
+        com::ComPtr<IEnumVARIANT> moved(std::move(copy));
+        EXPECT_EQ(object.references, 2);
+        EXPECT_FALSE(bool(copy));
+
+        copy = moved;
+        EXPECT_EQ(object.references, 3);
+        copy = std::move(moved);
+        EXPECT_EQ(object.references, 2);
+
+        copy.reset();
+        EXPECT_EQ(object.references, 1);
+
+        IEnumVARIANT *raw = ptr.detach();
+        EXPECT_EQ(raw, &object);
+        EXPECT_EQ(object.references, 1);
+        ptr.reset(raw);
+    }
+    EXPECT_EQ(object.references, 0);
+}
+
+
+TEST(ComPtr, Query)
+{
+    CountingEnum object;
+    {
+        com::ComPtr<IEnumVARIANT> ptr(&object);
+        com::ComPtr<IUnknown> unknown = ptr.query<IUnknown>(IID_IUnknown);
+        EXPECT_TRUE(bool(unknown));
+        EXPECT_EQ(object.references, 2);
+
+        com::ComPtr<IDispatch> dispatch = ptr.query<IDispatch>(IID_IDispatch);
+        EXPECT_FALSE(bool(dispatch));
+        EXPECT_EQ(object.references, 2);
+
+        // upcasts need no QueryInterface
+        com::ComPtr<IUnknown> base(ptr);
+        EXPECT_EQ(object.references, 3);
+        EXPECT_TRUE(base == unknown);
+    }
+    EXPECT_EQ(object.references, 0);
+}
@@ -349,3 +349,78 @@ TEST(Variant, GetWrapperVariant)
     TEST_GET_WRAPPER(IUnknown)(variant);
     TEST_GET_WRAPPER(IDispatch)(variant);
 }
+
+
+TEST(Variant, Visit)
+{
+    com::Variant variant;
+    auto name = [](const auto &value) {
+        typedef std::decay_t<decltype(value)> T;
+        if (std::is_same<T, com::VariantEmpty>::value) {
+            return 0;
+        } else if (std::is_same<T, LONG>::value) {
+            return 1;
+        } else if (std::is_same<T, DOUBLE>::value) {
+            return 2;
+        } else if (std::is_same<T, bool>::value) {
+            return 3;
+        } else if (std::is_same<T, com::VariantDate>::value) {
+            return 4;
+        }
+        return -1;
+    };
+
+    EXPECT_EQ(com::visit(variant, name), 0);
+    variant.set(LONG(5));
+    EXPECT_EQ(com::visit(variant, name), 1);
+    variant.set(DOUBLE(1.5));
+    EXPECT_EQ(com::visit(variant, name), 2);
+    variant.set(com::PutBool(VARIANT_TRUE));
+    EXPECT_EQ(com::visit(variant, name), 3);
+    variant.set(com::PutDate(DATE(1)));
+    EXPECT_EQ(com::visit(variant, name), 4);
+
+    // BYREF VARIANT is followed
+    com::Variant inner(LONG(5));
+    VARIANT outer;
+    outer.vt = VT_VARIANT | VT_BYREF;
+    outer.pvarVal = &inner;
+    EXPECT_EQ(com::visit(outer, name), 1);
+}
+
+
+TEST(Variant, Widen)
+{
+    com::Variant variant;
+    LONGLONG integer;
+    DOUBLE real;
+    LONG narrow;
+
+    variant.set(LONG(-5));
+    EXPECT_TRUE(com::widenVariant(variant, integer));
+    EXPECT_EQ(integer, -5);
+    EXPECT_TRUE(com::widenVariant(variant, real));
+    EXPECT_EQ(real, -5.0);
+
+    variant.set(FLOAT(1.5f));
+    EXPECT_TRUE(com::widenVariant(variant, real));
+    EXPECT_EQ(real, 1.5);
+    EXPECT_FALSE(com::widenVariant(variant, narrow));
+
+    variant.set(ULONG(5));
+    EXPECT_FALSE(com::widenVariant(variant, narrow));
+    variant.set(com::PutBool(VARIANT_TRUE));
+    EXPECT_FALSE(com::widenVariant(variant, narrow));
+
+    // getters take the fast path, and leave the variant type unchanged
+    variant.set(LONG(7));
+    variant.get(integer);
+    EXPECT_EQ(integer, 7);
+    EXPECT_EQ(variant.vt, VT_I4);
+
+    // others still coerce through VariantChangeType
+    variant.set(DOUBLE(2.0));
+    variant.get(narrow);
+    EXPECT_EQ(narrow, 2);
+    EXPECT_EQ(variant.vt, VT_I4);
+}